@@ -70,6 +70,10 @@ function(generate_pkg_config_pc_file TARGET TEMPLATE template OUTPUT output)
         if(ARIBCC_USE_GDI_FONT)
             list(APPEND LIBS_LIST "-lgdi32")
         endif()
+
+        if(NOT ARIBCC_NO_RENDERER AND CMAKE_THREAD_LIBS_INIT)
+            list(APPEND LIBS_LIST "${CMAKE_THREAD_LIBS_INIT}")
+        endif()
     endif()
 
     string(REPLACE ";" " " PKG_REQUIRES "${REQUIRES_LIST}")
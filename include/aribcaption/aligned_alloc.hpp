@@ -22,6 +22,7 @@
 #include <cstddef>
 #include <new>
 #include <type_traits>
+#include <utility>
 #include "aribcc_export.h"
 
 namespace aribcaption {
@@ -64,6 +65,37 @@ public:
     }
 };
 
+/**
+ * AlignedAllocator which default-initializes elements instead of value-initializing them
+ *
+ * resize() of a std::vector using this allocator leaves new bytes uninitialized rather than zero-filling them.
+ */
+template <class T, std::size_t N>
+class AlignedDefaultInitAllocator : public AlignedAllocator<T, N> {
+public:
+    template <class U>
+    struct rebind {
+        using other = AlignedDefaultInitAllocator<U, N>;
+    };
+public:
+    AlignedDefaultInitAllocator() noexcept = default;
+
+    AlignedDefaultInitAllocator(const AlignedDefaultInitAllocator&) noexcept = default;
+
+    template <class U>
+    explicit AlignedDefaultInitAllocator(const AlignedDefaultInitAllocator<U, N>&) noexcept {}
+
+    template <class U>
+    void construct(U* p) noexcept(std::is_nothrow_default_constructible_v<U>) {
+        ::new(static_cast<void*>(p)) U;
+    }
+
+    template <class U, class... Args>
+    void construct(U* p, Args&&... args) {
+        ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+};
+
 template <class T, std::size_t M,
           class U, std::size_t N>
 static inline bool operator==(const AlignedAllocator<T, M>&,
@@ -29,6 +29,7 @@
 #ifndef ARIBCC_NO_RENDERER
 #include "image.h"
 #include "renderer.h"
+#include "pgs_encoder.h"
 #endif  // ARIBCC_NO_RENDERER
 
 #endif  // ARIBCAPTION_ARIBCAPTION_H
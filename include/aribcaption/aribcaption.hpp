@@ -29,6 +29,7 @@
 #ifndef ARIBCC_NO_RENDERER
 #include "image.hpp"
 #include "renderer.hpp"
+#include "pgs_encoder.hpp"
 #endif  // ARIBCC_NO_RENDERER
 
 #endif  // ARIBCAPTION_ARIBCAPTION_HPP
@@ -30,10 +30,12 @@ extern "C" {
 /**
  * enums for pixel format used by aribcc api.
  *
- * Only @ARIBCC_PIXELFORMAT_RGBA8888 is used for now.
+ * @ARIBCC_PIXELFORMAT_RGBA8888 is used by default,
+ * @ARIBCC_PIXELFORMAT_PAL8 is produced if indicated by @aribcc_renderer_set_output_pixel_format().
  */
 typedef enum aribcc_pixelformat_t {
     ARIBCC_PIXELFORMAT_RGBA8888 = 0,
+    ARIBCC_PIXELFORMAT_PAL8 = 1,    ///< 8-bit indices into the palette, see @aribcc_renderer_get_palette()
     ARIBCC_PIXELFORMAT_DEFAULT = ARIBCC_PIXELFORMAT_RGBA8888
 } aribcc_pixelformat_t;
 
@@ -49,7 +51,7 @@ typedef struct aribcc_image_t {
     int dst_x;     ///< x coordinate of bitmap's top-left corner inside the player's renderer frame
     int dst_y;     ///< y coordinate of bitmap's top-left corner inside the player's renderer frame
 
-    aribcc_pixelformat_t pixel_format;    ///< pixel format, always be @ARIBCC_PIXELFORMAT_RGBA8888
+    aribcc_pixelformat_t pixel_format;    ///< pixel format, @ARIBCC_PIXELFORMAT_RGBA8888 or @ARIBCC_PIXELFORMAT_PAL8
 
     /**
      * Pointer pointed to the bitmap area. The buffer size is indicated in bitmap_size field.
@@ -72,6 +74,17 @@ typedef struct aribcc_image_t {
  */
 ARIBCC_API void aribcc_image_cleanup(aribcc_image_t* image);
 
+/**
+ * Release a bitmap taken by @aribcc_render_result_take_bitmap()
+ *
+ * The signature matches FFmpeg's AVBuffer free callback, e.g.
+ * av_buffer_create(bitmap, image->bitmap_size, aribcc_image_bitmap_release, owner, AV_BUFFER_FLAG_READONLY)
+ *
+ * @param owner   Owner returned by @aribcc_render_result_take_bitmap(), may be NULL
+ * @param bitmap  Bitmap returned by @aribcc_render_result_take_bitmap()
+ */
+ARIBCC_API void aribcc_image_bitmap_release(void* owner, uint8_t* bitmap);
+
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -20,23 +20,98 @@
 #define ARIBCAPTION_IMAGE_HPP
 
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 #include "aligned_alloc.hpp"
+#include "color.hpp"
 
 namespace aribcaption {
 
 /**
  * enums for pixel format used by aribcc api.
  *
- * Only @kRGBA8888 is used for now.
+ * @kRGBA8888 is used by default, @kPAL8 is produced if indicated by @Renderer::SetOutputPixelFormat().
  */
 enum class PixelFormat {
     kRGBA8888 = 0,
+    kPAL8 = 1,       ///< 8-bit indices into Image::palette
     kDefault = kRGBA8888,
 };
 
+/**
+ * Reference-counted, immutable pixel buffer of a rendered @Image
+ *
+ * Copying an ImageBuffer (and therefore an Image) only shares the underlying pixels, the pixels are never
+ * modified once the buffer has been created. It is safe to hold and read copies from different threads.
+ */
+class ImageBuffer {
+public:
+    static constexpr size_t kAlignedTo = 32;
+    // resize() doesn't zero-fill
+    using Storage = std::vector<uint8_t, AlignedDefaultInitAllocator<uint8_t, kAlignedTo>>;
+public:
+    ImageBuffer() = default;
+    explicit ImageBuffer(Storage&& storage)
+        : storage_(std::make_shared<Storage>(std::move(storage))) {}
+    explicit ImageBuffer(std::shared_ptr<Storage> storage) : storage_(std::move(storage)) {}
+    ImageBuffer(const ImageBuffer&) = default;
+    ImageBuffer(ImageBuffer&&) noexcept = default;
+    ImageBuffer& operator=(const ImageBuffer&) = default;
+    ImageBuffer& operator=(ImageBuffer&&) noexcept = default;
+public:
+    [[nodiscard]]
+    const uint8_t* data() const { return storage_ ? storage_->data() : nullptr; }
+
+    [[nodiscard]]
+    size_t size() const { return storage_ ? storage_->size() : 0; }
+
+    [[nodiscard]]
+    bool empty() const { return size() == 0; }
+
+    [[nodiscard]]
+    const uint8_t& operator[](size_t index) const { return (*storage_)[index]; }
+
+    [[nodiscard]]
+    const uint8_t* begin() const { return data(); }
+
+    [[nodiscard]]
+    const uint8_t* end() const { return data() + size(); }
+
+    /**
+     * Number of ImageBuffers sharing the pixels, 0 if empty
+     */
+    [[nodiscard]]
+    long use_count() const { return storage_.use_count(); }
+
+    /**
+     * Take the pixels out for modification, leaving this buffer empty
+     *
+     * The pixels are moved out if this is the only reference, otherwise a copy is returned.
+     */
+    Storage Detach() {
+        Storage storage;
+        if (storage_ && storage_.use_count() == 1) {
+            storage = std::move(*storage_);
+        } else if (storage_) {
+            // Copy constructor of std::vector with a custom allocator copies byte by byte, use memcpy instead
+            storage.resize(storage_->size());
+            if (!storage.empty()) {
+                memcpy(storage.data(), storage_->data(), storage.size());
+            }
+        }
+        storage_.reset();
+        return storage;
+    }
+private:
+    std::shared_ptr<Storage> storage_;
+};
+
 /**
  * Structure represents a rendered caption image produced by the renderer
+ *
+ * Copying an Image is cheap, the pixels are shared between copies, see @ImageBuffer.
  */
 struct Image {
 public:
@@ -49,9 +124,11 @@ public:
     int dst_x = 0;     ///< x coordinate of bitmap's top-left corner inside the player's renderer frame
     int dst_y = 0;     ///< y coordinate of bitmap's top-left corner inside the player's renderer frame
 
-    PixelFormat pixel_format = PixelFormat::kDefault;    ///< pixel format, always be kRGBA8888
+    PixelFormat pixel_format = PixelFormat::kDefault;    ///< pixel format, kRGBA8888 or kPAL8
+
+    ImageBuffer bitmap;  ///< pixels, shared between copies of the Image and immutable
 
-    std::vector<uint8_t, AlignedAllocator<uint8_t, kAlignedTo>> bitmap;
+    std::vector<ColorRGBA> palette;  ///< palette for kPAL8, empty for kRGBA8888
 public:
     Image() = default;
     Image(const Image&) = default;
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_PGS_ENCODER_H
+#define ARIBCAPTION_PGS_ENCODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "aribcc_export.h"
+#include "context.h"
+#include "renderer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Encoder converting rendered captions into PGS (Presentation Graphic Stream, .sup) segments
+ *
+ * The encoder consumes render results with ARIBCC_PIXELFORMAT_PAL8 images, which could be produced by a renderer
+ * configured with aribcc_renderer_set_output_pixel_format(). Images of a caption are composed into
+ * a single PGS object, run-length encoded directly from the rendered rows.
+ *
+ * Opaque type
+ */
+typedef struct aribcc_pgs_encoder_t aribcc_pgs_encoder_t;
+
+/**
+ * A context is needed for allocating the PGS encoder.
+ *
+ * The context shouldn't be freed before any other object constructed from the context has been freed.
+ */
+ARIBCC_API aribcc_pgs_encoder_t* aribcc_pgs_encoder_alloc(aribcc_context_t* context);
+
+/**
+ * Free the PGS encoder and all related resources
+ */
+ARIBCC_API void aribcc_pgs_encoder_free(aribcc_pgs_encoder_t* encoder);
+
+/**
+ * Indicate video size written into PGS, should be identical to the frame size of the renderer
+ *
+ * @param encoder       @aribcc_pgs_encoder_t
+ * @param frame_width   Video frame width
+ * @param frame_height  Video frame height
+ * @return true on success
+ */
+ARIBCC_API bool aribcc_pgs_encoder_set_frame_size(aribcc_pgs_encoder_t* encoder, int frame_width, int frame_height);
+
+/**
+ * Indicate color matrix for converting palette colors into YCbCr (limited range)
+ *
+ * If not indicated, BT.709 is used for frame heights of 720 and above, BT.601 otherwise.
+ *
+ * @param encoder      @aribcc_pgs_encoder_t
+ * @param color_space  ARIBCC_FRAME_COLORSPACE_BT601 / ARIBCC_FRAME_COLORSPACE_BT709
+ */
+ARIBCC_API void aribcc_pgs_encoder_set_color_space(aribcc_pgs_encoder_t* encoder,
+                                                   aribcc_frame_colorspace_t color_space);
+
+/**
+ * Encode the result of a aribcc_renderer_render() call at specific PTS into PGS segments
+ *
+ * ARIBCC_RENDER_STATUS_GOT_IMAGE starts a new display set presented at the caption's PTS. The caption is cleared
+ * at the end of its duration, or when a later call replaces or removes it.
+ * ARIBCC_RENDER_STATUS_GOT_IMAGE_UNCHANGED is ignored.
+ *
+ * @param encoder       @aribcc_pgs_encoder_t
+ * @param pts           PTS passed to aribcc_renderer_render(), in milliseconds
+ * @param status        Status returned by aribcc_renderer_render()
+ * @param result        Render result, images must be ARIBCC_PIXELFORMAT_PAL8. May be NULL if no image rendered
+ * @param palette       Palette shared by images of the render result, see @aribcc_renderer_get_palette()
+ * @param palette_size  Entry count of palette
+ * @param out_data      Write back parameter for the encoded segments, owned by the encoder and valid until
+ *                      the next call on the encoder. May be set to NULL if nothing has been encoded
+ * @param out_size      Write back parameter for the size of encoded segments
+ * @return true on success
+ */
+ARIBCC_API bool aribcc_pgs_encoder_encode(aribcc_pgs_encoder_t* encoder,
+                                          int64_t pts,
+                                          aribcc_render_status_t status,
+                                          const aribcc_render_result_t* result,
+                                          const uint32_t* palette,
+                                          size_t palette_size,
+                                          const uint8_t** out_data,
+                                          size_t* out_size);
+
+/**
+ * Clear the displaying caption at the end of its duration, should be called at the end of the stream
+ *
+ * @param encoder   @aribcc_pgs_encoder_t
+ * @param out_data  Write back parameter for the encoded segments, see @aribcc_pgs_encoder_encode()
+ * @param out_size  Write back parameter for the size of encoded segments
+ */
+ARIBCC_API void aribcc_pgs_encoder_flush(aribcc_pgs_encoder_t* encoder, const uint8_t** out_data, size_t* out_size);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // ARIBCAPTION_PGS_ENCODER_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_PGS_ENCODER_HPP
+#define ARIBCAPTION_PGS_ENCODER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "aribcc_export.h"
+#include "context.hpp"
+#include "renderer.hpp"
+
+namespace aribcaption {
+
+namespace internal { class PGSEncoderImpl; }
+
+/**
+ * Encoder converting rendered captions into PGS (Presentation Graphic Stream, .sup) segments
+ *
+ * The encoder consumes @RenderResult with @PixelFormat::kPAL8 images, which could be produced by a @Renderer
+ * configured with Renderer::SetOutputPixelFormat(PixelFormat::kPAL8). Images of a caption are composed into
+ * a single PGS object, run-length encoded directly from the rendered rows.
+ *
+ * Typical usage, for every decoded caption in PTS order:
+ *
+ *     renderer.AppendCaption(caption);
+ *     RenderStatus status = renderer.Render(caption.pts, result);
+ *     encoder.Encode(caption.pts, status, result, sup_data);
+ *
+ * and call encoder.Flush(sup_data) at the end of the stream.
+ */
+class PGSEncoder {
+public:
+    /**
+     * A context is needed for constructing the PGSEncoder.
+     *
+     * The context shouldn't be destructed before any other object constructed from the context has been destructed.
+     */
+    ARIBCC_API explicit PGSEncoder(Context& context);
+    ARIBCC_API ~PGSEncoder();
+    ARIBCC_API PGSEncoder(PGSEncoder&&) noexcept;
+    ARIBCC_API PGSEncoder& operator=(PGSEncoder&&) noexcept;
+public:
+    /**
+     * Indicate video size written into PGS, should be identical to the frame size of the @Renderer
+     *
+     * @return true on success
+     */
+    ARIBCC_API bool SetFrameSize(int frame_width, int frame_height);
+
+    /**
+     * Indicate color matrix for converting palette colors into YCbCr (limited range)
+     *
+     * If not indicated, BT.709 is used for frame heights of 720 and above, BT.601 otherwise.
+     */
+    ARIBCC_API void SetColorSpace(FrameColorSpace color_space);
+
+    /**
+     * Encode the result of a Renderer::Render() call at specific PTS, appending PGS segments into out_data
+     *
+     * kGotImage starts a new display set presented at the caption's PTS. The caption is cleared at the end
+     * of its duration, or when a later call replaces or removes it. kGotImageUnchanged is ignored.
+     *
+     * @param pts       PTS passed to Renderer::Render(), in milliseconds
+     * @param status    Status returned by Renderer::Render()
+     * @param result    Render result, images must be kPAL8
+     * @param out_data  Encoded segments are appended into this vector
+     * @return true on success
+     */
+    ARIBCC_API bool Encode(int64_t pts, RenderStatus status, const RenderResult& result,
+                           std::vector<uint8_t>& out_data);
+
+    /**
+     * Clear the displaying caption at the end of its duration, should be called at the end of the stream
+     *
+     * @param out_data  Encoded segments are appended into this vector
+     */
+    ARIBCC_API void Flush(std::vector<uint8_t>& out_data);
+public:
+    PGSEncoder(const PGSEncoder&) = delete;
+    PGSEncoder& operator=(const PGSEncoder&) = delete;
+private:
+    std::unique_ptr<internal::PGSEncoderImpl> pimpl_;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_PGS_ENCODER_HPP
@@ -73,7 +73,15 @@ typedef enum aribcc_fontprovider_type_t {
     /**
      * FontProvder based on Win32 GDI API. Available on Windows 2000+.
      */
-    ARIBCC_FONTPROVIDER_TYPE_GDI = 5
+    ARIBCC_FONTPROVIDER_TYPE_GDI = 5,
+#endif
+
+#if defined(ARIBCC_USE_FREETYPE)
+    /**
+     * FontProvider looking up fonts from files / directories indicated by aribcc_renderer_set_font_search_paths(),
+     * without relying on any system font service. Should be used with ARIBCC_TEXTRENDERER_TYPE_FREETYPE.
+     */
+    ARIBCC_FONTPROVIDER_TYPE_DIRECTORY = 6
 #endif
 } aribcc_fontprovider_type_t;
 
@@ -133,8 +141,29 @@ typedef enum aribcc_caption_storage_policy_t {
      * The renderer will keep appended captions at an upper limit of duration, in milliseconds.
      */
     ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_DURATION = 3,
+
+    /**
+     * The renderer will keep appended captions at an upper limit of estimated memory usage, in bytes.
+     * Memory of chars, text and DRCS patterns is accounted. The latest caption is always kept.
+     */
+    ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_BYTES = 4,
 } aribcc_caption_storage_policy_t;
 
+/**
+ * Enums for DRCS (Dynamically Redefinable Character Set) pattern scaling indication
+ */
+typedef enum aribcc_drcs_scale_mode_t {
+    /**
+     * Average the pattern area covered by each target pixel, producing smooth edges. This is the default behavior.
+     */
+    ARIBCC_DRCS_SCALE_MODE_AREA_AVERAGING = 0,
+
+    /**
+     * Pick the nearest pattern pixel, producing blocky edges. Same as the behavior of older releases.
+     */
+    ARIBCC_DRCS_SCALE_MODE_NEAREST_NEIGHBOR = 1,
+} aribcc_drcs_scale_mode_t;
+
 /**
  * Enums for reporting rendering status
  *
@@ -147,6 +176,18 @@ typedef enum aribcc_render_status_t {
     ARIBCC_RENDER_STATUS_GOT_IMAGE_UNCHANGED = 3,
 } aribcc_render_status_t;
 
+/**
+ * Structure describing a rectangle area inside the player's renderer frame
+ *
+ * See @aribcc_renderer_get_damage_rects()
+ */
+typedef struct aribcc_damage_rect_t {
+    int x;
+    int y;
+    int width;
+    int height;
+} aribcc_damage_rect_t;
+
 /**
  * Structure for holding rendered caption images
  *
@@ -176,6 +217,88 @@ typedef struct aribcc_render_result_t {
  */
 ARIBCC_API void aribcc_render_result_cleanup(aribcc_render_result_t* render_result);
 
+/**
+ * Cleanup the aribcc_render_result_t structure received from @aribcc_renderer_render_shared().
+ *
+ * Releases the references held by bitmap_owners and the bitmap_owners array itself.
+ * Do not call @aribcc_render_result_cleanup() on such a render result, it may cause a crash.
+ *
+ * @param render_result  @aribcc_render_result_t received from @aribcc_renderer_render_shared()
+ * @param bitmap_owners  Bitmap owners array received along with the render result, may be NULL
+ */
+ARIBCC_API void aribcc_render_result_cleanup_shared(aribcc_render_result_t* render_result, void** bitmap_owners);
+
+/**
+ * Transfer ownership of an image's bitmap buffer out of the @aribcc_render_result_t
+ *
+ * After the call, images[index].bitmap and bitmap_owners[index] are set to NULL while other fields are kept,
+ * so that cleanup of the render result won't release the bitmap anymore.
+ * The returned bitmap must be released by calling @aribcc_image_bitmap_release() with the returned owner.
+ *
+ * @param render_result  @aribcc_render_result_t received from aribcc API
+ * @param bitmap_owners  Bitmap owners array received from @aribcc_renderer_render_shared(),
+ *                       NULL if the render result is received from @aribcc_renderer_render()
+ * @param index          Index of the image inside render_result->images
+ * @param out_owner      Write back parameter for the owner of the bitmap, required.
+ *                       Set to NULL if the bitmap is owned by the image exclusively
+ * @return               Pointer to the bitmap, or NULL if the image doesn't hold a bitmap, index is out of range,
+ *                       or out_owner is NULL
+ */
+ARIBCC_API uint8_t* aribcc_render_result_take_bitmap(aribcc_render_result_t* render_result,
+                                                     void** bitmap_owners,
+                                                     uint32_t index,
+                                                     void** out_owner);
+
+/**
+ * Enums for pixel formats of video frames accepted by @aribcc_renderer_render_to_frame()
+ */
+typedef enum aribcc_frame_pixelformat_t {
+    ARIBCC_FRAME_PIXELFORMAT_RGBA8888 = 0,    ///< Packed 8-bit R, G, B, A. 1 plane
+    ARIBCC_FRAME_PIXELFORMAT_BGRA8888 = 1,    ///< Packed 8-bit B, G, R, A. 1 plane
+    ARIBCC_FRAME_PIXELFORMAT_NV12 = 2,        ///< 8-bit Y plane followed by an interleaved UV plane, 4:2:0. 2 planes
+    ARIBCC_FRAME_PIXELFORMAT_YUV420P = 3,     ///< 8-bit Y, U, V planes, 4:2:0 subsampled. 3 planes
+} aribcc_frame_pixelformat_t;
+
+/**
+ * Enums for YUV color matrix of video frames
+ */
+typedef enum aribcc_frame_colorspace_t {
+    ARIBCC_FRAME_COLORSPACE_BT601 = 0,
+    ARIBCC_FRAME_COLORSPACE_BT709 = 1,
+} aribcc_frame_colorspace_t;
+
+/**
+ * Structure describing a caller-provided video frame to composite captions onto
+ *
+ * The frame is expected to have the size indicated in @aribcc_renderer_set_frame_size(), images are clipped otherwise.
+ * For packed RGB formats the plane pointer and stride must be multiples of 4.
+ * For 4:2:0 formats chroma planes have the size of ((width + 1) / 2) x ((height + 1) / 2).
+ */
+typedef struct aribcc_video_frame_t {
+    aribcc_frame_pixelformat_t pixel_format;
+    aribcc_frame_colorspace_t color_space;    ///< YUV formats only
+    bool full_range;                          ///< YUV formats only, limited (TV) range is assumed if false
+
+    int width;
+    int height;
+
+    uint8_t* planes[3];    ///< pointers to the planes, unused planes are ignored
+    int strides[3];        ///< bytes in a line of each plane
+} aribcc_video_frame_t;
+
+/**
+ * Structure for reporting memory held by a renderer, in bytes
+ *
+ * See @aribcc_renderer_get_memory_usage()
+ */
+typedef struct aribcc_renderer_memory_usage_t {
+    size_t captions;        ///< stored captions, see @aribcc_caption_storage_policy_t
+    size_t font_data;       ///< loaded font files and tables derived from them, e.g. GSUB substitution maps
+    size_t glyph_caches;    ///< rasterized glyphs and scaled DRCS patterns of all rendering threads
+    size_t image_caches;    ///< cached region images and pooled pixel buffers
+    size_t total;           ///< sum of the above
+} aribcc_renderer_memory_usage_t;
+
 
 /**
  * ARIB STD-B24 caption renderer
@@ -197,7 +320,32 @@ ARIBCC_API aribcc_renderer_t* aribcc_renderer_alloc(aribcc_context_t* context);
 ARIBCC_API void aribcc_renderer_free(aribcc_renderer_t* renderer);
 
 /**
- * Initialize function must be called before calling any other member functions.
+ * Indicate font files / directories for ARIBCC_FONTPROVIDER_TYPE_DIRECTORY,
+ * must be called before aribcc_renderer_initialize().
+ *
+ * Font files in directories are found recursively by extension (.ttf / .otf / .ttc / .otc).
+ * Family names, PostScript names, face indices and codepoint coverage of every face are indexed,
+ * so that no font service is queried on initialization and lookups.
+ * If index_cache_path is not NULL, the index is saved into the file, and reused by later calls
+ * for font files whose size and modification time haven't changed.
+ *
+ * Fonts are looked up by family name, full name or PostScript name. Unknown names, e.g. "sans-serif",
+ * are substituted with the first indexed face containing the requested character.
+ *
+ * @param renderer          @aribcc_renderer_t
+ * @param paths             Array of font files or directories, encoded in UTF-8
+ * @param path_count        Element count of paths array
+ * @param index_cache_path  Path of the index cache file, NULL for not caching
+ * @return true on success, false if no font face has been found
+ */
+ARIBCC_API bool aribcc_renderer_set_font_search_paths(aribcc_renderer_t* renderer,
+                                                      const char * const * paths,
+                                                      size_t path_count,
+                                                      const char* index_cache_path);
+
+/**
+ * Initialize function must be called before calling any other member functions,
+ * except aribcc_renderer_set_font_search_paths().
  *
  * @param renderer            @aribcc_renderer_t
  * @param caption_type        Indicate caption type (kCaption / kSuperimpose)
@@ -226,6 +374,14 @@ ARIBCC_API void aribcc_renderer_set_stroke_width(aribcc_renderer_t* renderer, fl
  */
 ARIBCC_API void aribcc_renderer_set_replace_drcs(aribcc_renderer_t* renderer, bool replace);
 
+/**
+ * Indicate how DRCS patterns are scaled to the character size
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param mode      default as ARIBCC_DRCS_SCALE_MODE_AREA_AVERAGING
+ */
+ARIBCC_API void aribcc_renderer_set_drcs_scale_mode(aribcc_renderer_t* renderer, aribcc_drcs_scale_mode_t mode);
+
 /**
  * Indicate whether always render stroke text for all characters regardless of the indication by CharStyle
  *
@@ -250,6 +406,18 @@ ARIBCC_API void aribcc_renderer_set_force_no_ruby(aribcc_renderer_t* renderer, b
  */
 ARIBCC_API void aribcc_renderer_set_force_no_background(aribcc_renderer_t* renderer, bool force_no_background);
 
+/**
+ * Indicate whether crop rendered images to the bounding box of their drawn (non-transparent) pixels
+ *
+ * Images are sized by caption regions by default, which leaves mostly transparent padding around the text
+ * if background is not rendered, e.g. with aribcc_renderer_set_force_no_background(). Cropped images have their
+ * dst_x / dst_y adjusted accordingly. Regions drawing nothing visible produce no image.
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param crop      default as false
+ */
+ARIBCC_API void aribcc_renderer_set_crop_images_to_content(aribcc_renderer_t* renderer, bool crop);
+
 /**
  * Merge rendered region images into one big image on aribcc_renderer_render() call.
  * @param renderer  @aribcc_renderer_t
@@ -257,6 +425,20 @@ ARIBCC_API void aribcc_renderer_set_force_no_background(aribcc_renderer_t* rende
  */
 ARIBCC_API void aribcc_renderer_set_merge_region_images(aribcc_renderer_t* renderer, bool merge);
 
+/**
+ * Indicate pixel format of images produced by aribcc_renderer_render()
+ *
+ * With ARIBCC_PIXELFORMAT_PAL8, every image is converted into 8-bit palette indices. All images of a render result
+ * share a single palette, which could be retrieved by @aribcc_renderer_get_palette(). The palette is built from
+ * text, stroke and background colors used by the caption, plus blends of them for antialiased edges.
+ * Index 0 is always fully transparent.
+ *
+ * @param renderer      @aribcc_renderer_t
+ * @param pixel_format  ARIBCC_PIXELFORMAT_RGBA8888 (default) or ARIBCC_PIXELFORMAT_PAL8
+ */
+ARIBCC_API void aribcc_renderer_set_output_pixel_format(aribcc_renderer_t* renderer,
+                                                        aribcc_pixelformat_t pixel_format);
+
 /**
  * Indicate font families (an array of font family names) for default usage
  *
@@ -357,13 +539,71 @@ ARIBCC_API bool aribcc_renderer_set_margins(aribcc_renderer_t* renderer, int top
  *
  * @param renderer       @aribcc_renderer_t
  * @param storage_policy See @aribcc_caption_storage_policy_t
- * @param upper_limit    Must be non-zero value for ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_COUNT or
- *                       ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_DURATION
+ * @param upper_limit    Must be non-zero value for ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_COUNT,
+ *                       ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_DURATION or
+ *                       ARIBCC_CAPTION_STORAGE_POLICY_UPPER_LIMIT_BYTES
  */
 ARIBCC_API void aribcc_renderer_set_storage_policy(aribcc_renderer_t* renderer,
                                                    aribcc_caption_storage_policy_t storage_policy,
                                                    size_t upper_limit);
 
+/**
+ * Enable background render-ahead (prefetch) for upcoming captions
+ *
+ * If enabled, a worker thread renders the next count stored captions after the latest aribcc_renderer_render() PTS,
+ * using the current frame size, margins and other settings. A later aribcc_renderer_render() call for these captions
+ * returns the prepared images without rasterization, taking the render cost off the caller's thread.
+ *
+ * The renderer should have been initialized. Log callback of the context may be invoked from the worker thread.
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param count     Number of upcoming captions to render ahead, 0 disables render-ahead (default)
+ * @return true on success
+ */
+ARIBCC_API bool aribcc_renderer_set_render_ahead_count(aribcc_renderer_t* renderer, size_t count);
+
+/**
+ * Set number of threads used for rendering regions of a caption
+ *
+ * If count is greater than 1, count - 1 worker threads are spawned, each owning its own font provider and
+ * text renderer. Regions of a caption which need rasterization are then rendered concurrently by the workers
+ * together with the caller's thread. The output is identical to single-threaded rendering.
+ *
+ * The renderer should have been initialized. Log callback of the context may be invoked from worker threads.
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param count     Number of rendering threads, 0 or 1 for single-threaded rendering (default)
+ * @return true on success
+ */
+ARIBCC_API bool aribcc_renderer_set_render_thread_count(aribcc_renderer_t* renderer, size_t count);
+
+/**
+ * Report memory currently held by the renderer, including all rendering threads
+ *
+ * Font data and glyph caches of text renderers backed by system APIs (CoreText, DirectWrite) are managed by
+ * the system and not accounted.
+ *
+ * @param renderer   @aribcc_renderer_t
+ * @param out_usage  Write back parameter for the memory usage
+ */
+ARIBCC_API void aribcc_renderer_get_memory_usage(aribcc_renderer_t* renderer,
+                                                 aribcc_renderer_memory_usage_t* out_usage);
+
+/**
+ * Set a memory budget for everything reported by @aribcc_renderer_get_memory_usage()
+ *
+ * The budget is enforced after every aribcc_renderer_append_caption() and aribcc_renderer_render() call.
+ * Once exceeded, memory is evicted in the order of pooled pixel buffers, cached region images, glyph caches,
+ * and then stored captions older than the latest rendered one. Loaded fonts and captions which haven't been rendered
+ * are never evicted, so the usage may still exceed a very small budget.
+ *
+ * Eviction of the render-ahead thread's glyph caches happens asynchronously on that thread.
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param bytes     Memory budget in bytes, 0 for unlimited (default)
+ */
+ARIBCC_API void aribcc_renderer_set_memory_budget(aribcc_renderer_t* renderer, size_t bytes);
+
 /**
  * Append a caption into renderer's internal storage for subsequent rendering
  *
@@ -401,6 +641,85 @@ ARIBCC_API aribcc_render_status_t aribcc_renderer_render(aribcc_renderer_t* rend
                                                          int64_t pts,
                                                          aribcc_render_result_t* out_result);
 
+/**
+ * Render caption at specific PTS, sharing the rendered bitmaps with the renderer instead of copying them
+ *
+ * Same as @aribcc_renderer_render(), but the bitmaps of returned images point to the renderer's internal
+ * reference-counted buffers, which must not be modified. The references are held by a separate bitmap owners
+ * array parallel to the images array, the bitmaps stay valid until released by
+ * @aribcc_render_result_cleanup_shared(), even if the renderer has been freed.
+ *
+ * Use @aribcc_render_result_take_bitmap() to transfer a bitmap out of the result,
+ * e.g. for wrapping it into an AVBufferRef.
+ *
+ * @param renderer           @aribcc_renderer_t
+ * @param pts                Presentation timestamp, in milliseconds
+ * @param out_result         Write back parameter for passing rendered images,
+ *                           images will be NULL if status is kError / kNoImage
+ * @param out_bitmap_owners  Write back parameter for the bitmap owners array with image_count elements,
+ *                           NULL if no image provided
+ * @return                   See @aribcc_renderer_render()
+ */
+ARIBCC_API aribcc_render_status_t aribcc_renderer_render_shared(aribcc_renderer_t* renderer,
+                                                                int64_t pts,
+                                                                aribcc_render_result_t* out_result,
+                                                                void*** out_bitmap_owners);
+
+/**
+ * Retrieve areas of the frame which differ from the previous render call, i.e. regions added, removed or changed.
+ *
+ * Describes the latest aribcc_renderer_render() / aribcc_renderer_render_shared() call. Only provided along with
+ * ARIBCC_RENDER_STATUS_GOT_IMAGE, empty otherwise. Consumers could upload or blend only these areas of the new images.
+ * If the previous call returned no image, the caption layer is treated as cleared, and the areas of all regions
+ * are reported.
+ *
+ * @param renderer   @aribcc_renderer_t
+ * @param out_rects  Write back parameter for the damage rects array, owned by the renderer and valid until
+ *                   the next render call. Set to NULL if empty
+ * @param out_count  Write back parameter for the element count of the array
+ */
+ARIBCC_API void aribcc_renderer_get_damage_rects(aribcc_renderer_t* renderer,
+                                                 const aribcc_damage_rect_t** out_rects,
+                                                 size_t* out_count);
+
+/**
+ * Retrieve the palette shared by images of the latest aribcc_renderer_render() / aribcc_renderer_render_shared() call
+ *
+ * Only provided if images are ARIBCC_PIXELFORMAT_PAL8, empty otherwise.
+ * Each entry has the same memory layout as a @ARIBCC_PIXELFORMAT_RGBA8888 pixel, i.e. R, G, B, A bytes.
+ *
+ * @param renderer     @aribcc_renderer_t
+ * @param out_palette  Write back parameter for the palette, owned by the renderer and valid until
+ *                     the next render call. Set to NULL if empty
+ * @param out_count    Write back parameter for the entry count of the palette
+ */
+ARIBCC_API void aribcc_renderer_get_palette(aribcc_renderer_t* renderer,
+                                            const uint32_t** out_palette,
+                                            size_t* out_count);
+
+/**
+ * Render caption at specific PTS and composite it directly onto a caller-provided video frame
+ *
+ * The rendered images are alpha-blended onto the frame in its native pixel format, there is no need to
+ * blend rendered images onto the frame afterwards. Frame contents are left untouched if no image rendered.
+ *
+ * Unlike @aribcc_renderer_render(), images are blended again if ARIBCC_RENDER_STATUS_GOT_IMAGE_UNCHANGED is returned,
+ * as the frame is a new one.
+ *
+ * Into RGBA / BGRA frames, regions of a newly displayed caption are drawn directly without intermediate images,
+ * unless found in the region image cache. YUV frames always get rendered images blended onto them.
+ *
+ * @param renderer  @aribcc_renderer_t
+ * @param pts       Presentation timestamp, in milliseconds
+ * @param frame     Video frame to composite onto, see @aribcc_video_frame_t
+ * @return          ARIBCC_RENDER_STATUS_GOT_IMAGE / ARIBCC_RENDER_STATUS_GOT_IMAGE_UNCHANGED
+ *                  if caption has been composited
+ *                  ARIBCC_RENDER_STATUS_ERROR if the frame is invalid
+ */
+ARIBCC_API aribcc_render_status_t aribcc_renderer_render_to_frame(aribcc_renderer_t* renderer,
+                                                                  int64_t pts,
+                                                                  const aribcc_video_frame_t* frame);
+
 /**
  * Clear caption storage inside the renderer. Will evict all the appended captions.
  *
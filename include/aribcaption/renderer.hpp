@@ -72,6 +72,14 @@ enum class FontProviderType {
      */
     kGDI = 5,
 #endif
+
+#if defined(ARIBCC_USE_FREETYPE)
+    /**
+     * FontProvider looking up fonts from files / directories indicated by Renderer::SetFontSearchPaths(),
+     * without relying on any system font service. Should be used with TextRendererType::kFreetype.
+     */
+    kDirectory = 6,
+#endif
 };
 
 /**
@@ -132,6 +140,27 @@ enum class CaptionStoragePolicy {
      * The renderer will keep appended captions at an upper limit of duration, in milliseconds.
      */
     kUpperLimitDuration = 3,
+
+    /**
+     * The renderer will keep appended captions at an upper limit of estimated memory usage, in bytes.
+     * Memory of chars, text and DRCS patterns is accounted. The latest caption is always kept.
+     */
+    kUpperLimitBytes = 4,
+};
+
+/**
+ * Enums for DRCS (Dynamically Redefinable Character Set) pattern scaling indication
+ */
+enum class DRCSScaleMode {
+    /**
+     * Average the pattern area covered by each target pixel, producing smooth edges. This is the default behavior.
+     */
+    kAreaAveraging = 0,
+
+    /**
+     * Pick the nearest pattern pixel, producing blocky edges. Same as the behavior of older releases.
+     */
+    kNearestNeighbor = 1,
 };
 
 /**
@@ -146,6 +175,16 @@ enum class RenderStatus {
     kGotImageUnchanged = 3,
 };
 
+/**
+ * Structure describing a rectangle area inside the player's renderer frame
+ */
+struct DamageRect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
 /**
  * Structure for holding rendered caption images
  */
@@ -153,6 +192,65 @@ struct RenderResult {
     int64_t pts = 0;             ///< PTS of rendered caption
     int64_t duration = 0;        ///< duration of rendered caption, may be DURATION_INDEFINITE
     std::vector<Image> images;
+
+    /**
+     * Areas of the frame which differ from the previous Render() call, i.e. regions added, removed or changed.
+     *
+     * Only provided along with kGotImage, always empty for kGotImageUnchanged. Consumers could upload or blend
+     * only these areas of the new images. If the previous call returned no image, the caption layer is treated as
+     * cleared, and the areas of all regions are reported.
+     */
+    std::vector<DamageRect> damage_rects;
+};
+
+/**
+ * Enums for pixel formats of video frames accepted by @Renderer::RenderToFrame()
+ */
+enum class FramePixelFormat {
+    kRGBA8888 = 0,    ///< Packed 8-bit R, G, B, A. 1 plane
+    kBGRA8888 = 1,    ///< Packed 8-bit B, G, R, A. 1 plane
+    kNV12 = 2,        ///< 8-bit Y plane followed by an interleaved UV plane, 4:2:0 subsampled. 2 planes
+    kYUV420P = 3,     ///< 8-bit Y, U, V planes, 4:2:0 subsampled. 3 planes
+};
+
+/**
+ * Enums for YUV color matrix of video frames
+ */
+enum class FrameColorSpace {
+    kBT601 = 0,
+    kBT709 = 1,
+};
+
+/**
+ * Structure describing a caller-provided video frame to composite captions onto
+ *
+ * The frame is expected to have the size indicated in @Renderer::SetFrameSize(), images are clipped otherwise.
+ * For packed RGB formats the plane pointer and stride must be multiples of 4.
+ * For 4:2:0 formats chroma planes have the size of ((width + 1) / 2) x ((height + 1) / 2).
+ */
+struct VideoFrame {
+    FramePixelFormat pixel_format = FramePixelFormat::kRGBA8888;
+    FrameColorSpace color_space = FrameColorSpace::kBT709;    ///< YUV formats only
+    bool full_range = false;    ///< YUV formats only, limited (TV) range is assumed if false
+
+    int width = 0;
+    int height = 0;
+
+    uint8_t* planes[3] = {};    ///< pointers to the planes, unused planes are ignored
+    int strides[3] = {};        ///< bytes in a line of each plane
+};
+
+/**
+ * Structure for reporting memory held by a @Renderer, in bytes
+ *
+ * See @Renderer::GetMemoryUsage()
+ */
+struct RendererMemoryUsage {
+    size_t captions = 0;        ///< stored captions, see @CaptionStoragePolicy
+    size_t font_data = 0;       ///< loaded font files and tables derived from them, e.g. GSUB substitution maps
+    size_t glyph_caches = 0;    ///< rasterized glyphs and scaled DRCS patterns of all rendering threads
+    size_t image_caches = 0;    ///< cached region images and pooled pixel buffers
+    size_t total = 0;           ///< sum of the above
 };
 
 /**
@@ -171,7 +269,27 @@ public:
     ARIBCC_API Renderer& operator=(Renderer&&) noexcept;
 public:
     /**
-     * Initialize function must be called before calling any other member functions.
+     * Indicate font files / directories for FontProviderType::kDirectory, must be called before Initialize().
+     *
+     * Font files in directories are found recursively by extension (.ttf / .otf / .ttc / .otc).
+     * Family names, PostScript names, face indices and codepoint coverage of every face are indexed,
+     * so that no font service is queried on initialization and lookups.
+     * If index_cache_path is not empty, the index is saved into the file, and reused by later calls
+     * for font files whose size and modification time haven't changed.
+     *
+     * Fonts are looked up by family name, full name or PostScript name. Unknown names, e.g. "sans-serif",
+     * are substituted with the first indexed face containing the requested character.
+     *
+     * @param paths             Font files or directories, encoded in UTF-8
+     * @param index_cache_path  Path of the index cache file, empty for not caching
+     * @return true on success, false if no font face has been found
+     */
+    ARIBCC_API bool SetFontSearchPaths(const std::vector<std::string>& paths,
+                                       const std::string& index_cache_path = std::string());
+
+    /**
+     * Initialize function must be called before calling any other member functions,
+     * except SetFontSearchPaths().
      *
      * @param caption_type        Indicate caption type (kCaption / kSuperimpose)
      * @param font_provider_type  Indicate @FontProviderType. Use kAuto in most cases.
@@ -194,6 +312,12 @@ public:
      */
     ARIBCC_API void SetReplaceDRCS(bool replace);
 
+    /**
+     * Indicate how DRCS patterns are scaled to the character size
+     * @param mode default as DRCSScaleMode::kAreaAveraging
+     */
+    ARIBCC_API void SetDRCSScaleMode(DRCSScaleMode mode);
+
     /**
      * Indicate whether always render stroke text for all characters regardless of the indication by CharStyle
      * @param force_stroke default as false
@@ -212,12 +336,34 @@ public:
      */
     ARIBCC_API void SetForceNoBackground(bool force_no_background);
 
+    /**
+     * Indicate whether crop rendered images to the bounding box of their drawn (non-transparent) pixels
+     *
+     * Images are sized by caption regions by default, which leaves mostly transparent padding around the text
+     * if background is not rendered, e.g. with SetForceNoBackground(true). Cropped images have their dst_x / dst_y
+     * adjusted accordingly. Regions drawing nothing visible produce no image.
+     *
+     * @param crop default as false
+     */
+    ARIBCC_API void SetCropImagesToContent(bool crop);
+
     /**
      * Merge rendered region images into one big image on Render() call.
      * @param merge default as false
      */
     ARIBCC_API void SetMergeRegionImages(bool merge);
 
+    /**
+     * Indicate pixel format of images produced by Render()
+     *
+     * With kPAL8, every image is converted into 8-bit palette indices and carries its own palette in Image::palette.
+     * The palette is built from text, stroke and background colors used by the caption, plus blends of them
+     * for antialiased edges. Index 0 is always fully transparent.
+     *
+     * @param pixel_format  kRGBA8888 (default) or kPAL8
+     */
+    ARIBCC_API void SetOutputPixelFormat(PixelFormat pixel_format);
+
     /**
      * Indicate font families (an array of font family names) for default usage
      *
@@ -289,10 +435,61 @@ public:
      * Set storage policy for renderer's internal caption storage
      *
      * @param policy       See @CaptionStoragePolicy
-     * @param upper_limit  Optional parameter, but must has a value for kUpperLimitCount & kUpperLimitDuration
+     * @param upper_limit  Optional parameter, but must has a value for kUpperLimitCount, kUpperLimitDuration
+     *                     & kUpperLimitBytes
      */
     ARIBCC_API void SetStoragePolicy(CaptionStoragePolicy policy, std::optional<size_t> upper_limit = std::nullopt);
 
+    /**
+     * Enable background render-ahead (prefetch) for upcoming captions
+     *
+     * If enabled, a worker thread renders the next count stored captions after the latest Render() PTS,
+     * using the current frame size, margins and other settings. A later Render() call for these captions
+     * returns the prepared images without rasterization, taking the render cost off the caller's thread.
+     *
+     * The renderer should have been initialized. Log callback of the context may be invoked from the worker thread.
+     *
+     * @param count  Number of upcoming captions to render ahead, 0 disables render-ahead (default)
+     * @return true on success
+     */
+    ARIBCC_API bool SetRenderAheadCount(size_t count);
+
+    /**
+     * Set number of threads used for rendering regions of a caption
+     *
+     * If count is greater than 1, count - 1 worker threads are spawned, each owning its own font provider and
+     * text renderer. Regions of a caption which need rasterization are then rendered concurrently by the workers
+     * together with the caller's thread. The output is identical to single-threaded rendering.
+     *
+     * The renderer should have been initialized. Log callback of the context may be invoked from worker threads.
+     *
+     * @param count  Number of rendering threads, 0 or 1 for single-threaded rendering (default)
+     * @return true on success
+     */
+    ARIBCC_API bool SetRenderThreadCount(size_t count);
+
+    /**
+     * Report memory currently held by the renderer, including all rendering threads
+     *
+     * Font data and glyph caches of text renderers backed by system APIs (CoreText, DirectWrite) are managed by
+     * the system and not accounted.
+     */
+    ARIBCC_API RendererMemoryUsage GetMemoryUsage();
+
+    /**
+     * Set a memory budget for everything reported by @GetMemoryUsage()
+     *
+     * The budget is enforced after every AppendCaption() and Render() call. Once exceeded, memory is evicted in the
+     * order of pooled pixel buffers, cached region images, glyph caches, and then stored captions older than
+     * the latest rendered one. Loaded fonts and captions which haven't been rendered are never evicted, so the usage
+     * may still exceed a very small budget.
+     *
+     * Eviction of the render-ahead thread's glyph caches happens asynchronously on that thread.
+     *
+     * @param bytes  Memory budget in bytes, 0 for unlimited (default)
+     */
+    ARIBCC_API void SetMemoryBudget(size_t bytes);
+
     /**
      * Append a caption into renderer's internal storage for subsequent rendering
      *
@@ -337,6 +534,25 @@ public:
      */
     ARIBCC_API RenderStatus Render(int64_t pts, RenderResult& out_result);
 
+    /**
+     * Render caption at specific PTS and composite it directly onto a caller-provided video frame
+     *
+     * The rendered images are alpha-blended onto the frame in its native pixel format, there is no need to
+     * blend RenderResult images onto the frame afterwards. Frame contents are left untouched if no image rendered.
+     *
+     * Unlike @Render(), images are blended again if kGotImageUnchanged is returned, as the frame is a new one.
+     *
+     * Into kRGBA8888 / kBGRA8888 frames, regions of a newly displayed caption are drawn directly without
+     * intermediate images, unless found in the region image cache. YUV frames always get rendered images
+     * blended onto them.
+     *
+     * @param pts    Presentation timestamp, in milliseconds
+     * @param frame  Video frame to composite onto, see @VideoFrame
+     * @return       kGotImage / kGotImageUnchanged if caption has been composited onto the frame
+     *               kError if the frame is invalid
+     */
+    ARIBCC_API RenderStatus RenderToFrame(int64_t pts, VideoFrame& frame);
+
     /**
      * Clear caption storage inside the renderer. Will evict all the appended captions.
      *
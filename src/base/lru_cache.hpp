@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_LRU_CACHE_HPP
+#define ARIBCAPTION_LRU_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace aribcaption {
+
+// Least-recently-used cache bounded by the total cost of its entries.
+// Cost is an arbitrary unit chosen by the user, usually bytes. Entries are evicted from the
+// least recently used end until the total cost fits into the capacity.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LRUCache {
+public:
+    explicit LRUCache(size_t capacity) : capacity_(capacity) {}
+    ~LRUCache() = default;
+public:
+    // Returns nullptr on miss. The returned pointer is valid until the next Put()/Erase()/Clear() call.
+    [[nodiscard]]
+    Value* Get(const Key& key) {
+        auto iter = map_.find(key);
+        if (iter == map_.end()) {
+            miss_count_++;
+            return nullptr;
+        }
+        hit_count_++;
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        return &iter->second->value;
+    }
+
+    // Check existence without affecting the LRU order and statistics
+    [[nodiscard]]
+    bool Contains(const Key& key) const {
+        return map_.find(key) != map_.end();
+    }
+
+    // Same as Get(), but without affecting the LRU order and statistics
+    [[nodiscard]]
+    const Value* Peek(const Key& key) const {
+        auto iter = map_.find(key);
+        if (iter == map_.end()) {
+            return nullptr;
+        }
+        return &iter->second->value;
+    }
+
+    Value& Put(const Key& key, Value value, size_t cost = 1) {
+        auto iter = map_.find(key);
+        if (iter != map_.end()) {
+            total_cost_ -= iter->second->cost;
+            entries_.erase(iter->second);
+            map_.erase(iter);
+        }
+
+        entries_.push_front(Entry{key, std::move(value), cost});
+        map_.emplace(key, entries_.begin());
+        total_cost_ += cost;
+
+        // Always keep the newly inserted entry, even if it exceeds the capacity by itself
+        EvictUntil(capacity_, 1);
+        return entries_.front().value;
+    }
+
+    bool Erase(const Key& key) {
+        auto iter = map_.find(key);
+        if (iter == map_.end()) {
+            return false;
+        }
+        total_cost_ -= iter->second->cost;
+        entries_.erase(iter->second);
+        map_.erase(iter);
+        return true;
+    }
+
+    // Erase all entries that satisfy pred(key, value)
+    template <typename Predicate>
+    size_t EraseIf(Predicate pred) {
+        size_t erased = 0;
+        for (auto iter = entries_.begin(); iter != entries_.end();) {
+            if (pred(static_cast<const Key&>(iter->key), iter->value)) {
+                total_cost_ -= iter->cost;
+                map_.erase(iter->key);
+                iter = entries_.erase(iter);
+                erased++;
+            } else {
+                ++iter;
+            }
+        }
+        return erased;
+    }
+
+    void Clear() {
+        map_.clear();
+        entries_.clear();
+        total_cost_ = 0;
+    }
+
+    void SetCapacity(size_t capacity) {
+        capacity_ = capacity;
+        EvictUntil(capacity_, 0);
+    }
+
+    // Evict least recently used entries until the total cost is not greater than target_cost
+    void Shrink(size_t target_cost) {
+        EvictUntil(target_cost, 0);
+    }
+
+    [[nodiscard]]
+    size_t size() const { return map_.size(); }
+
+    [[nodiscard]]
+    size_t capacity() const { return capacity_; }
+
+    [[nodiscard]]
+    size_t total_cost() const { return total_cost_; }
+
+    [[nodiscard]]
+    uint64_t hit_count() const { return hit_count_; }
+
+    [[nodiscard]]
+    uint64_t miss_count() const { return miss_count_; }
+private:
+    void EvictUntil(size_t target_cost, size_t keep_count) {
+        while (total_cost_ > target_cost && entries_.size() > keep_count) {
+            Entry& last = entries_.back();
+            total_cost_ -= last.cost;
+            map_.erase(last.key);
+            entries_.pop_back();
+        }
+    }
+public:
+    // Disallow copy and assign
+    LRUCache(const LRUCache&) = delete;
+    LRUCache& operator=(const LRUCache&) = delete;
+private:
+    struct Entry {
+        Key key;
+        Value value;
+        size_t cost = 0;
+    };
+
+    size_t capacity_ = 0;
+    size_t total_cost_ = 0;
+    uint64_t hit_count_ = 0;
+    uint64_t miss_count_ = 0;
+
+    std::list<Entry> entries_;
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> map_;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_LRU_CACHE_HPP
@@ -56,6 +56,17 @@ ALWAYS_INLINE void BlendColorToLine(ColorRGBA* __restrict dest, ColorRGBA color,
 #endif
 }
 
+// Blend a solid color into dest, weighted by 8-bit coverage values (e.g. glyph masks)
+// Equivalent to FillLineWithAlphas() into a temporary line followed by BlendLine(), without the temporary line
+ALWAYS_INLINE void BlendColorWithAlphasToLine(ColorRGBA* __restrict dest,
+                                              const uint8_t* __restrict src_alphas, ColorRGBA color, size_t width) {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    internal::BlendColorWithAlphasToLine_x86(dest, src_alphas, color, width);
+#else
+    internal::BlendColorWithAlphasToLine_Generic(dest, src_alphas, color, width);
+#endif
+}
+
 ALWAYS_INLINE void BlendLine(ColorRGBA* __restrict dest, const ColorRGBA* __restrict src, size_t width) {
 #if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
     internal::BlendLine_x86(dest, src, width);
@@ -73,6 +84,26 @@ ALWAYS_INLINE void BlendLine_PremultipliedSrc(ColorRGBA* __restrict dest,
 #endif
 }
 
+ALWAYS_INLINE void BlendLumaLine(uint8_t* __restrict dest, const ColorRGBA* __restrict src,
+                                 size_t width, const YUVCoefficients& k) {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    internal::BlendLumaLine_x86(dest, src, width, k);
+#else
+    internal::BlendLumaLine_Generic(dest, src, width, k);
+#endif
+}
+
+// Blend chroma of 2x2 blocks fully covered by src, see BlendChromaLine_Generic()
+ALWAYS_INLINE void BlendChromaLine(uint8_t* __restrict u_dest, uint8_t* __restrict v_dest, size_t step,
+                                   const ColorRGBA* __restrict src_top, const ColorRGBA* __restrict src_bottom,
+                                   size_t width, const YUVCoefficients& k) {
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    internal::BlendChromaLine_x86(u_dest, v_dest, step, src_top, src_bottom, width, k);
+#else
+    internal::BlendChromaLine_Generic(u_dest, v_dest, step, src_top, src_bottom, width, k);
+#endif
+}
+
 }  // namespace aribcaption::alphablend
 
 #endif  // ARIBCAPTION_ALPHA_BLEND_HPP
@@ -21,6 +21,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <initializer_list>
 #include "aribcaption/color.hpp"
 #include "base/always_inline.hpp"
 
@@ -74,6 +75,35 @@ ALWAYS_INLINE ColorRGBA BlendColor_PremultipliedSrc(ColorRGBA bg_color, ColorRGB
     return ColorRGBA((b_r & mask_b_r) | (a_g & mask_a_g));
 }
 
+// RGB => YCbCr conversion coefficients, in 16.16 fixed point
+struct YUVCoefficients {
+    int32_t y_r, y_g, y_b, y_offset;
+    int32_t u_r, u_g, u_b;
+    int32_t v_r, v_g, v_b;
+    int32_t uv_offset;
+};
+
+ALWAYS_INLINE uint32_t ConvertToY(const YUVCoefficients& k, ColorRGBA color) {
+    return static_cast<uint32_t>(k.y_r * color.r + k.y_g * color.g + k.y_b * color.b + k.y_offset) >> 16;
+}
+
+ALWAYS_INLINE int32_t ConvertToU(const YUVCoefficients& k, ColorRGBA color) {
+    return (k.u_r * color.r + k.u_g * color.g + k.u_b * color.b + k.uv_offset) >> 16;
+}
+
+ALWAYS_INLINE int32_t ConvertToV(const YUVCoefficients& k, ColorRGBA color) {
+    return (k.v_r * color.r + k.v_g * color.g + k.v_b * color.b + k.uv_offset) >> 16;
+}
+
+// Blend chroma of a 2x2 block, weighted by the coverage of each pixel within the block
+// sum_alpha is the sum of alphas of the pixels, sum_chroma is the sum of chroma * alpha of the pixels
+// Alpha of the block is the average of 4 pixels, i.e. sum_alpha / (255 * 4)
+ALWAYS_INLINE uint8_t BlendChromaBlock(uint8_t dest, int32_t sum_alpha, int32_t sum_chroma) {
+    constexpr int32_t kFullAlpha = 255 * 4;
+    int32_t chroma = (dest * (kFullAlpha - sum_alpha) + sum_chroma + kFullAlpha / 2) / kFullAlpha;
+    return Clamp255(static_cast<uint32_t>(chroma));  // Cb of full range pure blue rounds up to 256
+}
+
 
 namespace internal {
 
@@ -97,6 +127,14 @@ ALWAYS_INLINE void BlendColorToLine_Generic(ColorRGBA* __restrict dest, ColorRGB
     }
 }
 
+ALWAYS_INLINE void BlendColorWithAlphasToLine_Generic(ColorRGBA* __restrict dest, const uint8_t* __restrict src_alphas,
+                                                      ColorRGBA color, size_t width) {
+    for (size_t i = 0; i < width; i++) {
+        uint8_t alpha = (static_cast<uint32_t>(src_alphas[i]) * color.a) >> 8;
+        dest[i] = BlendColor(dest[i], ColorRGBA(color, alpha));
+    }
+}
+
 ALWAYS_INLINE void BlendLine_Generic(ColorRGBA* __restrict dest, const ColorRGBA* __restrict src, size_t width) {
     for (size_t i = 0; i < width; i++) {
         dest[i] = BlendColor(dest[i], src[i]);
@@ -110,6 +148,38 @@ ALWAYS_INLINE void BlendLine_PremultipliedSrc_Generic(ColorRGBA* __restrict dest
     }
 }
 
+// Blend luma of src pixels onto a line of the Y plane
+ALWAYS_INLINE void BlendLumaLine_Generic(uint8_t* __restrict dest, const ColorRGBA* __restrict src,
+                                         size_t width, const YUVCoefficients& k) {
+    // Branchless for letting the compiler vectorize this loop
+    for (size_t i = 0; i < width; i++) {
+        uint32_t alpha = src[i].a;
+        dest[i] = static_cast<uint8_t>(Div255(dest[i] * (255 - alpha) + ConvertToY(k, src[i]) * alpha));
+    }
+}
+
+// Blend chroma of width 2x2 blocks onto a line of the U and V planes, step is the distance between samples
+// src_top and src_bottom point to the 2 source lines of the blocks, 2 * width pixels each
+ALWAYS_INLINE void BlendChromaLine_Generic(uint8_t* __restrict u_dest, uint8_t* __restrict v_dest, size_t step,
+                                           const ColorRGBA* __restrict src_top,
+                                           const ColorRGBA* __restrict src_bottom,
+                                           size_t width, const YUVCoefficients& k) {
+    for (size_t i = 0; i < width; i++) {
+        int32_t sum_alpha = 0;
+        int32_t sum_u = 0;
+        int32_t sum_v = 0;
+
+        for (ColorRGBA color : {src_top[i * 2], src_top[i * 2 + 1], src_bottom[i * 2], src_bottom[i * 2 + 1]}) {
+            sum_alpha += color.a;
+            sum_u += ConvertToU(k, color) * color.a;
+            sum_v += ConvertToV(k, color) * color.a;
+        }
+
+        u_dest[i * step] = BlendChromaBlock(u_dest[i * step], sum_alpha, sum_u);
+        v_dest[i * step] = BlendChromaBlock(v_dest[i * step], sum_alpha, sum_v);
+    }
+}
+
 }  // namespace internal
 
 
@@ -0,0 +1,713 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+#include "renderer/alphablend_x86.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+// AVX2 / AVX-512 kernels are compiled with function level target attributes on gcc/clang, so that the rest of
+// the library (and the SSE2 fallback) stays compatible with CPUs lacking these instruction sets.
+// MSVC allows using these intrinsics without any special compiler flags.
+#if defined(__GNUC__) || defined(__clang__)
+    #define TARGET_AVX2 __attribute__((target("avx2")))
+    #define TARGET_AVX512BW __attribute__((target("avx2,avx512f,avx512bw")))
+#else
+    #define TARGET_AVX2
+    #define TARGET_AVX512BW
+#endif
+
+namespace aribcaption::alphablend::internal::x86 {
+
+// Baseline kernels, SSE2 if available at compile time
+static void FillLine_Baseline(ColorRGBA* dest, ColorRGBA color, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    FillLine_SSE2(dest, color, width);
+#else
+    FillLine_Generic(dest, color, width);
+#endif
+}
+
+static void FillLineWithAlphas_Baseline(ColorRGBA* dest, const uint8_t* src_alphas, ColorRGBA color, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    FillLineWithAlphas_SSE2(dest, src_alphas, color, width);
+#else
+    FillLineWithAlphas_Generic(dest, src_alphas, color, width);
+#endif
+}
+
+static void BlendColorToLine_Baseline(ColorRGBA* dest, ColorRGBA color, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendColorToLine_SSE2(dest, color, width);
+#else
+    BlendColorToLine_Generic(dest, color, width);
+#endif
+}
+
+static void BlendColorWithAlphasToLine_Baseline(ColorRGBA* dest, const uint8_t* src_alphas,
+                                                ColorRGBA color, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendColorWithAlphasToLine_SSE2(dest, src_alphas, color, width);
+#else
+    BlendColorWithAlphasToLine_Generic(dest, src_alphas, color, width);
+#endif
+}
+
+static void BlendLine_Baseline(ColorRGBA* dest, const ColorRGBA* src, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendLine_SSE2(dest, src, width);
+#else
+    BlendLine_Generic(dest, src, width);
+#endif
+}
+
+static void BlendLine_PremultipliedSrc_Baseline(ColorRGBA* dest, const ColorRGBA* src, size_t width) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendLine_PremultipliedSrc_SSE2(dest, src, width);
+#else
+    BlendLine_PremultipliedSrc_Generic(dest, src, width);
+#endif
+}
+
+static void BlendLumaLine_Baseline(uint8_t* dest, const ColorRGBA* src, size_t width, const YUVCoefficients& k) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendLumaLine_SSE2(dest, src, width, k);
+#else
+    BlendLumaLine_Generic(dest, src, width, k);
+#endif
+}
+
+static void BlendChromaLine_Baseline(uint8_t* u_dest, uint8_t* v_dest, size_t step,
+                                     const ColorRGBA* src_top, const ColorRGBA* src_bottom,
+                                     size_t width, const YUVCoefficients& k) {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    BlendChromaLine_SSE2(u_dest, v_dest, step, src_top, src_bottom, width, k);
+#else
+    BlendChromaLine_Generic(u_dest, v_dest, step, src_top, src_bottom, width, k);
+#endif
+}
+
+static const Kernels kBaselineKernels = {
+#if defined(__SSE2__) || defined(_MSC_VER)
+    "sse2",
+#else
+    "generic",
+#endif
+    FillLine_Baseline,
+    FillLineWithAlphas_Baseline,
+    BlendColorToLine_Baseline,
+    BlendColorWithAlphasToLine_Baseline,
+    BlendLine_Baseline,
+    BlendLine_PremultipliedSrc_Baseline,
+    BlendLumaLine_Baseline,
+    BlendChromaLine_Baseline,
+};
+
+// The wider kernels share the arithmetic of the SSE2 kernels and produce identical results,
+// the remaining pixels that don't fill a whole vector are handed to the baseline kernels.
+
+//
+// AVX2, 8 pixels per iteration
+//
+
+// Expand 8 coverage values into colored pixels, alpha = (coverage * color.a) >> 8
+TARGET_AVX2 static inline __m256i ColorWithAlphas_AVX2(const uint8_t* src_alphas,
+                                                       __m256i color8_rgb, __m256i color8_alpha) {
+    const __m256i mask_0xff000000 = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+
+    __m128i alphas = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src_alphas));
+    __m256i alpha8 = _mm256_slli_epi32(_mm256_cvtepu8_epi32(alphas), 16);
+
+    __m256i weighted_alpha = _mm256_and_si256(mask_0xff000000, _mm256_mullo_epi16(color8_alpha, alpha8));
+    return _mm256_or_si256(color8_rgb, weighted_alpha);
+}
+
+// Multiply src color by its alpha, outputs 255 - alpha for each 16-bit channel into ff_minus_alpha
+TARGET_AVX2 static inline __m256i Premultiply_AVX2(__m256i src, __m256i* ff_minus_alpha) {
+    const __m256i mask_0x00ff0000 = _mm256_set1_epi32(0x00FF0000);
+    const __m256i mask_0x00ff00ff = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i mask_0xff00ff00 = _mm256_set1_epi32(static_cast<int>(0xFF00FF00));
+
+    __m256i src_a_g = _mm256_srli_epi16(src, 8);                      // 0x00AA00GG
+    __m256i src_b_r = _mm256_and_si256(src, mask_0x00ff00ff);         // 0x00BB00RR
+    __m256i src_alpha = _mm256_shufflelo_epi16(src_a_g, 0b11110101);  // (lo)0x00AA00AA
+
+    src_a_g = _mm256_or_si256(src_a_g, mask_0x00ff0000);              // 0x00FF00GG
+    src_alpha = _mm256_shufflehi_epi16(src_alpha, 0b11110101);        // (hi)0x00AA00AA
+
+    src_b_r = _mm256_mullo_epi16(src_b_r, src_alpha);
+    src_a_g = _mm256_mullo_epi16(src_a_g, src_alpha);
+
+    src_b_r = _mm256_srli_epi16(src_b_r, 8);                          // 0x00BB00RR
+    src_a_g = _mm256_and_si256(src_a_g, mask_0xff00ff00);             // 0xAA00GG00
+
+    *ff_minus_alpha = _mm256_xor_si256(src_alpha, mask_0x00ff00ff);
+    return _mm256_or_si256(src_b_r, src_a_g);                         // (src)0xAABBGGRR
+}
+
+// out = premultiplied_src + dst * (255 - src_alpha) / 256
+TARGET_AVX2 static inline __m256i BlendPremultiplied_AVX2(__m256i premultiplied_src,
+                                                          __m256i src_ff_minus_alpha, __m256i dst) {
+    const __m256i mask_0x00ff00ff = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i mask_0xff00ff00 = _mm256_set1_epi32(static_cast<int>(0xFF00FF00));
+
+    __m256i dst_b_r = _mm256_and_si256(dst, mask_0x00ff00ff);
+    __m256i dst_a_g = _mm256_srli_epi16(dst, 8);
+
+    dst_b_r = _mm256_mullo_epi16(dst_b_r, src_ff_minus_alpha);
+    dst_a_g = _mm256_mullo_epi16(dst_a_g, src_ff_minus_alpha);
+
+    dst_b_r = _mm256_srli_epi16(dst_b_r, 8);
+    dst_a_g = _mm256_and_si256(dst_a_g, mask_0xff00ff00);
+
+    return _mm256_adds_epu8(premultiplied_src, _mm256_or_si256(dst_b_r, dst_a_g));
+}
+
+TARGET_AVX2 static void FillLine_AVX2(ColorRGBA* dest, ColorRGBA color, size_t width) {
+    __m256i color8 = _mm256_set1_epi32(static_cast<int>(color.u32));
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), color8);
+    }
+
+    if (i < width) {
+        FillLine_Baseline(dest + i, color, width - i);
+    }
+}
+
+TARGET_AVX2 static void FillLineWithAlphas_AVX2(ColorRGBA* dest, const uint8_t* src_alphas,
+                                                ColorRGBA color, size_t width) {
+    __m256i color8 = _mm256_set1_epi32(static_cast<int>(color.u32));
+    __m256i color8_rgb = _mm256_and_si256(color8, _mm256_set1_epi32(0x00FFFFFF));
+    __m256i color8_alpha = _mm256_srli_epi32(_mm256_andnot_si256(_mm256_set1_epi32(0x00FFFFFF), color8), 8);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i result = ColorWithAlphas_AVX2(src_alphas + i, color8_rgb, color8_alpha);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), result);
+    }
+
+    if (i < width) {
+        FillLineWithAlphas_Baseline(dest + i, src_alphas + i, color, width - i);
+    }
+}
+
+TARGET_AVX2 static void BlendColorToLine_AVX2(ColorRGBA* dest, ColorRGBA color, size_t width) {
+    __m256i src_ff_minus_alpha;
+    __m256i premultiplied_src = Premultiply_AVX2(_mm256_set1_epi32(static_cast<int>(color.u32)),
+                                                 &src_ff_minus_alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i dst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+        __m256i result = BlendPremultiplied_AVX2(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), result);
+    }
+
+    if (i < width) {
+        BlendColorToLine_Baseline(dest + i, color, width - i);
+    }
+}
+
+TARGET_AVX2 static void BlendColorWithAlphasToLine_AVX2(ColorRGBA* dest, const uint8_t* src_alphas,
+                                                        ColorRGBA color, size_t width) {
+    __m256i color8 = _mm256_set1_epi32(static_cast<int>(color.u32));
+    __m256i color8_rgb = _mm256_and_si256(color8, _mm256_set1_epi32(0x00FFFFFF));
+    __m256i color8_alpha = _mm256_srli_epi32(_mm256_andnot_si256(_mm256_set1_epi32(0x00FFFFFF), color8), 8);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i src_ff_minus_alpha;
+        __m256i src = ColorWithAlphas_AVX2(src_alphas + i, color8_rgb, color8_alpha);
+        __m256i premultiplied_src = Premultiply_AVX2(src, &src_ff_minus_alpha);
+
+        __m256i dst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+        __m256i result = BlendPremultiplied_AVX2(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), result);
+    }
+
+    if (i < width) {
+        BlendColorWithAlphasToLine_Baseline(dest + i, src_alphas + i, color, width - i);
+    }
+}
+
+TARGET_AVX2 static void BlendLine_AVX2(ColorRGBA* dest, const ColorRGBA* source, size_t width) {
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i src_ff_minus_alpha;
+        __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i premultiplied_src = Premultiply_AVX2(src, &src_ff_minus_alpha);
+
+        __m256i dst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+        __m256i result = BlendPremultiplied_AVX2(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), result);
+    }
+
+    if (i < width) {
+        BlendLine_Baseline(dest + i, source + i, width - i);
+    }
+}
+
+TARGET_AVX2 static void BlendLine_PremultipliedSrc_AVX2(ColorRGBA* dest, const ColorRGBA* source, size_t width) {
+    const __m256i mask_0x00ff00ff = _mm256_set1_epi32(0x00FF00FF);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i src_000000aa = _mm256_srli_epi32(src, 24);
+        __m256i src_alpha = _mm256_or_si256(src_000000aa, _mm256_slli_epi32(src_000000aa, 16));
+        __m256i src_ff_minus_alpha = _mm256_xor_si256(src_alpha, mask_0x00ff00ff);
+
+        __m256i dst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dest + i));
+        __m256i result = BlendPremultiplied_AVX2(src, src_ff_minus_alpha, dst);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), result);
+    }
+
+    if (i < width) {
+        BlendLine_PremultipliedSrc_Baseline(dest + i, source + i, width - i);
+    }
+}
+
+// Coefficients of a YCbCr component, see YUVComponent_SSE2
+struct YUVComponent_AVX2 {
+    __m256i hi_b_r;
+    __m256i hi_a_g;
+    __m256i lo_b_r;
+    __m256i lo_a_g;
+    __m256i offset;
+};
+
+TARGET_AVX2 static inline YUVComponent_AVX2 SplitYUVComponent_AVX2(int32_t c_r, int32_t c_g, int32_t c_b,
+                                                                   int32_t offset) {
+    auto pair = [](int32_t low, int32_t high) {
+        return static_cast<int>((static_cast<uint32_t>(high) << 16) | (static_cast<uint32_t>(low) & 0xFFFF));
+    };
+
+    YUVComponent_AVX2 component;
+    component.hi_b_r = _mm256_set1_epi32(pair(c_r >> 8, c_b >> 8));
+    component.hi_a_g = _mm256_set1_epi32(pair(c_g >> 8, 0));
+    component.lo_b_r = _mm256_set1_epi32(pair(c_r & 0xFF, c_b & 0xFF));
+    component.lo_a_g = _mm256_set1_epi32(pair(c_g & 0xFF, 0));
+    component.offset = _mm256_set1_epi32(offset);
+    return component;
+}
+
+TARGET_AVX2 static inline __m256i ConvertComponent_AVX2(__m256i src_b_r, __m256i src_a_g,
+                                                        const YUVComponent_AVX2& c) {
+    __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(src_b_r, c.hi_b_r), _mm256_madd_epi16(src_a_g, c.hi_a_g));
+    __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(src_b_r, c.lo_b_r), _mm256_madd_epi16(src_a_g, c.lo_a_g));
+    return _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(hi, 8), lo), c.offset), 16);
+}
+
+// Pack 8 values in 32-bit lanes into 8 bytes with unsigned saturation
+TARGET_AVX2 static inline __m128i PackToBytes_AVX2(__m256i x) {
+    __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(x, x), _mm256_setzero_si256());
+    return _mm_unpacklo_epi32(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+}
+
+TARGET_AVX2 static void BlendLumaLine_AVX2(uint8_t* dest, const ColorRGBA* source,
+                                           size_t width, const YUVCoefficients& k) {
+    const __m256i mask_0x00ff00ff = _mm256_set1_epi32(0x00FF00FF);
+    const __m256i mask_0x000000ff = _mm256_set1_epi32(0x000000FF);
+    YUVComponent_AVX2 y = SplitYUVComponent_AVX2(k.y_r, k.y_g, k.y_b, k.y_offset);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m256i src = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+        __m256i dst = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(dest + i)));
+
+        __m256i luma = ConvertComponent_AVX2(_mm256_and_si256(src, mask_0x00ff00ff), _mm256_srli_epi16(src, 8), y);
+        __m256i alpha = _mm256_srli_epi32(src, 24);
+        __m256i ff_minus_alpha = _mm256_xor_si256(alpha, mask_0x000000ff);
+
+        __m256i blended = _mm256_madd_epi16(_mm256_or_si256(dst, _mm256_slli_epi32(luma, 16)),
+                                            _mm256_or_si256(ff_minus_alpha, _mm256_slli_epi32(alpha, 16)));
+        blended = _mm256_add_epi32(_mm256_add_epi32(blended, _mm256_set1_epi32(1)), _mm256_srli_epi32(blended, 8));
+        blended = _mm256_srli_epi32(blended, 8);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i), PackToBytes_AVX2(blended));
+    }
+
+    if (i < width) {
+        BlendLumaLine_Baseline(dest + i, source + i, width - i, k);
+    }
+}
+
+struct ChromaWeights_AVX2 {
+    __m256i alpha;
+    __m256i u;
+    __m256i v;
+};
+
+TARGET_AVX2 static inline ChromaWeights_AVX2 WeightChroma8_AVX2(__m256i src, const YUVComponent_AVX2& u,
+                                                                const YUVComponent_AVX2& v) {
+    const __m256i mask_0x00ff00ff = _mm256_set1_epi32(0x00FF00FF);
+
+    __m256i src_b_r = _mm256_and_si256(src, mask_0x00ff00ff);
+    __m256i src_a_g = _mm256_srli_epi16(src, 8);
+    __m256i alpha = _mm256_srli_epi32(src, 24);
+
+    ChromaWeights_AVX2 weights;
+    weights.alpha = alpha;
+    weights.u = _mm256_madd_epi16(ConvertComponent_AVX2(src_b_r, src_a_g, u), alpha);
+    weights.v = _mm256_madd_epi16(ConvertComponent_AVX2(src_b_r, src_a_g, v), alpha);
+    return weights;
+}
+
+// Sum each 2 horizontally adjacent pixels of x0 and x1 (8 pixels each), into 8 lanes of blocks
+TARGET_AVX2 static inline __m256i SumPixelPairs_AVX2(__m256i x0, __m256i x1) {
+    __m256 f0 = _mm256_castsi256_ps(x0);
+    __m256 f1 = _mm256_castsi256_ps(x1);
+    __m256i even = _mm256_castps_si256(_mm256_shuffle_ps(f0, f1, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m256i odd = _mm256_castps_si256(_mm256_shuffle_ps(f0, f1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+    // Shuffles are per 128-bit lane, blocks are in the order of 0 1 4 5 2 3 6 7
+    return _mm256_permute4x64_epi64(_mm256_add_epi32(even, odd), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+TARGET_AVX2 static inline __m256i BlendChromaBlocks_AVX2(__m256i dst, __m256i sum_alpha, __m256i sum_chroma) {
+    const __m256i full_alpha = _mm256_set1_epi32(255 * 4);
+    const __m256i magic = _mm256_set1_epi32(1052689);  // ceil(2^30 / 1020), see Div1020_SSE2()
+
+    __m256i blended = _mm256_add_epi32(_mm256_madd_epi16(dst, _mm256_sub_epi32(full_alpha, sum_alpha)), sum_chroma);
+    blended = _mm256_add_epi32(blended, _mm256_set1_epi32(255 * 2));
+
+    __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(blended, magic), 30);
+    __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(blended, 32), magic), 30);
+    return _mm256_or_si256(even, _mm256_slli_epi64(odd, 32));
+}
+
+TARGET_AVX2 static void BlendChromaLine_AVX2(uint8_t* u_dest, uint8_t* v_dest, size_t step,
+                                             const ColorRGBA* src_top, const ColorRGBA* src_bottom,
+                                             size_t width, const YUVCoefficients& k) {
+    const __m256i mask_0x0000ffff = _mm256_set1_epi32(0x0000FFFF);
+
+    bool interleaved = step == 2 && v_dest == u_dest + 1;
+    if (!interleaved && step != 1) {
+        BlendChromaLine_Baseline(u_dest, v_dest, step, src_top, src_bottom, width, k);
+        return;
+    }
+
+    YUVComponent_AVX2 u = SplitYUVComponent_AVX2(k.u_r, k.u_g, k.u_b, k.uv_offset);
+    YUVComponent_AVX2 v = SplitYUVComponent_AVX2(k.v_r, k.v_g, k.v_b, k.uv_offset);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        // 8 blocks, 16 pixels of each source line
+        ChromaWeights_AVX2 halves[2];
+        for (size_t half = 0; half < 2; half++) {
+            size_t offset = i * 2 + half * 8;
+            ChromaWeights_AVX2 top = WeightChroma8_AVX2(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_top + offset)), u, v);
+            ChromaWeights_AVX2 bottom = WeightChroma8_AVX2(
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src_bottom + offset)), u, v);
+            halves[half].alpha = _mm256_add_epi32(top.alpha, bottom.alpha);
+            halves[half].u = _mm256_add_epi32(top.u, bottom.u);
+            halves[half].v = _mm256_add_epi32(top.v, bottom.v);
+        }
+
+        __m256i sum_alpha = SumPixelPairs_AVX2(halves[0].alpha, halves[1].alpha);
+        __m256i sum_u = SumPixelPairs_AVX2(halves[0].u, halves[1].u);
+        __m256i sum_v = SumPixelPairs_AVX2(halves[0].v, halves[1].v);
+
+        if (interleaved) {
+            // 0x0000UUUU | 0xVVVV0000 in each lane
+            uint8_t* uv_dest = u_dest + i * 2;
+            __m256i dst = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(uv_dest)));
+
+            __m256i result_u = BlendChromaBlocks_AVX2(_mm256_and_si256(dst, mask_0x0000ffff), sum_alpha, sum_u);
+            __m256i result_v = BlendChromaBlocks_AVX2(_mm256_srli_epi32(dst, 16), sum_alpha, sum_v);
+
+            __m256i result = _mm256_or_si256(result_u, _mm256_slli_epi32(result_v, 16));
+            result = _mm256_packus_epi16(result, result);
+            __m128i packed = _mm_unpacklo_epi64(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(uv_dest), packed);
+        } else {
+            __m256i dst_u = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u_dest + i)));
+            __m256i dst_v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v_dest + i)));
+
+            __m256i result_u = BlendChromaBlocks_AVX2(dst_u, sum_alpha, sum_u);
+            __m256i result_v = BlendChromaBlocks_AVX2(dst_v, sum_alpha, sum_v);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(u_dest + i), PackToBytes_AVX2(result_u));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(v_dest + i), PackToBytes_AVX2(result_v));
+        }
+    }
+
+    if (i < width) {
+        BlendChromaLine_Baseline(u_dest + i * step, v_dest + i * step, step,
+                                 src_top + i * 2, src_bottom + i * 2, width - i, k);
+    }
+}
+
+static const Kernels kAVX2Kernels = {
+    "avx2",
+    FillLine_AVX2,
+    FillLineWithAlphas_AVX2,
+    BlendColorToLine_AVX2,
+    BlendColorWithAlphasToLine_AVX2,
+    BlendLine_AVX2,
+    BlendLine_PremultipliedSrc_AVX2,
+    BlendLumaLine_AVX2,
+    BlendChromaLine_AVX2,
+};
+
+//
+// AVX-512BW, 16 pixels per iteration, the remaining pixels are handled with masked loads and stores
+//
+
+// gcc 12 warns about _mm512_undefined_epi32() used inside its own AVX-512 intrinsics (false positive)
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+TARGET_AVX512BW static inline __mmask16 TailMask_AVX512(size_t remain) {
+    return static_cast<__mmask16>((1u << remain) - 1);
+}
+
+TARGET_AVX512BW static inline __m512i ColorWithAlphas_AVX512(__m128i alphas,
+                                                             __m512i color16_rgb, __m512i color16_alpha) {
+    const __m512i mask_0xff000000 = _mm512_set1_epi32(static_cast<int>(0xFF000000));
+
+    __m512i alpha16 = _mm512_slli_epi32(_mm512_cvtepu8_epi32(alphas), 16);
+
+    __m512i weighted_alpha = _mm512_and_si512(mask_0xff000000, _mm512_mullo_epi16(color16_alpha, alpha16));
+    return _mm512_or_si512(color16_rgb, weighted_alpha);
+}
+
+// Load up to 16 coverage values, without reading past the end of src_alphas
+TARGET_AVX512BW static inline __m128i LoadAlphas_AVX512(const uint8_t* src_alphas, size_t count) {
+    if (count >= 16) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_alphas));
+    }
+    alignas(16) uint8_t buffer[16] = {0};
+    memcpy(buffer, src_alphas, count);
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(buffer));
+}
+
+TARGET_AVX512BW static inline __m512i Premultiply_AVX512(__m512i src, __m512i* ff_minus_alpha) {
+    const __m512i mask_0x00ff0000 = _mm512_set1_epi32(0x00FF0000);
+    const __m512i mask_0x00ff00ff = _mm512_set1_epi32(0x00FF00FF);
+    const __m512i mask_0xff00ff00 = _mm512_set1_epi32(static_cast<int>(0xFF00FF00));
+
+    __m512i src_a_g = _mm512_srli_epi16(src, 8);                      // 0x00AA00GG
+    __m512i src_b_r = _mm512_and_si512(src, mask_0x00ff00ff);         // 0x00BB00RR
+    __m512i src_alpha = _mm512_shufflelo_epi16(src_a_g, 0b11110101);  // (lo)0x00AA00AA
+
+    src_a_g = _mm512_or_si512(src_a_g, mask_0x00ff0000);              // 0x00FF00GG
+    src_alpha = _mm512_shufflehi_epi16(src_alpha, 0b11110101);        // (hi)0x00AA00AA
+
+    src_b_r = _mm512_mullo_epi16(src_b_r, src_alpha);
+    src_a_g = _mm512_mullo_epi16(src_a_g, src_alpha);
+
+    src_b_r = _mm512_srli_epi16(src_b_r, 8);                          // 0x00BB00RR
+    src_a_g = _mm512_and_si512(src_a_g, mask_0xff00ff00);             // 0xAA00GG00
+
+    *ff_minus_alpha = _mm512_xor_si512(src_alpha, mask_0x00ff00ff);
+    return _mm512_or_si512(src_b_r, src_a_g);                         // (src)0xAABBGGRR
+}
+
+TARGET_AVX512BW static inline __m512i BlendPremultiplied_AVX512(__m512i premultiplied_src,
+                                                                __m512i src_ff_minus_alpha, __m512i dst) {
+    const __m512i mask_0x00ff00ff = _mm512_set1_epi32(0x00FF00FF);
+    const __m512i mask_0xff00ff00 = _mm512_set1_epi32(static_cast<int>(0xFF00FF00));
+
+    __m512i dst_b_r = _mm512_and_si512(dst, mask_0x00ff00ff);
+    __m512i dst_a_g = _mm512_srli_epi16(dst, 8);
+
+    dst_b_r = _mm512_mullo_epi16(dst_b_r, src_ff_minus_alpha);
+    dst_a_g = _mm512_mullo_epi16(dst_a_g, src_ff_minus_alpha);
+
+    dst_b_r = _mm512_srli_epi16(dst_b_r, 8);
+    dst_a_g = _mm512_and_si512(dst_a_g, mask_0xff00ff00);
+
+    return _mm512_adds_epu8(premultiplied_src, _mm512_or_si512(dst_b_r, dst_a_g));
+}
+
+TARGET_AVX512BW static void FillLine_AVX512(ColorRGBA* dest, ColorRGBA color, size_t width) {
+    __m512i color16 = _mm512_set1_epi32(static_cast<int>(color.u32));
+
+    for (size_t i = 0; i < width; i += 16) {
+        __mmask16 mask = TailMask_AVX512(width - i < 16 ? width - i : 16);
+        _mm512_mask_storeu_epi32(dest + i, mask, color16);
+    }
+}
+
+TARGET_AVX512BW static void FillLineWithAlphas_AVX512(ColorRGBA* dest, const uint8_t* src_alphas,
+                                                      ColorRGBA color, size_t width) {
+    __m512i color16 = _mm512_set1_epi32(static_cast<int>(color.u32));
+    __m512i color16_rgb = _mm512_and_si512(color16, _mm512_set1_epi32(0x00FFFFFF));
+    __m512i color16_alpha = _mm512_srli_epi32(_mm512_andnot_si512(_mm512_set1_epi32(0x00FFFFFF), color16), 8);
+
+    for (size_t i = 0; i < width; i += 16) {
+        size_t count = width - i < 16 ? width - i : 16;
+        __m512i result = ColorWithAlphas_AVX512(LoadAlphas_AVX512(src_alphas + i, count),
+                                                color16_rgb, color16_alpha);
+        _mm512_mask_storeu_epi32(dest + i, TailMask_AVX512(count), result);
+    }
+}
+
+TARGET_AVX512BW static void BlendColorToLine_AVX512(ColorRGBA* dest, ColorRGBA color, size_t width) {
+    __m512i src_ff_minus_alpha;
+    __m512i premultiplied_src = Premultiply_AVX512(_mm512_set1_epi32(static_cast<int>(color.u32)),
+                                                   &src_ff_minus_alpha);
+
+    for (size_t i = 0; i < width; i += 16) {
+        __mmask16 mask = TailMask_AVX512(width - i < 16 ? width - i : 16);
+        __m512i dst = _mm512_maskz_loadu_epi32(mask, dest + i);
+        __m512i result = BlendPremultiplied_AVX512(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm512_mask_storeu_epi32(dest + i, mask, result);
+    }
+}
+
+TARGET_AVX512BW static void BlendColorWithAlphasToLine_AVX512(ColorRGBA* dest, const uint8_t* src_alphas,
+                                                              ColorRGBA color, size_t width) {
+    __m512i color16 = _mm512_set1_epi32(static_cast<int>(color.u32));
+    __m512i color16_rgb = _mm512_and_si512(color16, _mm512_set1_epi32(0x00FFFFFF));
+    __m512i color16_alpha = _mm512_srli_epi32(_mm512_andnot_si512(_mm512_set1_epi32(0x00FFFFFF), color16), 8);
+
+    for (size_t i = 0; i < width; i += 16) {
+        size_t count = width - i < 16 ? width - i : 16;
+        __mmask16 mask = TailMask_AVX512(count);
+
+        __m512i src_ff_minus_alpha;
+        __m512i src = ColorWithAlphas_AVX512(LoadAlphas_AVX512(src_alphas + i, count),
+                                             color16_rgb, color16_alpha);
+        __m512i premultiplied_src = Premultiply_AVX512(src, &src_ff_minus_alpha);
+
+        __m512i dst = _mm512_maskz_loadu_epi32(mask, dest + i);
+        __m512i result = BlendPremultiplied_AVX512(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm512_mask_storeu_epi32(dest + i, mask, result);
+    }
+}
+
+TARGET_AVX512BW static void BlendLine_AVX512(ColorRGBA* dest, const ColorRGBA* source, size_t width) {
+    for (size_t i = 0; i < width; i += 16) {
+        __mmask16 mask = TailMask_AVX512(width - i < 16 ? width - i : 16);
+
+        __m512i src_ff_minus_alpha;
+        __m512i src = _mm512_maskz_loadu_epi32(mask, source + i);
+        __m512i premultiplied_src = Premultiply_AVX512(src, &src_ff_minus_alpha);
+
+        __m512i dst = _mm512_maskz_loadu_epi32(mask, dest + i);
+        __m512i result = BlendPremultiplied_AVX512(premultiplied_src, src_ff_minus_alpha, dst);
+        _mm512_mask_storeu_epi32(dest + i, mask, result);
+    }
+}
+
+TARGET_AVX512BW static void BlendLine_PremultipliedSrc_AVX512(ColorRGBA* dest, const ColorRGBA* source,
+                                                              size_t width) {
+    const __m512i mask_0x00ff00ff = _mm512_set1_epi32(0x00FF00FF);
+
+    for (size_t i = 0; i < width; i += 16) {
+        __mmask16 mask = TailMask_AVX512(width - i < 16 ? width - i : 16);
+
+        __m512i src = _mm512_maskz_loadu_epi32(mask, source + i);
+        __m512i src_000000aa = _mm512_srli_epi32(src, 24);
+        __m512i src_alpha = _mm512_or_si512(src_000000aa, _mm512_slli_epi32(src_000000aa, 16));
+        __m512i src_ff_minus_alpha = _mm512_xor_si512(src_alpha, mask_0x00ff00ff);
+
+        __m512i dst = _mm512_maskz_loadu_epi32(mask, dest + i);
+        __m512i result = BlendPremultiplied_AVX512(src, src_ff_minus_alpha, dst);
+        _mm512_mask_storeu_epi32(dest + i, mask, result);
+    }
+}
+
+static const Kernels kAVX512BWKernels = {
+    "avx512bw",
+    FillLine_AVX512,
+    FillLineWithAlphas_AVX512,
+    BlendColorToLine_AVX512,
+    BlendColorWithAlphasToLine_AVX512,
+    BlendLine_AVX512,
+    BlendLine_PremultipliedSrc_AVX512,
+    BlendLumaLine_AVX2,      // AVX-512BW implies AVX2, YUV kernels are shared with AVX2
+    BlendChromaLine_AVX2,
+};
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+//
+// CPU feature detection
+//
+
+struct CPUFeatures {
+    bool avx2 = false;
+    bool avx512bw = false;
+};
+
+static CPUFeatures DetectCPUFeatures() {
+    CPUFeatures features;
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.avx512bw = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#elif defined(_MSC_VER)
+    int info[4] = {0};
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    if (max_leaf < 7) {
+        return features;
+    }
+
+    __cpuid(info, 1);
+    bool osxsave = info[2] & (1 << 27);
+    bool avx = info[2] & (1 << 28);
+    if (!osxsave || !avx) {
+        return features;
+    }
+
+    // Check whether the OS saves YMM (and ZMM) registers on context switch
+    uint64_t xcr0 = _xgetbv(0);
+    bool os_ymm = (xcr0 & 0x06) == 0x06;
+    bool os_zmm = (xcr0 & 0xE6) == 0xE6;
+
+    __cpuidex(info, 7, 0);
+    features.avx2 = os_ymm && (info[1] & (1 << 5));
+    features.avx512bw = os_zmm && (info[1] & (1 << 16)) && (info[1] & (1 << 30));
+#endif
+    return features;
+}
+
+const Kernels& SelectKernels() {
+    CPUFeatures features = DetectCPUFeatures();
+
+    if (features.avx512bw) {
+        return kAVX512BWKernels;
+    } else if (features.avx2) {
+        return kAVX2Kernels;
+    }
+
+    return kBaselineKernels;
+}
+
+}  // namespace aribcaption::alphablend::internal::x86
+
+#endif  // defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
@@ -22,6 +22,7 @@
 #include <xmmintrin.h>  // SSE
 #include <emmintrin.h>  // SSE2
 #include <algorithm>
+#include <cstring>
 #include "renderer/alphablend_generic.hpp"
 
 // Workaround Windows.h (minwindef.h) max/min macro definitions
@@ -267,6 +268,76 @@ ALWAYS_INLINE void BlendLine_SSE2(ColorRGBA* __restrict dest, const ColorRGBA* _
     }
 }
 
+ALWAYS_INLINE void BlendColorWithAlphasToLine_SSE2(ColorRGBA* __restrict dest, const uint8_t* __restrict src_alphas,
+                                                   ColorRGBA color, size_t width) {
+    //            RGBA_0xAABBGGRR
+    const __m128i mask_0xffffffff = _mm_cmpeq_epi8(_mm_setzero_si128(), _mm_setzero_si128());
+    const __m128i mask_0xff000000 = _mm_slli_epi32(mask_0xffffffff, 24);
+    const __m128i mask_0x00ff0000 = _mm_srli_epi32(mask_0xff000000, 8);
+    const __m128i mask_0x00ffffff = _mm_srli_epi32(mask_0xffffffff, 8);
+    const __m128i mask_0x00ff00ff = _mm_srli_epi16(mask_0xffffffff, 8);
+    const __m128i mask_0xff00ff00 = _mm_slli_epi16(mask_0xffffffff, 8);
+
+    uint32_t trailing_remain_pixels = 0;
+    if ((trailing_remain_pixels = width % 4) != 0) {
+        width -= trailing_remain_pixels;
+    }
+
+    __m128i color4 = _mm_set1_epi32(static_cast<int>(color.u32));
+    __m128i color4_rgb = _mm_and_si128(color4, mask_0x00ffffff);
+    __m128i color4_alpha = _mm_srli_epi32(_mm_and_si128(color4, mask_0xff000000), 8);
+
+    for (size_t i = 0; i < width; i += 4, src_alphas += 4, dest += 4) {
+        // Expand 4 coverage values into 4 colored pixels, same as FillLineWithAlphas_SSE2()
+        int alphas;
+        memcpy(&alphas, src_alphas, sizeof(alphas));
+        __m128i alpha4 = _mm_cvtsi32_si128(alphas);
+        alpha4 = _mm_unpacklo_epi8(alpha4, _mm_setzero_si128());
+        alpha4 = _mm_unpacklo_epi8(alpha4, _mm_setzero_si128());
+        alpha4 = _mm_slli_epi32(alpha4, 16);
+
+        __m128i weighted_alpha = _mm_and_si128(mask_0xff000000, _mm_mullo_epi16(color4_alpha, alpha4));
+        __m128i src = _mm_or_si128(color4_rgb, weighted_alpha);
+
+        // Blend, same as BlendLine_SSE2()
+        __m128i src_a_g = _mm_srli_epi16(src, 8);                      // 0x00AA00GG
+        __m128i src_b_r = _mm_and_si128(src, mask_0x00ff00ff);         // 0x00BB00RR
+        __m128i src_alpha = _mm_shufflelo_epi16(src_a_g, 0b11110101);  // (lo)0x00AA00AA
+
+        src_a_g = _mm_or_si128(src_a_g, mask_0x00ff0000);              // 0x00FF00GG
+        src_alpha = _mm_shufflehi_epi16(src_alpha, 0b11110101);        // (hi)0x00AA00AA
+
+        src_b_r = _mm_mullo_epi16(src_b_r, src_alpha);
+        src_a_g = _mm_mullo_epi16(src_a_g, src_alpha);
+
+        src_b_r = _mm_srli_epi16(src_b_r, 8);                          // 0x00BB00RR
+        src_a_g = _mm_and_si128(src_a_g, mask_0xff00ff00);             // 0xAA00GG00
+
+        __m128i src_ff_minus_alpha = _mm_xor_si128(src_alpha, mask_0x00ff00ff);
+        __m128i multiplied_src = _mm_or_si128(src_b_r, src_a_g);       // (src)0xAABBGGRR
+
+        __m128i dst = _mm_loadu_si128(reinterpret_cast<__m128i*>(dest));
+
+        __m128i dst_b_r = _mm_and_si128(dst, mask_0x00ff00ff);
+        __m128i dst_a_g = _mm_srli_epi16(dst, 8);
+
+        dst_b_r = _mm_mullo_epi16(dst_b_r, src_ff_minus_alpha);
+        dst_a_g = _mm_mullo_epi16(dst_a_g, src_ff_minus_alpha);
+
+        dst_b_r = _mm_srli_epi16(dst_b_r, 8);
+        dst_a_g = _mm_and_si128(dst_a_g, mask_0xff00ff00);
+
+        __m128i result = _mm_adds_epu8(multiplied_src, _mm_or_si128(dst_b_r, dst_a_g));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), result);
+    }
+
+    if (trailing_remain_pixels) {
+        ColorRGBA colored[4];
+        FillLineWithAlphas_Generic(colored, src_alphas, color, trailing_remain_pixels);
+        BlendLine_SSE2(dest, colored, trailing_remain_pixels);
+    }
+}
+
 ALWAYS_INLINE void BlendLine_PremultipliedSrc_SSE2(ColorRGBA* __restrict dest,
                                                    const ColorRGBA* __restrict source, size_t width) {
     //            RGBA_0xAABBGGRR
@@ -324,51 +395,266 @@ ALWAYS_INLINE void BlendLine_PremultipliedSrc_SSE2(ColorRGBA* __restrict dest,
     }
 }
 
+// Coefficients of a YCbCr component for _mm_madd_epi16 on 0x00BB00RR and 0x00AA00GG pixels.
+// Coefficients don't fit into int16, they are split into c = hi * 256 + lo, with lo within [0, 255].
+struct YUVComponent_SSE2 {
+    __m128i hi_b_r;
+    __m128i hi_a_g;
+    __m128i lo_b_r;
+    __m128i lo_a_g;
+    __m128i offset;
+};
+
+ALWAYS_INLINE YUVComponent_SSE2 SplitYUVComponent_SSE2(int32_t c_r, int32_t c_g, int32_t c_b, int32_t offset) {
+    auto pair = [](int32_t low, int32_t high) {
+        return _mm_set1_epi32(static_cast<int>((static_cast<uint32_t>(high) << 16) |
+                                               (static_cast<uint32_t>(low) & 0xFFFF)));
+    };
+
+    YUVComponent_SSE2 component;
+    component.hi_b_r = pair(c_r >> 8, c_b >> 8);
+    component.hi_a_g = pair(c_g >> 8, 0);
+    component.lo_b_r = pair(c_r & 0xFF, c_b & 0xFF);
+    component.lo_a_g = pair(c_g & 0xFF, 0);
+    component.offset = _mm_set1_epi32(offset);
+    return component;
+}
+
+// (c_r * r + c_g * g + c_b * b + offset) >> 16 of 4 pixels, identical to the scalar conversion
+ALWAYS_INLINE __m128i ConvertComponent_SSE2(__m128i src_b_r, __m128i src_a_g, const YUVComponent_SSE2& c) {
+    __m128i hi = _mm_add_epi32(_mm_madd_epi16(src_b_r, c.hi_b_r), _mm_madd_epi16(src_a_g, c.hi_a_g));
+    __m128i lo = _mm_add_epi32(_mm_madd_epi16(src_b_r, c.lo_b_r), _mm_madd_epi16(src_a_g, c.lo_a_g));
+    return _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(hi, 8), lo), c.offset), 16);
+}
+
+// Blend luma of 4 pixels onto 4 luma values in 32-bit lanes
+ALWAYS_INLINE __m128i BlendLuma4_SSE2(__m128i src, __m128i dst, const YUVComponent_SSE2& y) {
+    const __m128i mask_0x00ff00ff = _mm_set1_epi32(0x00FF00FF);
+    const __m128i mask_0x000000ff = _mm_set1_epi32(0x000000FF);
+
+    __m128i luma = ConvertComponent_SSE2(_mm_and_si128(src, mask_0x00ff00ff), _mm_srli_epi16(src, 8), y);
+    __m128i alpha = _mm_srli_epi32(src, 24);
+    __m128i ff_minus_alpha = _mm_xor_si128(alpha, mask_0x000000ff);
+
+    // dst * (255 - alpha) + luma * alpha, by a single madd on (dst, luma) and (255 - alpha, alpha) pairs
+    __m128i blended = _mm_madd_epi16(_mm_or_si128(dst, _mm_slli_epi32(luma, 16)),
+                                     _mm_or_si128(ff_minus_alpha, _mm_slli_epi32(alpha, 16)));
+
+    // Div255()
+    blended = _mm_add_epi32(_mm_add_epi32(blended, _mm_set1_epi32(1)), _mm_srli_epi32(blended, 8));
+    return _mm_srli_epi32(blended, 8);
+}
+
+ALWAYS_INLINE void BlendLumaLine_SSE2(uint8_t* __restrict dest, const ColorRGBA* __restrict source,
+                                      size_t width, const YUVCoefficients& k) {
+    const __m128i zero = _mm_setzero_si128();
+    YUVComponent_SSE2 y = SplitYUVComponent_SSE2(k.y_r, k.y_g, k.y_b, k.y_offset);
+
+    size_t i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m128i src0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        __m128i src1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 4));
+        __m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(dest + i)), zero);
+
+        __m128i result0 = BlendLuma4_SSE2(src0, _mm_unpacklo_epi16(dst, zero), y);
+        __m128i result1 = BlendLuma4_SSE2(src1, _mm_unpackhi_epi16(dst, zero), y);
+
+        __m128i result = _mm_packs_epi32(result0, result1);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(result, result));
+    }
+
+    if (i < width) {
+        BlendLumaLine_Generic(dest + i, source + i, width - i, k);
+    }
+}
+
+// Alpha, chroma * alpha of pixels, summed up later for blocks
+struct ChromaWeights_SSE2 {
+    __m128i alpha;
+    __m128i u;
+    __m128i v;
+};
+
+ALWAYS_INLINE ChromaWeights_SSE2 WeightChroma4_SSE2(__m128i src,
+                                                    const YUVComponent_SSE2& u, const YUVComponent_SSE2& v) {
+    const __m128i mask_0x00ff00ff = _mm_set1_epi32(0x00FF00FF);
+
+    __m128i src_b_r = _mm_and_si128(src, mask_0x00ff00ff);
+    __m128i src_a_g = _mm_srli_epi16(src, 8);
+    __m128i alpha = _mm_srli_epi32(src, 24);
+
+    // Chroma values are within [0, 256], the high 16 bits of both operands are 0
+    ChromaWeights_SSE2 weights;
+    weights.alpha = alpha;
+    weights.u = _mm_madd_epi16(ConvertComponent_SSE2(src_b_r, src_a_g, u), alpha);
+    weights.v = _mm_madd_epi16(ConvertComponent_SSE2(src_b_r, src_a_g, v), alpha);
+    return weights;
+}
+
+// Sum each 2 horizontally adjacent pixels of x0 and x1 (4 pixels each), into 4 lanes of blocks
+ALWAYS_INLINE __m128i SumPixelPairs_SSE2(__m128i x0, __m128i x1) {
+    __m128 f0 = _mm_castsi128_ps(x0);
+    __m128 f1 = _mm_castsi128_ps(x1);
+    __m128i even = _mm_castps_si128(_mm_shuffle_ps(f0, f1, _MM_SHUFFLE(2, 0, 2, 0)));
+    __m128i odd = _mm_castps_si128(_mm_shuffle_ps(f0, f1, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm_add_epi32(even, odd);
+}
+
+// x / 1020 for x within [0, 2^20), as (x * ceil(2^30 / 1020)) >> 30
+ALWAYS_INLINE __m128i Div1020_SSE2(__m128i x) {
+    const __m128i magic = _mm_set1_epi32(1052689);
+
+    __m128i even = _mm_srli_epi64(_mm_mul_epu32(x, magic), 30);
+    __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), magic), 30);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+// BlendChromaBlock() of 4 blocks in 32-bit lanes, except that results are left unclamped
+ALWAYS_INLINE __m128i BlendChromaBlocks_SSE2(__m128i dst, __m128i sum_alpha, __m128i sum_chroma) {
+    const __m128i full_alpha = _mm_set1_epi32(255 * 4);
+
+    __m128i blended = _mm_add_epi32(_mm_madd_epi16(dst, _mm_sub_epi32(full_alpha, sum_alpha)), sum_chroma);
+    return Div1020_SSE2(_mm_add_epi32(blended, _mm_set1_epi32(255 * 2)));
+}
+
+ALWAYS_INLINE void BlendChromaLine_SSE2(uint8_t* __restrict u_dest, uint8_t* __restrict v_dest, size_t step,
+                                        const ColorRGBA* __restrict src_top,
+                                        const ColorRGBA* __restrict src_bottom,
+                                        size_t width, const YUVCoefficients& k) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask_0x0000ffff = _mm_set1_epi32(0x0000FFFF);
+
+    // Either interleaved UV (NV12) or separate U, V planes
+    bool interleaved = step == 2 && v_dest == u_dest + 1;
+    if (!interleaved && step != 1) {
+        BlendChromaLine_Generic(u_dest, v_dest, step, src_top, src_bottom, width, k);
+        return;
+    }
+
+    YUVComponent_SSE2 u = SplitYUVComponent_SSE2(k.u_r, k.u_g, k.u_b, k.uv_offset);
+    YUVComponent_SSE2 v = SplitYUVComponent_SSE2(k.v_r, k.v_g, k.v_b, k.uv_offset);
+
+    size_t i = 0;
+    for (; i + 4 <= width; i += 4) {
+        // 4 blocks, 8 pixels of each source line
+        ChromaWeights_SSE2 halves[2];
+        for (size_t half = 0; half < 2; half++) {
+            size_t offset = i * 2 + half * 4;
+            ChromaWeights_SSE2 top = WeightChroma4_SSE2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_top + offset)), u, v);
+            ChromaWeights_SSE2 bottom = WeightChroma4_SSE2(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_bottom + offset)), u, v);
+            halves[half].alpha = _mm_add_epi32(top.alpha, bottom.alpha);
+            halves[half].u = _mm_add_epi32(top.u, bottom.u);
+            halves[half].v = _mm_add_epi32(top.v, bottom.v);
+        }
+
+        __m128i sum_alpha = SumPixelPairs_SSE2(halves[0].alpha, halves[1].alpha);
+        __m128i sum_u = SumPixelPairs_SSE2(halves[0].u, halves[1].u);
+        __m128i sum_v = SumPixelPairs_SSE2(halves[0].v, halves[1].v);
+
+        if (interleaved) {
+            // 0x0000UUUU | 0xVVVV0000 in each lane
+            uint8_t* uv_dest = u_dest + i * 2;
+            __m128i dst = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv_dest)), zero);
+
+            __m128i result_u = BlendChromaBlocks_SSE2(_mm_and_si128(dst, mask_0x0000ffff), sum_alpha, sum_u);
+            __m128i result_v = BlendChromaBlocks_SSE2(_mm_srli_epi32(dst, 16), sum_alpha, sum_v);
+
+            __m128i result = _mm_or_si128(result_u, _mm_slli_epi32(result_v, 16));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(uv_dest), _mm_packus_epi16(result, result));
+        } else {
+            int32_t dst_u4;
+            int32_t dst_v4;
+            memcpy(&dst_u4, u_dest + i, sizeof(dst_u4));
+            memcpy(&dst_v4, v_dest + i, sizeof(dst_v4));
+            __m128i dst_u = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(dst_u4), zero), zero);
+            __m128i dst_v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(dst_v4), zero), zero);
+
+            __m128i result_u = BlendChromaBlocks_SSE2(dst_u, sum_alpha, sum_u);
+            __m128i result_v = BlendChromaBlocks_SSE2(dst_v, sum_alpha, sum_v);
+
+            // U in bytes [0, 4), V in bytes [4, 8)
+            __m128i result = _mm_packus_epi16(_mm_packs_epi32(result_u, result_v), zero);
+            dst_u4 = _mm_cvtsi128_si32(result);
+            dst_v4 = _mm_cvtsi128_si32(_mm_srli_si128(result, 4));
+            memcpy(u_dest + i, &dst_u4, sizeof(dst_u4));
+            memcpy(v_dest + i, &dst_v4, sizeof(dst_v4));
+        }
+    }
+
+    if (i < width) {
+        BlendChromaLine_Generic(u_dest + i * step, v_dest + i * step, step,
+                                src_top + i * 2, src_bottom + i * 2, width - i, k);
+    }
+}
+
 #endif  // defined(__SSE2__) || defined(_MSC_VER)
 
+// Kernels with wider vectors (AVX2, AVX-512BW) are compiled in alphablend_x86.cpp with per-function target
+// attributes, and chosen once at runtime according to the CPU features. SSE2 (or generic) kernels are the fallback.
+struct Kernels {
+    const char* name;
+    void (*fill_line)(ColorRGBA* dest, ColorRGBA color, size_t width);
+    void (*fill_line_with_alphas)(ColorRGBA* dest, const uint8_t* src_alphas, ColorRGBA color, size_t width);
+    void (*blend_color_to_line)(ColorRGBA* dest, ColorRGBA color, size_t width);
+    void (*blend_color_with_alphas_to_line)(ColorRGBA* dest, const uint8_t* src_alphas,
+                                            ColorRGBA color, size_t width);
+    void (*blend_line)(ColorRGBA* dest, const ColorRGBA* src, size_t width);
+    void (*blend_line_premultiplied_src)(ColorRGBA* dest, const ColorRGBA* src, size_t width);
+    void (*blend_luma_line)(uint8_t* dest, const ColorRGBA* src, size_t width, const YUVCoefficients& k);
+    void (*blend_chroma_line)(uint8_t* u_dest, uint8_t* v_dest, size_t step,
+                              const ColorRGBA* src_top, const ColorRGBA* src_bottom,
+                              size_t width, const YUVCoefficients& k);
+};
+
+// Detect CPU features and pick the widest supported kernels, defined in alphablend_x86.cpp
+const Kernels& SelectKernels();
+
+ALWAYS_INLINE const Kernels& GetKernels() {
+    static const Kernels& kernels = SelectKernels();
+    return kernels;
+}
+
 }  // namespace x86
 
 
 ALWAYS_INLINE void FillLine_x86(ColorRGBA* __restrict dest, ColorRGBA color, size_t width) {
-#if defined(__SSE2__) || defined(_MSC_VER)
-    x86::FillLine_SSE2(dest, color, width);
-#else
-    FillLine_Generic(dest, color, width);
-#endif
+    x86::GetKernels().fill_line(dest, color, width);
 }
 
 ALWAYS_INLINE void FillLineWithAlphas_x86(ColorRGBA* __restrict dest,
                                           const uint8_t* __restrict src_alphas, ColorRGBA color, size_t width) {
-#if defined(__SSE2__) || defined(_MSC_VER)
-    x86::FillLineWithAlphas_SSE2(dest, src_alphas, color, width);
-#else
-    FillLineWithAlphas_Generic(dest, src_alphas, color, width);
-#endif
+    x86::GetKernels().fill_line_with_alphas(dest, src_alphas, color, width);
 }
 
 ALWAYS_INLINE void BlendColorToLine_x86(ColorRGBA* __restrict dest, ColorRGBA color, size_t width) {
-#if defined(__SSE2__) || defined(_MSC_VER)
-    x86::BlendColorToLine_SSE2(dest, color, width);
-#else
-    BlendColorToLine_Generic(dest, color, width);
-#endif
+    x86::GetKernels().blend_color_to_line(dest, color, width);
+}
+
+ALWAYS_INLINE void BlendColorWithAlphasToLine_x86(ColorRGBA* __restrict dest,
+                                                  const uint8_t* __restrict src_alphas, ColorRGBA color, size_t width) {
+    x86::GetKernels().blend_color_with_alphas_to_line(dest, src_alphas, color, width);
 }
 
 ALWAYS_INLINE void BlendLine_x86(ColorRGBA* __restrict dest, const ColorRGBA* __restrict src, size_t width) {
-#if defined(__SSE2__) || defined(_MSC_VER)
-    x86::BlendLine_SSE2(dest, src, width);
-#else
-    BlendLine_Generic(dest, src, width);
-#endif
+    x86::GetKernels().blend_line(dest, src, width);
 }
 
 ALWAYS_INLINE void BlendLine_PremultipliedSrc_x86(ColorRGBA* __restrict dest,
                                                   const ColorRGBA* __restrict src, size_t width) {
-#if defined(__SSE2__) || defined(_MSC_VER)
-    x86::BlendLine_PremultipliedSrc_SSE2(dest, src, width);
-#else
-    BlendLine_PremultipliedSrc_Generic(dest, src, width);
-#endif
+    x86::GetKernels().blend_line_premultiplied_src(dest, src, width);
+}
+
+ALWAYS_INLINE void BlendLumaLine_x86(uint8_t* __restrict dest, const ColorRGBA* __restrict src,
+                                     size_t width, const YUVCoefficients& k) {
+    x86::GetKernels().blend_luma_line(dest, src, width, k);
+}
+
+ALWAYS_INLINE void BlendChromaLine_x86(uint8_t* __restrict u_dest, uint8_t* __restrict v_dest, size_t step,
+                                       const ColorRGBA* __restrict src_top, const ColorRGBA* __restrict src_bottom,
+                                       size_t width, const YUVCoefficients& k) {
+    x86::GetKernels().blend_chroma_line(u_dest, v_dest, step, src_top, src_bottom, width, k);
 }
 
 }  // namespace aribcaption::alphablend::internal
@@ -17,18 +17,20 @@
  */
 
 #include <cassert>
+#include <cstring>
 #include "renderer/bitmap.hpp"
 
 namespace aribcaption {
 
 Image Bitmap::ToImage(Bitmap&& bmp) {
+    assert(!bmp.parent_data_ && "Bitmap created by SubBitmap() or FromPixels() can't be converted into Image");
     Image image;
 
     image.width = bmp.width();
     image.height = bmp.height();
     image.stride = bmp.stride();
     image.pixel_format = bmp.pixel_format();
-    image.bitmap = std::move(bmp.pixels);
+    image.bitmap = bmp.pool_ ? bmp.pool_->Share(std::move(bmp.pixels)) : ImageBuffer(std::move(bmp.pixels));
 
     bmp.width_ = 0;
     bmp.height_ = 0;
@@ -45,13 +47,67 @@ Bitmap Bitmap::FromImage(Image&& image) {
     bitmap.stride_ = image.stride;
     bitmap.pixel_format_ = image.pixel_format;
 
-    bitmap.pixels = std::move(image.bitmap);
+    bitmap.pixels = image.bitmap.Detach();
 
     return bitmap;
 }
 
-Bitmap::Bitmap(int width, int height, PixelFormat pixel_format) :
-      width_(width), height_(height), pixel_format_(pixel_format) {
+Bitmap Bitmap::SubBitmap(Bitmap& parent, const Rect& rect) {
+    assert(rect.left >= 0 && rect.top >= 0 && rect.right <= parent.width() && rect.bottom <= parent.height());
+    assert(rect.width() > 0 && rect.height() > 0);
+
+    Bitmap bitmap;
+
+    bitmap.width_ = rect.width();
+    bitmap.height_ = rect.height();
+    bitmap.stride_ = parent.stride();
+    bitmap.pixel_format_ = parent.pixel_format();
+    bitmap.parent_data_ = reinterpret_cast<uint8_t*>(parent.GetPixelAt(rect.left, rect.top));
+
+    return bitmap;
+}
+
+Bitmap Bitmap::FromPixels(uint8_t* pixels, int width, int height, int stride) {
+    assert(pixels && width > 0 && height > 0 && stride >= width * 4);
+
+    Bitmap bitmap;
+
+    bitmap.width_ = width;
+    bitmap.height_ = height;
+    bitmap.stride_ = stride;
+    bitmap.pixel_format_ = PixelFormat::kRGBA8888;
+    bitmap.parent_data_ = pixels;
+
+    return bitmap;
+}
+
+Bitmap Bitmap::Crop(const Bitmap& bitmap, const Rect& rect) {
+    assert(rect.left >= 0 && rect.top >= 0 && rect.right <= bitmap.width() && rect.bottom <= bitmap.height());
+
+    Bitmap cropped(rect.width(), rect.height(), bitmap.pixel_format(), bitmap.pool_, false);
+
+    auto line_size = static_cast<size_t>(rect.width()) * sizeof(ColorRGBA);
+    auto padding_size = static_cast<size_t>(cropped.stride()) - line_size;
+    for (int y = 0; y < rect.height(); y++) {
+        auto dest = reinterpret_cast<uint8_t*>(cropped.GetPixelAt(0, y));
+        memcpy(dest, bitmap.GetPixelAt(rect.left, rect.top + y), line_size);
+        memset(dest + line_size, 0, padding_size);
+    }
+
+    if (bitmap.drawn_rect_) {
+        const Rect& drawn = bitmap.drawn_rect_.value();
+        cropped.MarkDrawn(Rect(drawn.left - rect.left, drawn.top - rect.top,
+                               drawn.right - rect.left, drawn.bottom - rect.top));
+    }
+
+    return cropped;
+}
+
+Bitmap::Bitmap(int width, int height, PixelFormat pixel_format)
+    : Bitmap(width, height, pixel_format, nullptr) {}
+
+Bitmap::Bitmap(int width, int height, PixelFormat pixel_format, std::shared_ptr<BitmapPool> pool, bool zero_fill)
+    : width_(width), height_(height), pixel_format_(pixel_format), pool_(std::move(pool)) {
     assert(width > 0 && height > 0);
     assert(pixel_format == PixelFormat::kRGBA8888);
 
@@ -63,7 +119,35 @@ Bitmap::Bitmap(int width, int height, PixelFormat pixel_format) :
         stride_ += static_cast<int>(padding);
     }
 
-    pixels.resize(stride_ * height);
+    size_t size = static_cast<size_t>(stride_) * static_cast<size_t>(height);
+    if (pool_) {
+        pixels = pool_->Acquire(size, zero_fill);
+    } else {
+        pixels.resize(size);
+        if (zero_fill) {
+            memset(pixels.data(), 0, size);
+        }
+    }
+}
+
+Bitmap::~Bitmap() {
+    if (pool_) {
+        pool_->Release(std::move(pixels));
+    }
+}
+
+void Bitmap::MarkDrawn(const Rect& rect) {
+    Rect clipped = Rect::ClipRect(GetRect(), rect);
+    if (clipped.width() <= 0 || clipped.height() <= 0) {
+        return;
+    }
+
+    if (!drawn_rect_) {
+        drawn_rect_ = clipped;
+    } else {
+        drawn_rect_->Include(clipped.left, clipped.top);  // top left corner
+        drawn_rect_->Include(clipped.right - 1, clipped.bottom - 1);  // bottom right corner
+    }
 }
 
 }  // namespace aribcaption
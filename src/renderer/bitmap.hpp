@@ -20,12 +20,15 @@
 #define ARIBCAPTION_BITMAP_HPP
 
 #include <cstdint>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <type_traits>
 #include "aribcaption/aligned_alloc.hpp"
 #include "aribcaption/color.hpp"
 #include "aribcaption/image.hpp"
 #include "base/always_inline.hpp"
+#include "renderer/bitmap_pool.hpp"
 #include "renderer/rect.hpp"
 
 namespace aribcaption {
@@ -36,41 +39,56 @@ public:
 public:
     static Image ToImage(Bitmap&& bitmap);
     static Bitmap FromImage(Image&& image);
+
+    // Create a Bitmap referring to the pixels of rect within parent, for drawing into a part of parent directly.
+    // Drawing is clipped to rect. The parent must outlive the returned Bitmap, which can't be converted by ToImage().
+    static Bitmap SubBitmap(Bitmap& parent, const Rect& rect);
+
+    // Create a kRGBA8888 Bitmap referring to external pixels, e.g. a plane of a video frame, for drawing into them
+    // directly. The pixels must outlive the returned Bitmap, which can't be converted by ToImage().
+    static Bitmap FromPixels(uint8_t* pixels, int width, int height, int stride);
+
+    // Copy rect of the bitmap into a new Bitmap, allocated from the same pool
+    static Bitmap Crop(const Bitmap& bitmap, const Rect& rect);
 private:
     Bitmap() = default;
 public:
     Bitmap(int width, int height, PixelFormat pixel_format);
-    ~Bitmap() = default;
+
+    // Pixels are acquired from the pool, and returned into the pool on destruction.
+    // If zero_fill is false, pixels are left unspecified for being fully overwritten by the caller.
+    Bitmap(int width, int height, PixelFormat pixel_format, std::shared_ptr<BitmapPool> pool, bool zero_fill = true);
+    ~Bitmap();
     Bitmap(const Bitmap& bmp) = default;
     Bitmap(Bitmap&& bmp) noexcept = default;
     Bitmap& operator=(const Bitmap&) = default;
     Bitmap& operator=(Bitmap&&) noexcept = default;
 public:
     [[nodiscard]]
-    ALWAYS_INLINE uint8_t* data() { return pixels.data(); }
+    ALWAYS_INLINE uint8_t* data() { return parent_data_ ? parent_data_ : pixels.data(); }
 
     [[nodiscard]]
-    ALWAYS_INLINE const uint8_t* data() const { return pixels.data(); }
+    ALWAYS_INLINE const uint8_t* data() const { return parent_data_ ? parent_data_ : pixels.data(); }
 
     [[nodiscard]]
     ALWAYS_INLINE ColorRGBA* GetPixels() {
-        return reinterpret_cast<ColorRGBA*>(pixels.data());
+        return reinterpret_cast<ColorRGBA*>(data());
     };
 
     [[nodiscard]]
     ALWAYS_INLINE const ColorRGBA* GetPixels() const {
-        return reinterpret_cast<const ColorRGBA*>(pixels.data());
+        return reinterpret_cast<const ColorRGBA*>(data());
     };
 
     [[nodiscard]]
     ALWAYS_INLINE ColorRGBA* GetPixelAt(int x, int y) {
-        uint8_t* ptr = pixels.data() + y * (size_t)stride_ + x * sizeof(ColorRGBA);
+        uint8_t* ptr = data() + y * (size_t)stride_ + x * sizeof(ColorRGBA);
         return reinterpret_cast<ColorRGBA*>(ptr);
     };
 
     [[nodiscard]]
     ALWAYS_INLINE const ColorRGBA* GetPixelAt(int x, int y) const {
-        const uint8_t* ptr = pixels.data() + y * (size_t)stride_ + x * sizeof(ColorRGBA);
+        const uint8_t* ptr = data() + y * (size_t)stride_ + x * sizeof(ColorRGBA);
         return reinterpret_cast<const ColorRGBA*>(ptr);
     };
 
@@ -80,7 +98,16 @@ public:
     }
 
     [[nodiscard]]
-    ALWAYS_INLINE size_t size() const { return pixels.size(); }
+    ALWAYS_INLINE size_t size() const {
+        return parent_data_ ? static_cast<size_t>(stride_) * static_cast<size_t>(height_) : pixels.size();
+    }
+
+    // Bounds of the pixels drawn so far, maintained by Canvas and TextRenderers while drawing,
+    // for cropping transparent padding off without scanning pixels. std::nullopt if nothing has been drawn.
+    [[nodiscard]]
+    const std::optional<Rect>& drawn_rect() const { return drawn_rect_; }
+
+    void MarkDrawn(const Rect& rect);
 
     [[nodiscard]]
     ALWAYS_INLINE int width() const { return width_; }
@@ -99,7 +126,10 @@ private:
     int stride_ = 0;
     PixelFormat pixel_format_ = PixelFormat::kDefault;
 
-    std::vector<uint8_t, AlignedAllocator<uint8_t, kAlignedTo>> pixels;
+    std::shared_ptr<BitmapPool> pool_;
+    uint8_t* parent_data_ = nullptr;  // Points into external pixels if created by SubBitmap() or FromPixels()
+    std::optional<Rect> drawn_rect_;
+    ImageBuffer::Storage pixels;
 };
 
 }  // namespace aribcaption
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cstring>
+#include "renderer/bitmap_pool.hpp"
+
+namespace aribcaption {
+
+// Buffers smaller than this are allocated with the smallest size class
+static constexpr size_t kMinSizeClass = 4096;
+
+BitmapPool::BitmapPool(size_t capacity) : capacity_(capacity) {}
+
+auto BitmapPool::Acquire(size_t size, bool zero_fill) -> Storage {
+    size_t size_class = SizeClassOf(size);
+    Storage storage;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iter = free_lists_.find(size_class);
+        if (iter != free_lists_.end() && !iter->second.empty()) {
+            storage = std::move(iter->second.back());
+            iter->second.pop_back();
+            cached_size_ -= size_class;
+        }
+    }
+
+    if (storage.capacity() == 0) {
+        storage.reserve(size_class);
+    }
+
+    // resize() leaves new bytes uninitialized, see ImageBuffer::Storage
+    storage.resize(size);
+    if (zero_fill) {
+        memset(storage.data(), 0, size);
+    }
+
+    return storage;
+}
+
+void BitmapPool::Release(Storage&& storage) {
+    size_t size_class = storage.capacity();
+    if (size_class == 0 || SizeClassOf(size_class) != size_class) {
+        return;
+    }
+
+    Storage released = std::move(storage);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cached_size_ + size_class > capacity_) {
+        return;  // Freed on leaving the scope
+    }
+    free_lists_[size_class].push_back(std::move(released));
+    cached_size_ += size_class;
+}
+
+ImageBuffer BitmapPool::Share(Storage&& storage) {
+    std::weak_ptr<BitmapPool> weak_pool = weak_from_this();
+    std::shared_ptr<Storage> shared(new Storage(std::move(storage)), [weak_pool](Storage* released) {
+        if (std::shared_ptr<BitmapPool> pool = weak_pool.lock()) {
+            pool->Release(std::move(*released));
+        }
+        delete released;
+    });
+    return ImageBuffer(std::move(shared));
+}
+
+void BitmapPool::SetCapacity(size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = capacity;
+    if (cached_size_ > capacity_) {
+        free_lists_.clear();
+        cached_size_ = 0;
+    }
+}
+
+void BitmapPool::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_lists_.clear();
+    cached_size_ = 0;
+}
+
+size_t BitmapPool::cached_size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cached_size_;
+}
+
+// Size classes are 4, 5, 6 and 7 times of a power of 2, wasting at most 25% of a buffer
+size_t BitmapPool::SizeClassOf(size_t size) {
+    if (size <= kMinSizeClass) {
+        return kMinSizeClass;
+    }
+
+    size_t base = kMinSizeClass / 4;
+    while (base * 8 < size) {
+        base *= 2;
+    }
+
+    size_t multiple = (size + base - 1) / base;  // 4 < multiple <= 8
+    return base * multiple;
+}
+
+}  // namespace aribcaption
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_BITMAP_POOL_HPP
+#define ARIBCAPTION_BITMAP_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "aribcaption/image.hpp"
+
+namespace aribcaption {
+
+// Pool of aligned pixel buffers, reused across renders to avoid allocator churn and page faults.
+// Buffers are grouped by size classes, so that a released buffer could serve a slightly different size later.
+// Thread-safe, shared by all RegionRenderers of a Renderer.
+class BitmapPool : public std::enable_shared_from_this<BitmapPool> {
+public:
+    using Storage = ImageBuffer::Storage;
+
+    static constexpr size_t kDefaultCapacity = 32 * 1024 * 1024;  // in bytes
+public:
+    explicit BitmapPool(size_t capacity = kDefaultCapacity);
+    ~BitmapPool() = default;
+public:
+    // Acquire a buffer of exactly size bytes.
+    // If zero_fill is false, contents are unspecified, which should be used only if the buffer is about to be
+    // fully overwritten.
+    Storage Acquire(size_t size, bool zero_fill = true);
+
+    // Return a buffer into the pool, it's freed instead if the pool is full or the buffer isn't from the pool
+    void Release(Storage&& storage);
+
+    // Wrap the buffer into an ImageBuffer, which returns the buffer into the pool once the last reference is gone.
+    // The pool must be owned by a std::shared_ptr. ImageBuffers may outlive the pool.
+    ImageBuffer Share(Storage&& storage);
+
+    void SetCapacity(size_t capacity);
+    void Clear();
+
+    [[nodiscard]]
+    size_t cached_size() const;
+private:
+    static size_t SizeClassOf(size_t size);
+public:
+    BitmapPool(const BitmapPool&) = delete;
+    BitmapPool& operator=(const BitmapPool&) = delete;
+private:
+    mutable std::mutex mutex_;
+    size_t capacity_ = 0;
+    size_t cached_size_ = 0;
+
+    // size class => released buffers of that class
+    std::unordered_map<size_t, std::vector<Storage>> free_lists_;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_BITMAP_POOL_HPP
@@ -17,6 +17,7 @@
  */
 
 #include <cassert>
+#include <cstddef>
 #include "renderer/alphablend.hpp"
 #include "renderer/bitmap.hpp"
 #include "renderer/canvas.hpp"
@@ -32,6 +33,10 @@ void Canvas::ClearColor(ColorRGBA color) {
         ColorRGBA* line_begin = bitmap_.GetPixelAt(0, y);
         alphablend::FillLine(line_begin, color, bitmap_.width());
     }
+
+    if (color.a) {
+        bitmap_.MarkDrawn(bitmap_.GetRect());
+    }
 }
 
 void Canvas::ClearRect(ColorRGBA color, const Rect& rect) {
@@ -47,6 +52,10 @@ void Canvas::ClearRect(ColorRGBA color, const Rect& rect) {
         ColorRGBA* line_begin = bitmap_.GetPixelAt(clipped.left, y);
         alphablend::FillLine(line_begin, color, line_width);
     }
+
+    if (color.a) {
+        bitmap_.MarkDrawn(clipped);
+    }
 }
 
 void Canvas::DrawRect(ColorRGBA fg_color, const Rect& rect) {
@@ -62,6 +71,10 @@ void Canvas::DrawRect(ColorRGBA fg_color, const Rect& rect) {
         ColorRGBA* line_begin = bitmap_.GetPixelAt(clipped.left, y);
         alphablend::BlendColorToLine(line_begin, fg_color, line_width);
     }
+
+    if (fg_color.a) {
+        bitmap_.MarkDrawn(clipped);
+    }
 }
 
 void Canvas::DrawBitmap(const Bitmap& bmp, const Rect& rect) {
@@ -82,6 +95,8 @@ void Canvas::DrawBitmap(const Bitmap& bmp, const Rect& rect) {
         const ColorRGBA* src_begin = bmp.GetPixelAt(clip_x_offset, clip_y_offset + y - clipped.top);
         alphablend::BlendLine(dest_begin, src_begin, line_width);
     }
+
+    bitmap_.MarkDrawn(clipped);
 }
 
 void Canvas::DrawBitmap(const Bitmap& bmp, int target_x, int target_y) {
@@ -90,4 +105,53 @@ void Canvas::DrawBitmap(const Bitmap& bmp, int target_x, int target_y) {
     DrawBitmap(bmp, rect);
 }
 
+void Canvas::DrawImage(const Image& image, int target_x, int target_y) {
+    assert(image.pixel_format == PixelFormat::kRGBA8888);
+
+    Rect rect{target_x, target_y, target_x + image.width, target_y + image.height};
+    Rect clipped = Rect::ClipRect(bitmap_.GetRect(), rect);
+
+    if (clipped.width() <= 0 || clipped.height() <= 0) {
+        return;
+    }
+
+    int clip_x_offset = clipped.left - rect.left;
+    int clip_y_offset = clipped.top - rect.top;
+    auto line_width = static_cast<size_t>(clipped.width());
+
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        ColorRGBA* dest_begin = bitmap_.GetPixelAt(clipped.left, y);
+        size_t src_offset = static_cast<size_t>(clip_y_offset + y - clipped.top) * image.stride;
+        auto src_begin = reinterpret_cast<const ColorRGBA*>(image.bitmap.data() + src_offset) + clip_x_offset;
+        alphablend::BlendLine(dest_begin, src_begin, line_width);
+    }
+
+    bitmap_.MarkDrawn(clipped);
+}
+
+void Canvas::DrawAlphaMask(const uint8_t* mask, int width, int height, int pitch,
+                           ColorRGBA color, int target_x, int target_y) {
+    Rect rect{target_x, target_y, target_x + width, target_y + height};
+    Rect clipped = Rect::ClipRect(bitmap_.GetRect(), rect);
+
+    if (clipped.width() <= 0 || clipped.height() <= 0) {
+        return;
+    }
+
+    int clip_x_offset = clipped.left - rect.left;
+    int clip_y_offset = clipped.top - rect.top;
+    auto line_width = static_cast<size_t>(clipped.width());
+
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        ColorRGBA* dest_begin = bitmap_.GetPixelAt(clipped.left, y);
+        const uint8_t* src_begin = mask + static_cast<ptrdiff_t>(clip_y_offset + y - clipped.top) * pitch
+                                        + clip_x_offset;
+        alphablend::BlendColorWithAlphasToLine(dest_begin, src_begin, color, line_width);
+    }
+
+    if (color.a) {
+        bitmap_.MarkDrawn(clipped);
+    }
+}
+
 }  // namespace aribcaption
@@ -19,9 +19,11 @@
 #ifndef ARIBCAPTION_CANVAS_HPP
 #define ARIBCAPTION_CANVAS_HPP
 
+#include <cstdint>
 #include <optional>
 #include "aribcaption/caption.hpp"
 #include "aribcaption/color.hpp"
+#include "aribcaption/image.hpp"
 #include "renderer/rect.hpp"
 
 namespace aribcaption {
@@ -38,6 +40,12 @@ public:
     void DrawRect(ColorRGBA color, const Rect& rect);
     void DrawBitmap(const Bitmap& bmp, const Rect& rect);
     void DrawBitmap(const Bitmap& bmp, int target_x, int target_y);
+    void DrawImage(const Image& image, int target_x, int target_y);  // Blend kRGBA8888 image without copying
+
+    // Blend a solid color weighted by an 8-bit coverage mask, e.g. a rasterized glyph
+    // pitch is the distance in bytes between two adjacent rows of the mask
+    void DrawAlphaMask(const uint8_t* mask, int width, int height, int pitch,
+                       ColorRGBA color, int target_x, int target_y);
 public:
     // Disallow copy and assign
     Canvas(const Canvas&) = delete;
@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include "renderer/caption_store.hpp"
+
+namespace aribcaption {
+
+CaptionStore::CaptionStore() = default;
+
+CaptionStore::~CaptionStore() = default;
+
+auto CaptionStore::LowerBound(int64_t pts) -> iterator {
+    return std::lower_bound(captions_.begin(), captions_.end(), pts, [](const Caption& caption, int64_t value) {
+        return caption.pts < value;
+    });
+}
+
+auto CaptionStore::UpperBound(int64_t pts) -> iterator {
+    return std::upper_bound(captions_.begin(), captions_.end(), pts, [](int64_t value, const Caption& caption) {
+        return value < caption.pts;
+    });
+}
+
+auto CaptionStore::Find(int64_t pts) -> iterator {
+    auto iter = LowerBound(pts);
+    if (iter != captions_.end() && iter->pts == pts) {
+        return iter;
+    }
+    return captions_.end();
+}
+
+auto CaptionStore::Insert(Caption&& caption) -> iterator {
+    memory_size_ += CalculateMemorySize(caption);
+
+    // Fast path for monotonic PTS
+    if (captions_.empty() || captions_.back().pts < caption.pts) {
+        captions_.push_back(std::move(caption));
+        return std::prev(captions_.end());
+    }
+
+    auto iter = LowerBound(caption.pts);
+    if (iter != captions_.end() && iter->pts == caption.pts) {
+        memory_size_ -= CalculateMemorySize(*iter);
+        *iter = std::move(caption);
+        return iter;
+    }
+
+    return captions_.insert(iter, std::move(caption));
+}
+
+void CaptionStore::EraseFront(iterator erase_end) {
+    for (auto iter = captions_.begin(); iter != erase_end; ++iter) {
+        memory_size_ -= CalculateMemorySize(*iter);
+    }
+    captions_.erase(captions_.begin(), erase_end);
+}
+
+void CaptionStore::Clear() {
+    captions_.clear();
+    memory_size_ = 0;
+}
+
+size_t CaptionStore::CalculateMemorySize(const Caption& caption) {
+    size_t size = sizeof(Caption) + caption.text.capacity();
+
+    size += caption.regions.capacity() * sizeof(CaptionRegion);
+    for (const CaptionRegion& region : caption.regions) {
+        size += region.chars.capacity() * sizeof(CaptionChar);
+    }
+
+    // Buckets and nodes of std::unordered_map are estimated roughly, DRCS patterns usually dominate
+    size += caption.drcs_map.bucket_count() * sizeof(void*);
+    for (const auto& [code, drcs] : caption.drcs_map) {
+        size += sizeof(std::pair<const uint32_t, DRCS>) + sizeof(void*) * 2;
+        size += drcs.pixels.capacity() + drcs.md5.capacity() + drcs.alternative_text.capacity();
+    }
+
+    return size;
+}
+
+}  // namespace aribcaption
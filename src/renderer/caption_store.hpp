@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_CAPTION_STORE_HPP
+#define ARIBCAPTION_CAPTION_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include "aribcaption/caption.hpp"
+
+namespace aribcaption {
+
+// Captions sorted by PTS, with the memory of stored captions accounted.
+// Backed by a std::deque instead of a tree: captions are appended in PTS order in most cases,
+// which makes Insert() a push_back, and evicting the oldest captions pops them from the front.
+// Iterators are random access, lookups are binary searches by PTS.
+class CaptionStore {
+public:
+    using iterator = std::deque<Caption>::iterator;
+public:
+    CaptionStore();
+    ~CaptionStore();
+public:
+    [[nodiscard]]
+    bool empty() const { return captions_.empty(); }
+
+    [[nodiscard]]
+    size_t size() const { return captions_.size(); }
+
+    // Estimated memory of stored captions in bytes, see CalculateMemorySize()
+    [[nodiscard]]
+    size_t memory_size() const { return memory_size_; }
+
+    iterator begin() { return captions_.begin(); }
+    iterator end() { return captions_.end(); }
+    Caption& back() { return captions_.back(); }
+
+    // First caption with PTS >= pts
+    iterator LowerBound(int64_t pts);
+
+    // First caption with PTS > pts
+    iterator UpperBound(int64_t pts);
+
+    iterator Find(int64_t pts);
+
+    // Insert the caption at the position of its PTS, replacing the caption with identical PTS if exists
+    iterator Insert(Caption&& caption);
+
+    // Erase captions in range [begin(), erase_end)
+    void EraseFront(iterator erase_end);
+
+    void Clear();
+
+    // Estimate the memory held by a caption, including chars, text and DRCS patterns
+    static size_t CalculateMemorySize(const Caption& caption);
+public:
+    CaptionStore(const CaptionStore&) = delete;
+    CaptionStore& operator=(const CaptionStore&) = delete;
+private:
+    std::deque<Caption> captions_;
+    size_t memory_size_ = 0;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_CAPTION_STORE_HPP
@@ -16,69 +16,149 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <algorithm>
 #include <cstdint>
+#include <vector>
 #include "renderer/alphablend.hpp"
-#include "renderer/bitmap.hpp"
 #include "renderer/canvas.hpp"
 #include "renderer/drcs_renderer.hpp"
+#include "renderer/mask_scaler.hpp"
 
 namespace aribcaption {
 
+void DRCSRenderer::SetScaleMode(DRCSScaleMode mode) {
+    if (scale_mode_ != mode) {
+        scale_mode_ = mode;
+        mask_cache_.Clear();
+    }
+}
+
+size_t DRCSRenderer::TrimCache(size_t bytes) {
+    size_t cached_size = mask_cache_.total_cost();
+    mask_cache_.Shrink(cached_size > bytes ? cached_size - bytes : 0);
+    return cached_size - mask_cache_.total_cost();
+}
+
 bool DRCSRenderer::DrawDRCS(const DRCS& drcs, CharStyle style, ColorRGBA color, ColorRGBA stroke_color,
                             int stroke_width, int target_width, int target_height,
                             Bitmap& target_bmp, int target_x, int target_y) {
-    if (drcs.width == 0 || drcs.height == 0 || drcs.pixels.empty()) {
+    if (drcs.width == 0 || drcs.height == 0 || drcs.pixels.empty() || target_width <= 0 || target_height <= 0) {
         return false;
     }
 
     Canvas canvas(target_bmp);
 
     // Draw stroke (border) if needed
-    if (style & CharStyle::kCharStyleStroke) {
-        Bitmap stroke_bitmap = DRCSToColoredBitmap(drcs, target_width, target_height, stroke_color);
-
-        canvas.DrawBitmap(stroke_bitmap, target_x - stroke_width, target_y);
-        canvas.DrawBitmap(stroke_bitmap, target_x + stroke_width, target_y);
-        canvas.DrawBitmap(stroke_bitmap, target_x, target_y - stroke_width);
-        canvas.DrawBitmap(stroke_bitmap, target_x, target_y + stroke_width);
+    if ((style & CharStyle::kCharStyleStroke) && stroke_width > 0) {
+        const std::vector<uint8_t>* mask = LookupOrCreateMask(drcs, target_width, target_height);
+        const std::vector<uint8_t>* stroke_mask =
+            LookupOrCreateStrokeMask(drcs, *mask, target_width, target_height, stroke_width);
+        int stroke_mask_width = target_width + stroke_width * 2;
+        canvas.DrawAlphaMask(stroke_mask->data(), stroke_mask_width, target_height + stroke_width * 2,
+                             stroke_mask_width, stroke_color, target_x - stroke_width, target_y - stroke_width);
     }
 
     // Draw DRCS with text color
-    Bitmap text_bitmap = DRCSToColoredBitmap(drcs, target_width, target_height, color);
-    canvas.DrawBitmap(text_bitmap, target_x, target_y);
+    // Lookup again, for the filling mask may have been evicted by inserting the stroke mask
+    const std::vector<uint8_t>* mask = LookupOrCreateMask(drcs, target_width, target_height);
+    canvas.DrawAlphaMask(mask->data(), target_width, target_height, target_width, color, target_x, target_y);
 
     return true;
 }
 
-Bitmap DRCSRenderer::DRCSToColoredBitmap(const DRCS& drcs, int target_width, int target_height, ColorRGBA color) {
-    Bitmap bitmap(target_width, target_height, PixelFormat::kRGBA8888);
+auto DRCSRenderer::LookupOrCreateMask(const DRCS& drcs, int target_width, int target_height)
+        -> const std::vector<uint8_t>* {
+    if (drcs.md5.empty()) {
+        uncached_mask_ = DRCSToAlphaMask(drcs, target_width, target_height, scale_mode_);
+        return &uncached_mask_;
+    }
+
+    MaskCacheKey key{drcs.md5, target_width, target_height, 0};
+    if (std::vector<uint8_t>* cached = mask_cache_.Get(key)) {
+        return cached;
+    }
+
+    std::vector<uint8_t> mask = DRCSToAlphaMask(drcs, target_width, target_height, scale_mode_);
+    size_t cost = mask.size();
+    return &mask_cache_.Put(key, std::move(mask), cost);
+}
+
+auto DRCSRenderer::LookupOrCreateStrokeMask(const DRCS& drcs, const std::vector<uint8_t>& mask, int target_width,
+                                            int target_height, int stroke_width) -> const std::vector<uint8_t>* {
+    if (drcs.md5.empty()) {
+        uncached_stroke_mask_ = DilateAlphaMask(mask, target_width, target_height, stroke_width);
+        return &uncached_stroke_mask_;
+    }
+
+    MaskCacheKey key{drcs.md5, target_width, target_height, stroke_width};
+    if (std::vector<uint8_t>* cached = mask_cache_.Get(key)) {
+        return cached;
+    }
 
-    float x_fraction = static_cast<float>(drcs.width) / static_cast<float>(target_width);
-    float y_fraction = static_cast<float>(drcs.height) / static_cast<float>(target_height);
+    std::vector<uint8_t> stroke_mask = DilateAlphaMask(mask, target_width, target_height, stroke_width);
+    size_t cost = stroke_mask.size();
+    return &mask_cache_.Put(key, std::move(stroke_mask), cost);
+}
+
+std::vector<uint8_t> DRCSRenderer::DRCSToAlphaMask(const DRCS& drcs, int target_width, int target_height,
+                                                   DRCSScaleMode scale_mode) {
+    // Unpack the bit-packed pattern into 8-bit alpha values at first
+    std::vector<uint8_t> levels(static_cast<size_t>(drcs.depth));
+    for (int i = 0; i < drcs.depth; i++) {
+        levels[i] = alphablend::Clamp255((uint32_t)255 * i / (drcs.depth - 1));
+    }
 
-    for (int y = 0; y < target_height; y++) {
-        ColorRGBA* dest = bitmap.GetPixelAt(0, y);
-        int drcs_y = static_cast<int>(y_fraction * static_cast<float>(y));
-        for (int x = 0; x < target_width; x++) {
-            int drcs_x = static_cast<int>(x_fraction * static_cast<float>(x));
+    std::vector<uint8_t> pattern(static_cast<size_t>(drcs.width) * static_cast<size_t>(drcs.height));
+    auto value_mask = static_cast<uint32_t>(drcs.depth - 1);
+    size_t bit_offset = 0;
+    for (uint8_t& alpha : pattern) {
+        uint8_t byte = drcs.pixels[bit_offset / 8];
+        uint32_t value = (byte >> (8 - (bit_offset % 8 + drcs.depth_bits))) & value_mask;
+        alpha = levels[value];
+        bit_offset += drcs.depth_bits;
+    }
 
-            intptr_t index = (drcs_y * drcs.width + drcs_x) * drcs.depth_bits / 8;
-            intptr_t bit_offset = (drcs_y * drcs.width + drcs_x) * drcs.depth_bits % 8;
-            uint8_t byte = drcs.pixels[index];
+    std::vector<uint8_t> mask(static_cast<size_t>(target_width) * static_cast<size_t>(target_height));
+    if (scale_mode == DRCSScaleMode::kNearestNeighbor) {
+        MaskScaler::ScaleNearestNeighbor(pattern.data(), drcs.width, drcs.height,
+                                         mask.data(), target_width, target_height);
+    } else {
+        MaskScaler::ScaleAreaAveraging(pattern.data(), drcs.width, drcs.height,
+                                       mask.data(), target_width, target_height);
+    }
 
-            uint8_t value = (byte >> (8 - (bit_offset + drcs.depth_bits))) & (drcs.depth - 1);
-            uint8_t grey = alphablend::Clamp255((uint32_t)255 * value / (drcs.depth - 1));
+    return mask;
+}
 
-            if (grey) {
-                uint8_t alpha = (static_cast<uint32_t>(grey) * color.a) >> 8;
-                dest[x] = ColorRGBA(color, alpha);
-            } else {
-                dest[x] = ColorRGBA(0);
-            }
+// Dilate the mask by stroke_width to the left, right, top and bottom.
+// The returned mask is (width + stroke_width * 2) x (height + stroke_width * 2),
+// its origin is offset by (-stroke_width, -stroke_width) to the origin of the source mask.
+std::vector<uint8_t> DRCSRenderer::DilateAlphaMask(const std::vector<uint8_t>& mask, int width, int height,
+                                                   int stroke_width) {
+    int dilated_width = width + stroke_width * 2;
+    int dilated_height = height + stroke_width * 2;
+    std::vector<uint8_t> dilated(static_cast<size_t>(dilated_width) * static_cast<size_t>(dilated_height));
+
+    auto max_into = [](uint8_t* dest, const uint8_t* src, int count) {
+        for (int i = 0; i < count; i++) {
+            dest[i] = std::max(dest[i], src[i]);
         }
+    };
+
+    for (int y = 0; y < height; y++) {
+        const uint8_t* src = &mask[static_cast<size_t>(y) * width];
+
+        // Shifted horizontally, in the same row
+        uint8_t* row = &dilated[static_cast<size_t>(y + stroke_width) * dilated_width];
+        max_into(row, src, width);
+        max_into(row + stroke_width * 2, src, width);
+
+        // Shifted vertically, at the same column
+        max_into(&dilated[static_cast<size_t>(y) * dilated_width + stroke_width], src, width);
+        max_into(&dilated[static_cast<size_t>(y + stroke_width * 2) * dilated_width + stroke_width], src, width);
     }
 
-    return bitmap;
+    return dilated;
 }
 
 }  // namespace aribcaption
@@ -19,8 +19,14 @@
 #ifndef ARIBCAPTION_DRCS_RENDERER_HPP
 #define ARIBCAPTION_DRCS_RENDERER_HPP
 
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
 #include "aribcaption/caption.hpp"
 #include "aribcaption/color.hpp"
+#include "aribcaption/renderer.hpp"
+#include "base/lru_cache.hpp"
 
 namespace aribcaption {
 
@@ -31,14 +37,59 @@ public:
     DRCSRenderer() = default;
     ~DRCSRenderer() = default;
 public:
+    void SetScaleMode(DRCSScaleMode mode);
     bool DrawDRCS(const DRCS& drcs, CharStyle style, ColorRGBA color, ColorRGBA stroke_color,
                   int stroke_width, int char_width, int char_height,
                   Bitmap& target_bmp, int x, int y);
+
+    [[nodiscard]]
+    size_t cached_size() const { return mask_cache_.total_cost(); }
+
+    // Evict cached masks to free up to bytes, returns freed bytes
+    size_t TrimCache(size_t bytes);
+private:
+    struct MaskCacheKey {
+        std::string md5;
+        int width = 0;
+        int height = 0;
+        int stroke_width = 0;  // 0 for filling masks
+    public:
+        friend bool operator==(const MaskCacheKey& a, const MaskCacheKey& b) {
+            return a.width == b.width && a.height == b.height && a.stroke_width == b.stroke_width && a.md5 == b.md5;
+        }
+    };
+
+    struct MaskCacheKeyHash {
+        size_t operator()(const MaskCacheKey& key) const {
+            size_t hash = std::hash<std::string>()(key.md5);
+            hash = hash * 31 + static_cast<size_t>(key.width);
+            hash = hash * 31 + static_cast<size_t>(key.height);
+            hash = hash * 31 + static_cast<size_t>(key.stroke_width);
+            return hash;
+        }
+    };
+
+    static constexpr size_t kMaskCacheCapacity = 2 * 1024 * 1024;  // in bytes
 private:
-    static Bitmap DRCSToColoredBitmap(const DRCS& drcs, int target_width, int target_height, ColorRGBA color);
+    auto LookupOrCreateMask(const DRCS& drcs, int target_width, int target_height) -> const std::vector<uint8_t>*;
+    auto LookupOrCreateStrokeMask(const DRCS& drcs, const std::vector<uint8_t>& mask, int target_width,
+                                  int target_height, int stroke_width) -> const std::vector<uint8_t>*;
+    static std::vector<uint8_t> DRCSToAlphaMask(const DRCS& drcs, int target_width, int target_height,
+                                                DRCSScaleMode scale_mode);
+    static std::vector<uint8_t> DilateAlphaMask(const std::vector<uint8_t>& mask, int width, int height,
+                                                int stroke_width);
 public:
     DRCSRenderer(const DRCSRenderer&) = delete;
     DRCSRenderer& operator=(const DRCSRenderer&) = delete;
+private:
+    DRCSScaleMode scale_mode_ = DRCSScaleMode::kAreaAveraging;
+
+    // Scaled masks of DRCS patterns, keyed by the MD5 of the pattern
+    LRUCache<MaskCacheKey, std::vector<uint8_t>, MaskCacheKeyHash> mask_cache_{kMaskCacheCapacity};
+
+    // Holds the masks of a DRCS without MD5, which couldn't be cached
+    std::vector<uint8_t> uncached_mask_;
+    std::vector<uint8_t> uncached_stroke_mask_;
 };
 
 }  // namespace aribcaption
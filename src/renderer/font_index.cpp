@@ -0,0 +1,561 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SFNT_NAMES_H
+#include FT_TRUETYPE_IDS_H
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <unordered_set>
+#include "base/scoped_holder.hpp"
+#include "base/utf_helper.hpp"
+#include "renderer/font_index.hpp"
+
+namespace fs = std::filesystem;
+
+namespace aribcaption {
+
+namespace {
+
+constexpr char kCacheMagic[8] = {'A', 'R', 'I', 'B', 'C', 'C', 'F', 'I'};
+constexpr uint32_t kCacheVersion = 1;
+
+std::string ToLowerASCII(const std::string& str) {
+    std::string lower = str;
+    for (char& c : lower) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return lower;
+}
+
+bool IsFontFileExtension(const fs::path& path) {
+    std::string ext = ToLowerASCII(path.extension().u8string());
+    return ext == ".ttf" || ext == ".otf" || ext == ".ttc" || ext == ".otc";
+}
+
+// Cache data is written in native byte order, a cache from another architecture fails the version check
+class CacheWriter {
+public:
+    explicit CacheWriter(std::string& buffer) : buffer_(buffer) {}
+
+    template <class T>
+    void Write(T value) {
+        buffer_.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void WriteString(const std::string& str) {
+        Write(static_cast<uint32_t>(str.size()));
+        buffer_.append(str);
+    }
+private:
+    std::string& buffer_;
+};
+
+class CacheReader {
+public:
+    explicit CacheReader(const std::string& buffer) : buffer_(buffer) {}
+
+    template <class T>
+    bool Read(T& value) {
+        if (buffer_.size() - pos_ < sizeof(T)) {
+            return false;
+        }
+        memcpy(&value, buffer_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    [[nodiscard]]
+    size_t remaining() const { return buffer_.size() - pos_; }
+
+    bool ReadString(std::string& str) {
+        uint32_t length = 0;
+        if (!Read(length) || buffer_.size() - pos_ < length) {
+            return false;
+        }
+        str.assign(buffer_, pos_, length);
+        pos_ += length;
+        return true;
+    }
+private:
+    const std::string& buffer_;
+    size_t pos_ = 0;
+};
+
+std::vector<std::string> CollectFaceNames(FT_Face face) {
+    std::vector<std::string> names;
+    auto add_name = [&names](std::string&& name) {
+        if (!name.empty() && std::find(names.begin(), names.end(), name) == names.end()) {
+            names.push_back(std::move(name));
+        }
+    };
+
+    if (face->family_name) {
+        add_name(face->family_name);
+    }
+
+    FT_UInt sfnt_name_count = FT_Get_Sfnt_Name_Count(face);
+    for (FT_UInt i = 0; i < sfnt_name_count; i++) {
+        FT_SfntName sfnt_name{};
+        if (FT_Get_Sfnt_Name(face, i, &sfnt_name)) {
+            continue;
+        }
+
+        if (sfnt_name.name_id != TT_NAME_ID_FONT_FAMILY &&
+            sfnt_name.name_id != TT_NAME_ID_FULL_NAME &&
+            sfnt_name.name_id != TT_NAME_ID_TYPOGRAPHIC_FAMILY) {
+            continue;
+        }
+
+        if (sfnt_name.platform_id == TT_PLATFORM_MICROSOFT || sfnt_name.platform_id == TT_PLATFORM_APPLE_UNICODE) {
+            add_name(utf::ConvertUTF16BEToUTF8(reinterpret_cast<uint16_t*>(sfnt_name.string),
+                                               sfnt_name.string_len / 2));
+        } else if (sfnt_name.platform_id == TT_PLATFORM_MACINTOSH && sfnt_name.encoding_id == TT_MAC_ID_ROMAN) {
+            add_name(std::string(sfnt_name.string, sfnt_name.string + sfnt_name.string_len));
+        }
+    }
+
+    return names;
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> CollectFaceCoverage(FT_Face face) {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+
+    FT_UInt glyph_index = 0;
+    FT_ULong charcode = FT_Get_First_Char(face, &glyph_index);
+    while (glyph_index != 0) {
+        auto ucs4 = static_cast<uint32_t>(charcode);
+        if (!ranges.empty() && ranges.back().second + 1 == ucs4) {
+            ranges.back().second = ucs4;
+        } else {
+            ranges.emplace_back(ucs4, ucs4);
+        }
+        charcode = FT_Get_Next_Char(face, charcode, &glyph_index);
+    }
+
+    // Charmaps are usually iterated in ascending order, normalize anyway
+    std::sort(ranges.begin(), ranges.end());
+    std::vector<std::pair<uint32_t, uint32_t>> merged;
+    for (const auto& range : ranges) {
+        if (!merged.empty() && range.first <= merged.back().second + 1) {
+            merged.back().second = std::max(merged.back().second, range.second);
+        } else {
+            merged.push_back(range);
+        }
+    }
+    merged.shrink_to_fit();
+    return merged;
+}
+
+std::vector<FontIndex::Face> IndexFontFile(FT_Library library, const std::string& filename, Logger& log) {
+    std::vector<FontIndex::Face> faces;
+
+    FT_Face face = nullptr;
+    if (FT_New_Face(library, filename.c_str(), 0, &face)) {
+        log.w("FontIndex: Cannot open font file %s", filename.c_str());
+        return faces;
+    }
+    FT_Long num_faces = face->num_faces;
+    FT_Done_Face(face);
+
+    for (FT_Long i = 0; i < num_faces; i++) {
+        if (FT_New_Face(library, filename.c_str(), i, &face)) {
+            log.w("FontIndex: Cannot open face %ld of font file %s", static_cast<long>(i), filename.c_str());
+            continue;
+        }
+        ScopedHolder<FT_Face> holder(face, FT_Done_Face);
+
+        // Only outline fonts with Unicode charmap could be used by the renderer
+        if (!FT_IS_SCALABLE(face) || !face->charmap || face->charmap->encoding != FT_ENCODING_UNICODE) {
+            continue;
+        }
+
+        FontIndex::Face entry;
+        entry.filename = filename;
+        entry.face_index = static_cast<int>(i);
+        entry.regular = !(face->style_flags & (FT_STYLE_FLAG_BOLD | FT_STYLE_FLAG_ITALIC));
+        if (const char* postscript_name = FT_Get_Postscript_Name(face)) {
+            entry.postscript_name = postscript_name;
+        }
+        entry.names = CollectFaceNames(face);
+        entry.coverage = CollectFaceCoverage(face);
+        faces.push_back(std::move(entry));
+    }
+
+    return faces;
+}
+
+// Random suffix for temporary files, distinct across processes and threads
+std::string MakeUniqueSuffix() {
+    std::random_device random_device;
+    uint64_t value = (static_cast<uint64_t>(random_device()) << 32) | random_device();
+    value ^= std::hash<std::thread::id>()(std::this_thread::get_id());
+    value ^= static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+
+    char suffix[17] = {};
+    snprintf(suffix, sizeof(suffix), "%016llx", static_cast<unsigned long long>(value));
+    return suffix;
+}
+
+}  // namespace
+
+bool FontIndex::Face::Covers(uint32_t ucs4) const {
+    // Find the last range beginning at or before ucs4
+    auto iter = std::upper_bound(coverage.begin(), coverage.end(), ucs4,
+                                 [](uint32_t value, const std::pair<uint32_t, uint32_t>& range) {
+                                     return value < range.first;
+                                 });
+    if (iter == coverage.begin()) {
+        return false;
+    }
+    return ucs4 <= std::prev(iter)->second;
+}
+
+FontIndex::FontIndex(Context& context) : log_(GetContextLogger(context)) {}
+
+FontIndex::~FontIndex() = default;
+
+bool FontIndex::Build(const std::vector<std::string>& paths, const std::string& cache_path) {
+    faces_.clear();
+    name_map_.clear();
+
+    std::vector<FileStamp> files = ScanFiles(paths);
+
+    std::vector<FileStamp> cached_files;
+    std::vector<std::vector<Face>> cached_file_faces;
+    if (!cache_path.empty()) {
+        // A missing or corrupted cache is a cache miss, outputs are only filled on success
+        LoadCache(cache_path, cached_files, cached_file_faces);
+    }
+
+    std::unordered_map<std::string, size_t> cached_file_map;
+    for (size_t i = 0; i < cached_files.size(); i++) {
+        cached_file_map.emplace(cached_files[i].filename, i);
+    }
+
+    ScopedHolder<FT_Library> library;
+    std::vector<std::vector<Face>> file_faces(files.size());
+    size_t parsed_count = 0;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        auto iter = cached_file_map.find(files[i].filename);
+        if (iter != cached_file_map.end() && cached_files[iter->second] == files[i]) {
+            file_faces[i] = std::move(cached_file_faces[iter->second]);
+            continue;
+        }
+
+        if (!library) {
+            FT_Library ft_library = nullptr;
+            if (FT_Init_FreeType(&ft_library)) {
+                log_->e("FontIndex: FT_Init_FreeType() failed");
+                return false;
+            }
+            library = ScopedHolder<FT_Library>(ft_library, FT_Done_FreeType);
+        }
+        file_faces[i] = IndexFontFile(library, files[i].filename, *log_);
+        parsed_count++;
+    }
+
+    if (!cache_path.empty() && (parsed_count || files.size() != cached_files.size())) {
+        SaveCache(cache_path, files, file_faces);
+    }
+
+    for (std::vector<Face>& faces : file_faces) {
+        std::move(faces.begin(), faces.end(), std::back_inserter(faces_));
+    }
+    std::stable_partition(faces_.begin(), faces_.end(), [](const Face& face) { return face.regular; });
+
+    for (size_t i = 0; i < faces_.size(); i++) {
+        const Face& face = faces_[i];
+        auto add_name = [&](const std::string& name) {
+            std::vector<size_t>& indices = name_map_[ToLowerASCII(name)];
+            if (indices.empty() || indices.back() != i) {
+                indices.push_back(i);
+            }
+        };
+        for (const std::string& name : face.names) {
+            add_name(name);
+        }
+        if (!face.postscript_name.empty()) {
+            add_name(face.postscript_name);
+        }
+    }
+
+    if (faces_.empty()) {
+        log_->e("FontIndex: No font face found in font paths");
+        return false;
+    }
+
+    log_->v("FontIndex: Indexed %zu faces in %zu files, %zu files parsed",
+            faces_.size(), files.size(), parsed_count);
+    return true;
+}
+
+auto FontIndex::Find(const std::string& font_name, std::optional<uint32_t> ucs4) const
+        -> Result<const Face*, FontProviderError> {
+    if (faces_.empty()) {
+        return Err(FontProviderError::kFontNotFound);
+    }
+
+    bool need_codepoint = ucs4.has_value() && ucs4 != 0;
+
+    auto iter = name_map_.find(ToLowerASCII(font_name));
+    if (iter != name_map_.end()) {
+        for (size_t index : iter->second) {
+            const Face& face = faces_[index];
+            if (!need_codepoint || face.Covers(ucs4.value())) {
+                return Ok(&face);
+            }
+        }
+        return Err(FontProviderError::kCodePointNotFound);
+    }
+
+    // Substitute unknown names with indexed faces
+    if (!need_codepoint) {
+        return Ok(&faces_.front());
+    }
+    for (const Face& face : faces_) {
+        if (face.Covers(ucs4.value())) {
+            return Ok(&face);
+        }
+    }
+    return Err(FontProviderError::kCodePointNotFound);
+}
+
+auto FontIndex::ScanFiles(const std::vector<std::string>& paths) -> std::vector<FileStamp> {
+    std::vector<fs::path> found;
+
+    for (const std::string& path_str : paths) {
+        fs::path path = fs::u8path(path_str);
+        std::error_code ec;
+
+        if (fs::is_directory(path, ec)) {
+            std::vector<fs::path> dir_files;
+            fs::recursive_directory_iterator iter(path, fs::directory_options::skip_permission_denied, ec);
+            for (; !ec && iter != fs::recursive_directory_iterator(); iter.increment(ec)) {
+                std::error_code file_ec;
+                if (iter->is_regular_file(file_ec) && IsFontFileExtension(iter->path())) {
+                    dir_files.push_back(iter->path());
+                }
+            }
+            if (ec) {
+                log_->w("FontIndex: Scanning directory %s failed: %s", path_str.c_str(), ec.message().c_str());
+            }
+            // Directory iteration order is unspecified
+            std::sort(dir_files.begin(), dir_files.end());
+            std::move(dir_files.begin(), dir_files.end(), std::back_inserter(found));
+        } else if (fs::is_regular_file(path, ec)) {
+            found.push_back(std::move(path));
+        } else {
+            log_->w("FontIndex: Font path %s is neither a file nor a directory", path_str.c_str());
+        }
+    }
+
+    std::vector<FileStamp> files;
+    std::unordered_set<std::string> found_filenames;  // Paths could overlap, e.g. a directory and its subdirectory
+    for (const fs::path& path : found) {
+        FileStamp stamp;
+        stamp.filename = path.u8string();
+        if (!found_filenames.insert(stamp.filename).second) {
+            continue;
+        }
+
+        std::error_code ec;
+        stamp.size = static_cast<uint64_t>(fs::file_size(path, ec));
+        if (ec) {
+            continue;
+        }
+        stamp.mtime = static_cast<int64_t>(fs::last_write_time(path, ec).time_since_epoch().count());
+        if (ec) {
+            continue;
+        }
+        files.push_back(std::move(stamp));
+    }
+
+    return files;
+}
+
+bool FontIndex::LoadCache(const std::string& cache_path,
+                          std::vector<FileStamp>& out_files,
+                          std::vector<std::vector<Face>>& out_file_faces) {
+    std::ifstream stream(fs::u8path(cache_path), std::ios::binary);
+    if (!stream) {
+        return false;
+    }
+    std::string buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    CacheReader reader(buffer);
+    char magic[sizeof(kCacheMagic)] = {};
+    uint32_t version = 0;
+    uint32_t file_count = 0;
+    if (!reader.Read(magic) || memcmp(magic, kCacheMagic, sizeof(kCacheMagic)) != 0 ||
+            !reader.Read(version) || version != kCacheVersion || !reader.Read(file_count)) {
+        log_->w("FontIndex: Ignoring incompatible cache file %s", cache_path.c_str());
+        return false;
+    }
+
+    // Counts are untrusted, vectors only grow with the entries actually read from the buffer
+    auto read_face = [&reader](Face& face) -> bool {
+        int32_t face_index = 0;
+        uint8_t regular = 0;
+        uint32_t name_count = 0;
+        if (!reader.Read(face_index) || face_index < 0 || !reader.Read(regular) ||
+                !reader.ReadString(face.postscript_name) || !reader.Read(name_count)) {
+            return false;
+        }
+        face.face_index = face_index;
+        face.regular = regular != 0;
+
+        for (uint32_t i = 0; i < name_count; i++) {
+            std::string name;
+            if (!reader.ReadString(name)) {
+                return false;
+            }
+            face.names.push_back(std::move(name));
+        }
+
+        uint32_t range_count = 0;
+        if (!reader.Read(range_count)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < range_count; i++) {
+            std::pair<uint32_t, uint32_t> range;
+            if (!reader.Read(range.first) || !reader.Read(range.second) || range.first > range.second) {
+                return false;
+            }
+            // Face::Covers() relies on sorted, disjoint ranges
+            if (!face.coverage.empty() && range.first <= face.coverage.back().second) {
+                return false;
+            }
+            face.coverage.push_back(range);
+        }
+        return true;
+    };
+
+    std::vector<FileStamp> files;
+    std::vector<std::vector<Face>> file_faces;
+    bool corrupted = false;
+
+    for (uint32_t i = 0; i < file_count && !corrupted; i++) {
+        FileStamp stamp;
+        uint32_t face_count = 0;
+        if (!reader.ReadString(stamp.filename) || !reader.Read(stamp.size) || !reader.Read(stamp.mtime) ||
+                !reader.Read(face_count)) {
+            corrupted = true;
+            break;
+        }
+
+        std::vector<Face> faces;
+        for (uint32_t n = 0; n < face_count; n++) {
+            Face face;
+            if (!read_face(face)) {
+                corrupted = true;
+                break;
+            }
+            face.filename = stamp.filename;
+            faces.push_back(std::move(face));
+        }
+
+        files.push_back(std::move(stamp));
+        file_faces.push_back(std::move(faces));
+    }
+
+    if (corrupted || reader.remaining() != 0) {
+        log_->w("FontIndex: Ignoring corrupted cache file %s", cache_path.c_str());
+        return false;
+    }
+
+    out_files = std::move(files);
+    out_file_faces = std::move(file_faces);
+    return true;
+}
+
+bool FontIndex::SaveCache(const std::string& cache_path,
+                          const std::vector<FileStamp>& files,
+                          const std::vector<std::vector<Face>>& file_faces) {
+    std::string buffer;
+    CacheWriter writer(buffer);
+
+    buffer.append(kCacheMagic, sizeof(kCacheMagic));
+    writer.Write(kCacheVersion);
+    writer.Write(static_cast<uint32_t>(files.size()));
+
+    for (size_t i = 0; i < files.size(); i++) {
+        writer.WriteString(files[i].filename);
+        writer.Write(files[i].size);
+        writer.Write(files[i].mtime);
+        writer.Write(static_cast<uint32_t>(file_faces[i].size()));
+
+        for (const Face& face : file_faces[i]) {
+            writer.Write(static_cast<int32_t>(face.face_index));
+            writer.Write(static_cast<uint8_t>(face.regular));
+            writer.WriteString(face.postscript_name);
+            writer.Write(static_cast<uint32_t>(face.names.size()));
+            for (const std::string& name : face.names) {
+                writer.WriteString(name);
+            }
+            writer.Write(static_cast<uint32_t>(face.coverage.size()));
+            for (const auto& range : face.coverage) {
+                writer.Write(range.first);
+                writer.Write(range.second);
+            }
+        }
+    }
+
+    // Write into a temporary file unique to this writer and rename it, so that concurrent writers
+    // never write into the same file, and readers see either the old or a complete new cache
+    fs::path path = fs::u8path(cache_path);
+    fs::path temp_path = fs::u8path(cache_path + "." + MakeUniqueSuffix() + ".tmp");
+    std::error_code ec;
+    if (path.has_parent_path()) {
+        fs::create_directories(path.parent_path(), ec);
+    }
+
+    {
+        std::ofstream stream(temp_path, std::ios::binary | std::ios::trunc);
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        stream.close();
+        if (!stream) {
+            log_->w("FontIndex: Cannot write cache file %s", cache_path.c_str());
+            fs::remove(temp_path, ec);
+            return false;
+        }
+    }
+
+    fs::rename(temp_path, path, ec);
+    if (ec) {
+        log_->w("FontIndex: Cannot write cache file %s: %s", cache_path.c_str(), ec.message().c_str());
+        fs::remove(temp_path, ec);
+        return false;
+    }
+
+    return true;
+}
+
+}  // namespace aribcaption
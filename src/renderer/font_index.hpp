@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_FONT_INDEX_HPP
+#define ARIBCAPTION_FONT_INDEX_HPP
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "aribcaption/context.hpp"
+#include "base/logger.hpp"
+#include "base/result.hpp"
+#include "renderer/font_provider.hpp"
+
+namespace aribcaption {
+
+// Index of font faces contained in a list of font files / directories, built with FreeType.
+// The index could be saved into a cache file, and reused as long as the indexed files are unchanged.
+// Once built, the index is immutable and could be shared between threads.
+class FontIndex {
+public:
+    struct Face {
+        std::string filename;
+        int face_index = 0;
+        bool regular = true;                     // Neither bold nor italic
+        std::string postscript_name;
+        std::vector<std::string> names;          // Family names and full names, in all localizations
+        std::vector<std::pair<uint32_t, uint32_t>> coverage;  // Sorted codepoint ranges [first, last]
+    public:
+        [[nodiscard]]
+        bool Covers(uint32_t ucs4) const;
+    };
+public:
+    explicit FontIndex(Context& context);
+    ~FontIndex();
+public:
+    // Index font files in paths. Directories are scanned recursively for .ttf / .otf / .ttc / .otc files.
+    // If cache_path is not empty, faces of unchanged files are loaded from the cache file, which is updated
+    // if anything has changed. Returns false if no font face has been indexed.
+    bool Build(const std::vector<std::string>& paths, const std::string& cache_path);
+
+    // Find a face by family name, full name or PostScript name (ASCII case-insensitive), preferring regular faces.
+    // Unknown names (e.g. generic families like "sans-serif") are substituted with the first indexed face,
+    // or the first face containing ucs4 if specified.
+    auto Find(const std::string& font_name, std::optional<uint32_t> ucs4) const
+        -> Result<const Face*, FontProviderError>;
+
+    [[nodiscard]]
+    size_t face_count() const { return faces_.size(); }
+private:
+    // A font file found in paths, for validating the cache
+    struct FileStamp {
+        std::string filename;
+        uint64_t size = 0;
+        int64_t mtime = 0;
+    public:
+        friend bool operator==(const FileStamp& a, const FileStamp& b) {
+            return a.size == b.size && a.mtime == b.mtime && a.filename == b.filename;
+        }
+    };
+private:
+    std::vector<FileStamp> ScanFiles(const std::vector<std::string>& paths);
+    bool LoadCache(const std::string& cache_path,
+                   std::vector<FileStamp>& out_files,
+                   std::vector<std::vector<Face>>& out_file_faces);
+    bool SaveCache(const std::string& cache_path,
+                   const std::vector<FileStamp>& files,
+                   const std::vector<std::vector<Face>>& file_faces);
+public:
+    FontIndex(const FontIndex&) = delete;
+    FontIndex& operator=(const FontIndex&) = delete;
+private:
+    std::shared_ptr<Logger> log_;
+
+    std::vector<Face> faces_;  // In the order of paths, regular faces first
+
+    // Lower-cased name => indices into faces_
+    std::unordered_map<std::string, std::vector<size_t>> name_map_;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_FONT_INDEX_HPP
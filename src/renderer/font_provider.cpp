@@ -17,6 +17,7 @@
  */
 
 #include <memory>
+#include <utility>
 #include "aribcc_config.h"
 #include "renderer/font_provider.hpp"
 
@@ -40,9 +41,15 @@
     #include "renderer/font_provider_gdi.hpp"
 #endif
 
+#if defined(ARIBCC_USE_FREETYPE)
+    #include "renderer/font_provider_directory.hpp"
+#endif
+
 namespace aribcaption {
 
-std::unique_ptr<FontProvider> FontProvider::Create(FontProviderType type, Context& context) {
+std::unique_ptr<FontProvider> FontProvider::Create(FontProviderType type,
+                                                   Context& context,
+                                                   std::shared_ptr<const FontIndex> font_index) {
     switch (type) {
 #if defined(ARIBCC_USE_CORETEXT)
         case FontProviderType::kCoreText:
@@ -69,6 +76,11 @@ std::unique_ptr<FontProvider> FontProvider::Create(FontProviderType type, Contex
             return std::make_unique<FontProviderGDI>(context);
 #endif
 
+#if defined(ARIBCC_USE_FREETYPE)
+        case FontProviderType::kDirectory:
+            return std::make_unique<FontProviderDirectory>(context, std::move(font_index));
+#endif
+
         case FontProviderType::kAuto:
         default:
 #if defined(_WIN32) && defined(ARIBCC_USE_DIRECTWRITE)
@@ -30,6 +30,8 @@
 
 namespace aribcaption {
 
+class FontIndex;
+
 struct FontfaceInfoPrivate {
 public:
     FontfaceInfoPrivate() = default;
@@ -54,7 +56,10 @@ enum class FontProviderError {
 
 class FontProvider {
 public:
-    static std::unique_ptr<FontProvider> Create(FontProviderType type, Context& context);
+    // font_index is only used by FontProviderType::kDirectory
+    static std::unique_ptr<FontProvider> Create(FontProviderType type,
+                                                Context& context,
+                                                std::shared_ptr<const FontIndex> font_index = nullptr);
 public:
     FontProvider() = default;
     virtual ~FontProvider() = default;
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cassert>
+#include <utility>
+#include "renderer/font_provider_directory.hpp"
+
+namespace aribcaption {
+
+FontProviderDirectory::FontProviderDirectory(Context& context, std::shared_ptr<const FontIndex> font_index)
+    : log_(GetContextLogger(context)), font_index_(std::move(font_index)) {}
+
+FontProviderDirectory::~FontProviderDirectory() = default;
+
+FontProviderType FontProviderDirectory::GetType() {
+    return FontProviderType::kDirectory;
+}
+
+bool FontProviderDirectory::Initialize() {
+    if (!font_index_) {
+        log_->e("FontProviderDirectory: Font search paths haven't been indicated");
+        return false;
+    }
+    return true;
+}
+
+void FontProviderDirectory::SetLanguage(uint32_t iso6392_language_code) {
+    // Faces are selected by name and codepoint coverage only
+    (void)iso6392_language_code;
+}
+
+auto FontProviderDirectory::GetFontFace(const std::string& font_name,
+                                        std::optional<uint32_t> ucs4) -> Result<FontfaceInfo, FontProviderError> {
+    assert(font_index_);
+
+    auto result = font_index_->Find(font_name, ucs4);
+    if (result.is_err()) {
+        if (result.error() == FontProviderError::kCodePointNotFound) {
+            log_->w("FontProviderDirectory: Font %s doesn't contain U+%04X", font_name.c_str(), ucs4.value());
+        } else {
+            log_->w("FontProviderDirectory: Cannot find a suitable font for %s", font_name.c_str());
+        }
+        return Err(result.error());
+    }
+
+    const FontIndex::Face* face = result.value();
+
+    FontfaceInfo info;
+    if (!face->names.empty()) {
+        info.family_name = face->names.front();
+    }
+    info.postscript_name = face->postscript_name;
+    info.filename = face->filename;
+    info.face_index = face->face_index;
+    info.provider_type = FontProviderType::kDirectory;
+
+    return Ok(std::move(info));
+}
+
+}  // namespace aribcaption
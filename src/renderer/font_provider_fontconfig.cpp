@@ -43,6 +43,7 @@ bool FontProviderFontconfig::Initialize() {
         return false;
     }
     config_ = ScopedHolder<FcConfig*>(config, FcConfigDestroy);
+    match_cache_.clear();
     return true;
 }
 
@@ -54,13 +55,45 @@ auto FontProviderFontconfig::GetFontFace(const std::string& font_name,
                                          std::optional<uint32_t> ucs4) -> Result<FontfaceInfo, FontProviderError> {
     assert(config_);
 
+    MatchCacheKey key{font_name, iso6392_language_code_};
+    auto iter = match_cache_.find(key);
+    if (iter == match_cache_.end()) {
+        iter = match_cache_.emplace(std::move(key), MatchFont(font_name)).first;
+    }
+
+    const MatchResult& match = iter->second;
+    if (match.error) {
+        return Err(match.error.value());
+    }
+
+    if (ucs4.has_value() && ucs4 != 0) {
+        if (FcTrue != FcCharSetHasChar(match.charset, ucs4.value())) {
+            log_->w("Fontconfig: Font %s doesn't contain U+%04X", font_name.c_str(), ucs4.value());
+            return Err(FontProviderError::kCodePointNotFound);
+        }
+    }
+
+    FontfaceInfo info;
+    info.family_name = match.family_name;
+    info.postscript_name = match.postscript_name;
+    info.filename = match.filename;
+    info.face_index = match.face_index;
+    info.provider_type = FontProviderType::kFontconfig;
+
+    return Ok(std::move(info));
+}
+
+auto FontProviderFontconfig::MatchFont(const std::string& font_name) -> MatchResult {
+    MatchResult match;
+
     ScopedHolder<FcPattern*> pattern(
         FcNameParse(reinterpret_cast<const FcChar8*>(font_name.c_str())),
         FcPatternDestroy
     );
     if (!pattern) {
         log_->e("Fontconfig: Cannot parse font pattern string");
-        return Err(FontProviderError::kFontNotFound);
+        match.error = FontProviderError::kFontNotFound;
+        return match;
     }
 
     FcPatternAddString(pattern, FC_FAMILY, reinterpret_cast<const FcChar8*>(font_name.c_str()));
@@ -68,7 +101,8 @@ auto FontProviderFontconfig::GetFontFace(const std::string& font_name,
 
     if (FcTrue != FcConfigSubstitute(config_, pattern, FcMatchPattern)) {
         log_->e("Fontconfig: Substitution cannot be performed");
-        return Err(FontProviderError::kOtherError);
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
     FcDefaultSubstitute(pattern);
 
@@ -84,7 +118,8 @@ auto FontProviderFontconfig::GetFontFace(const std::string& font_name,
     FcPattern* matched = FcFontMatch(config_, pattern, &result);
     if (!matched || result != FcResultMatch) {
         log_->w("Fontconfig: Cannot find a suitable font for %s", font_name.c_str());
-        return Err(FontProviderError::kFontNotFound);
+        match.error = FontProviderError::kFontNotFound;
+        return match;
     }
 
     ScopedHolder<FcPattern*> best(matched, FcPatternDestroy);
@@ -92,49 +127,44 @@ auto FontProviderFontconfig::GetFontFace(const std::string& font_name,
     FcChar8* filename = nullptr;
     if (FcResultMatch != FcPatternGetString(best, FC_FILE, 0, &filename)) {
         log_->e("Fontconfig: Retrieve font filename failed for %s", font_name.c_str());
-        return Err(FontProviderError::kOtherError);
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
 
     int fc_index = 0;
     if (FcResultMatch != FcPatternGetInteger(best, FC_INDEX, 0, &fc_index)) {
         log_->e("Fontconfig: Retrieve font FC_INDEX failed for %s", font_name.c_str());
-        return Err(FontProviderError::kOtherError);
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
 
-    if (ucs4.has_value() && ucs4 != 0) {
-        FcCharSet* charset = nullptr;
-
-        if (FcResultMatch != FcPatternGetCharSet(best, FC_CHARSET, 0, &charset)) {
-            log_->e("Fontconfig: Retrieve font charset failed for %s", font_name.c_str());
-            return Err(FontProviderError::kOtherError);
-        }
-
-        if (FcTrue != FcCharSetHasChar(charset, ucs4.value())) {
-            log_->w("Fontconfig: Font %s doesn't contain U+%04X", font_name.c_str(), ucs4.value());
-            return Err(FontProviderError::kCodePointNotFound);
-        }
+    FcCharSet* charset = nullptr;
+    if (FcResultMatch != FcPatternGetCharSet(best, FC_CHARSET, 0, &charset)) {
+        log_->e("Fontconfig: Retrieve font charset failed for %s", font_name.c_str());
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
 
     FcChar8* fc_family_name = nullptr;
     if (FcResultMatch != FcPatternGetString(best, FC_FAMILY, 0, &fc_family_name)) {
         log_->e("Fontconfig: Retrieve font FC_FAMILY failed for %s", font_name.c_str());
-        return Err(FontProviderError::kOtherError);
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
 
     FcChar8* fc_postscript_name = nullptr;
     if (FcResultMatch != FcPatternGetString(best, FC_POSTSCRIPT_NAME, 0, &fc_postscript_name)) {
         log_->e("Fontconfig: Retrieve font FC_POSTSCRIPT_NAME failed for %s", font_name.c_str());
-        return Err(FontProviderError::kOtherError);
+        match.error = FontProviderError::kOtherError;
+        return match;
     }
 
-    FontfaceInfo info;
-    info.family_name = reinterpret_cast<char*>(fc_family_name);
-    info.postscript_name = reinterpret_cast<char*>(fc_postscript_name);
-    info.filename = reinterpret_cast<char*>(filename);
-    info.face_index = fc_index;
-    info.provider_type = FontProviderType::kFontconfig;
-
-    return Ok(std::move(info));
+    match.family_name = reinterpret_cast<char*>(fc_family_name);
+    match.postscript_name = reinterpret_cast<char*>(fc_postscript_name);
+    match.filename = reinterpret_cast<char*>(filename);
+    match.face_index = fc_index;
+    match.charset = ScopedHolder<FcCharSet*>(FcCharSetCopy(charset), FcCharSetDestroy);
+    return match;
 }
 
 }  // namespace aribcaption
@@ -23,6 +23,7 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "aribcaption/context.hpp"
 #include "base/logger.hpp"
@@ -41,11 +42,41 @@ public:
     void SetLanguage(uint32_t iso6392_language_code) override;
     Result<FontfaceInfo, FontProviderError> GetFontFace(const std::string& font_name,
                                                         std::optional<uint32_t> ucs4) override;
+private:
+    // Result of FcFontMatch(), which doesn't depend on the requested codepoint
+    struct MatchResult {
+        std::optional<FontProviderError> error;  // Set if no suitable font has been matched
+        std::string family_name;
+        std::string postscript_name;
+        std::string filename;
+        int face_index = 0;
+        ScopedHolder<FcCharSet*> charset;  // Referenced from the matched pattern
+    };
+
+    struct MatchCacheKey {
+        std::string font_name;
+        uint32_t iso6392_language_code = 0;
+    public:
+        friend bool operator==(const MatchCacheKey& a, const MatchCacheKey& b) {
+            return a.iso6392_language_code == b.iso6392_language_code && a.font_name == b.font_name;
+        }
+    };
+
+    struct MatchCacheKeyHash {
+        size_t operator()(const MatchCacheKey& key) const {
+            return std::hash<std::string>()(key.font_name) * 31 + key.iso6392_language_code;
+        }
+    };
+private:
+    MatchResult MatchFont(const std::string& font_name);
 private:
     std::shared_ptr<Logger> log_;
 
     ScopedHolder<FcConfig*> config_;
     uint32_t iso6392_language_code_ = 0;
+
+    // Matching is expensive with large font collections, while queried for every font (re)loading
+    std::unordered_map<MatchCacheKey, MatchResult, MatchCacheKeyHash> match_cache_;
 };
 
 }  // namespace aribcaption
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include "aribcaption/color.hpp"
+#include "base/always_inline.hpp"
+#include "renderer/alphablend.hpp"
+#include "renderer/frame_compositor.hpp"
+#include "renderer/palette_quantizer.hpp"
+
+namespace aribcaption {
+
+static ALWAYS_INLINE uint32_t SwapRedBlueOfPixel(uint32_t pixel) {
+    return (pixel & 0xFF00FF00) | ((pixel & 0x00FF0000) >> 16) | ((pixel & 0x000000FF) << 16);
+}
+
+bool FrameCompositor::IsValidFrame(const VideoFrame& frame) {
+    if (frame.width <= 0 || frame.height <= 0) {
+        return false;
+    }
+
+    int chroma_width = (frame.width + 1) / 2;
+
+    switch (frame.pixel_format) {
+        case FramePixelFormat::kRGBA8888:
+        case FramePixelFormat::kBGRA8888:
+            // Blend kernels work on whole pixels, which must be at least 4-byte aligned
+            return frame.planes[0] &&
+                   reinterpret_cast<uintptr_t>(frame.planes[0]) % 4 == 0 &&
+                   frame.strides[0] % 4 == 0 &&
+                   frame.strides[0] >= frame.width * 4;
+        case FramePixelFormat::kNV12:
+            return frame.planes[0] && frame.planes[1] &&
+                   frame.strides[0] >= frame.width &&
+                   frame.strides[1] >= chroma_width * 2;
+        case FramePixelFormat::kYUV420P:
+            return frame.planes[0] && frame.planes[1] && frame.planes[2] &&
+                   frame.strides[0] >= frame.width &&
+                   frame.strides[1] >= chroma_width &&
+                   frame.strides[2] >= chroma_width;
+        default:
+            return false;
+    }
+}
+
+FrameCompositor::FrameCompositor(VideoFrame& frame) : frame_(frame) {
+    if (frame.pixel_format == FramePixelFormat::kNV12 || frame.pixel_format == FramePixelFormat::kYUV420P) {
+        coefficients_ = CalculateYUVCoefficients(frame.color_space, frame.full_range);
+    }
+}
+
+void FrameCompositor::DrawImage(const Image& image) {
+    if (image.bitmap.empty()) {
+        return;
+    }
+
+    if (image.pixel_format == PixelFormat::kPAL8) {
+        DrawImage(PaletteQuantizer::ExpandToRGBA(image));
+        return;
+    }
+
+    Rect rect{image.dst_x, image.dst_y, image.dst_x + image.width, image.dst_y + image.height};
+    Rect clipped = Rect::ClipRect(Rect(0, 0, frame_.width, frame_.height), rect);
+
+    if (clipped.width() <= 0 || clipped.height() <= 0) {
+        return;
+    }
+
+    switch (frame_.pixel_format) {
+        case FramePixelFormat::kRGBA8888:
+        case FramePixelFormat::kBGRA8888:
+            DrawImageToPackedRGB(image, rect, clipped);
+            break;
+        case FramePixelFormat::kNV12:
+        case FramePixelFormat::kYUV420P:
+            DrawImageToYUV420(image, rect, clipped);
+            break;
+    }
+}
+
+void FrameCompositor::SwapRedBlue(const Rect& rect) {
+    assert(frame_.pixel_format == FramePixelFormat::kRGBA8888 || frame_.pixel_format == FramePixelFormat::kBGRA8888);
+    Rect clipped = Rect::ClipRect(Rect(0, 0, frame_.width, frame_.height), rect);
+
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        auto line = reinterpret_cast<ColorRGBA*>(frame_.planes[0] + static_cast<ptrdiff_t>(y) * frame_.strides[0]);
+        for (int x = clipped.left; x < clipped.right; x++) {
+            line[x].u32 = SwapRedBlueOfPixel(line[x].u32);
+        }
+    }
+}
+
+void FrameCompositor::DrawImageToPackedRGB(const Image& image, const Rect& rect, const Rect& clipped) {
+    int clip_x_offset = clipped.left - rect.left;
+    int clip_y_offset = clipped.top - rect.top;
+    auto line_width = static_cast<size_t>(clipped.width());
+    bool swap_r_b = frame_.pixel_format == FramePixelFormat::kBGRA8888;
+
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        auto dest = reinterpret_cast<ColorRGBA*>(frame_.planes[0] + static_cast<ptrdiff_t>(y) * frame_.strides[0])
+                    + clipped.left;
+        auto src_line = image.bitmap.data() + static_cast<size_t>(clip_y_offset + y - clipped.top) * image.stride;
+        auto src = reinterpret_cast<const ColorRGBA*>(src_line) + clip_x_offset;
+
+        if (!swap_r_b) {
+            alphablend::BlendLine(dest, src, line_width);
+            continue;
+        }
+
+        // The blend is symmetric on R and B, swap them in the source and reuse the RGBA kernels
+        constexpr size_t kChunkPixels = 256;
+        alignas(16) ColorRGBA swapped[kChunkPixels];
+
+        for (size_t i = 0; i < line_width; i += kChunkPixels) {
+            size_t count = std::min(kChunkPixels, line_width - i);
+            for (size_t j = 0; j < count; j++) {
+                swapped[j].u32 = SwapRedBlueOfPixel(src[i + j].u32);
+            }
+            alphablend::BlendLine(dest + i, swapped, count);
+        }
+    }
+}
+
+void FrameCompositor::DrawImageToYUV420(const Image& image, const Rect& rect, const Rect& clipped) {
+    const alphablend::YUVCoefficients& k = coefficients_;
+
+    auto src_pixel_at = [&](int x, int y) -> const ColorRGBA& {
+        auto line = reinterpret_cast<const ColorRGBA*>(image.bitmap.data() +
+                                                       static_cast<size_t>(y - rect.top) * image.stride);
+        return line[x - rect.left];
+    };
+
+    // Luma, per pixel
+    for (int y = clipped.top; y < clipped.bottom; y++) {
+        uint8_t* dest = frame_.planes[0] + static_cast<ptrdiff_t>(y) * frame_.strides[0] + clipped.left;
+        alphablend::BlendLumaLine(dest, &src_pixel_at(clipped.left, y), static_cast<size_t>(clipped.width()), k);
+    }
+
+    // Chroma, per 2x2 block, source chroma weighted by the coverage of each pixel within the block
+    bool interleaved = frame_.pixel_format == FramePixelFormat::kNV12;
+    size_t step = interleaved ? 2 : 1;
+    int chroma_left = clipped.left / 2;
+    int chroma_right = (clipped.right + 1) / 2;
+    int chroma_top = clipped.top / 2;
+    int chroma_bottom = (clipped.bottom + 1) / 2;
+
+    // Columns of blocks fully covered by the clipped rect
+    int inner_left = (clipped.left + 1) / 2;
+    int inner_right = clipped.right / 2;
+
+    // Blocks on the edges are partially covered, pixels outside the clipped rect are skipped
+    auto blend_edge_block = [&](uint8_t* u_line, uint8_t* v_line, int cx, int cy) {
+        int32_t sum_alpha = 0;
+        int32_t sum_u = 0;
+        int32_t sum_v = 0;
+
+        for (int y = cy * 2; y < cy * 2 + 2; y++) {
+            for (int x = cx * 2; x < cx * 2 + 2; x++) {
+                if (!clipped.Contains(x, y)) {
+                    continue;
+                }
+                const ColorRGBA& color = src_pixel_at(x, y);
+                sum_alpha += color.a;
+                sum_u += alphablend::ConvertToU(k, color) * color.a;
+                sum_v += alphablend::ConvertToV(k, color) * color.a;
+            }
+        }
+
+        uint8_t& u_dest = u_line[static_cast<size_t>(cx) * step];
+        uint8_t& v_dest = v_line[static_cast<size_t>(cx) * step];
+        u_dest = alphablend::BlendChromaBlock(u_dest, sum_alpha, sum_u);
+        v_dest = alphablend::BlendChromaBlock(v_dest, sum_alpha, sum_v);
+    };
+
+    for (int cy = chroma_top; cy < chroma_bottom; cy++) {
+        uint8_t* u_line = frame_.planes[1] + static_cast<ptrdiff_t>(cy) * frame_.strides[1];
+        uint8_t* v_line = interleaved ? u_line + 1 : frame_.planes[2] + static_cast<ptrdiff_t>(cy) * frame_.strides[2];
+
+        bool rows_covered = cy * 2 >= clipped.top && cy * 2 + 2 <= clipped.bottom;
+        if (!rows_covered || inner_left >= inner_right) {
+            for (int cx = chroma_left; cx < chroma_right; cx++) {
+                blend_edge_block(u_line, v_line, cx, cy);
+            }
+            continue;
+        }
+
+        for (int cx = chroma_left; cx < inner_left; cx++) {
+            blend_edge_block(u_line, v_line, cx, cy);
+        }
+
+        size_t offset = static_cast<size_t>(inner_left) * step;
+        alphablend::BlendChromaLine(u_line + offset, v_line + offset, step,
+                                    &src_pixel_at(inner_left * 2, cy * 2), &src_pixel_at(inner_left * 2, cy * 2 + 1),
+                                    static_cast<size_t>(inner_right - inner_left), k);
+
+        for (int cx = inner_right; cx < chroma_right; cx++) {
+            blend_edge_block(u_line, v_line, cx, cy);
+        }
+    }
+}
+
+alphablend::YUVCoefficients FrameCompositor::CalculateYUVCoefficients(FrameColorSpace color_space, bool full_range) {
+    double kr = 0.2126;
+    double kb = 0.0722;
+    if (color_space == FrameColorSpace::kBT601) {
+        kr = 0.299;
+        kb = 0.114;
+    }
+    double kg = 1.0 - kr - kb;
+
+    double y_scale = full_range ? 1.0 : 219.0 / 255.0;
+    double uv_scale = full_range ? 1.0 : 224.0 / 255.0;
+
+    auto fixed = [](double value) {
+        return static_cast<int32_t>(std::lround(value * 65536.0));
+    };
+
+    alphablend::YUVCoefficients k{};
+    k.y_r = fixed(kr * y_scale);
+    k.y_g = fixed(kg * y_scale);
+    k.y_b = fixed(kb * y_scale);
+    k.y_offset = fixed((full_range ? 0.0 : 16.0) + 0.5);
+
+    // Cb = (B - Y) / (2 * (1 - Kb)), Cr = (R - Y) / (2 * (1 - Kr))
+    k.u_r = fixed(-kr / (2.0 * (1.0 - kb)) * uv_scale);
+    k.u_g = fixed(-kg / (2.0 * (1.0 - kb)) * uv_scale);
+    k.u_b = fixed(0.5 * uv_scale);
+    k.v_r = fixed(0.5 * uv_scale);
+    k.v_g = fixed(-kg / (2.0 * (1.0 - kr)) * uv_scale);
+    k.v_b = fixed(-kb / (2.0 * (1.0 - kr)) * uv_scale);
+    k.uv_offset = fixed(128.0 + 0.5);
+
+    return k;
+}
+
+}  // namespace aribcaption
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_FRAME_COMPOSITOR_HPP
+#define ARIBCAPTION_FRAME_COMPOSITOR_HPP
+
+#include <cstdint>
+#include "aribcaption/image.hpp"
+#include "aribcaption/renderer.hpp"
+#include "renderer/alphablend_generic.hpp"
+#include "renderer/rect.hpp"
+
+namespace aribcaption {
+
+// Alpha-blends rendered RGBA images onto a caller-provided VideoFrame in its native pixel format
+class FrameCompositor {
+public:
+    static bool IsValidFrame(const VideoFrame& frame);
+public:
+    explicit FrameCompositor(VideoFrame& frame);
+    ~FrameCompositor() = default;
+public:
+    void DrawImage(const Image& image);
+
+    // Swap R and B of the pixels within rect of a packed RGB frame, i.e. convert between kRGBA8888 and kBGRA8888
+    void SwapRedBlue(const Rect& rect);
+private:
+    void DrawImageToPackedRGB(const Image& image, const Rect& rect, const Rect& clipped);
+    void DrawImageToYUV420(const Image& image, const Rect& rect, const Rect& clipped);
+public:
+    // Disallow copy and assign
+    FrameCompositor(const FrameCompositor&) = delete;
+    FrameCompositor& operator=(const FrameCompositor&) = delete;
+private:
+    static alphablend::YUVCoefficients CalculateYUVCoefficients(FrameColorSpace color_space, bool full_range);
+private:
+    VideoFrame& frame_;
+    alphablend::YUVCoefficients coefficients_{};
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_FRAME_COMPOSITOR_HPP
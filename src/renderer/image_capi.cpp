@@ -18,6 +18,7 @@
 
 #include "aribcaption/aligned_alloc.hpp"
 #include "aribcaption/image.h"
+#include "aribcaption/image.hpp"
 
 using namespace aribcaption;
 
@@ -31,4 +32,13 @@ void aribcc_image_cleanup(aribcc_image_t* image) {
     }
 }
 
+void aribcc_image_bitmap_release(void* owner, uint8_t* bitmap) {
+    if (owner) {
+        // Shared bitmap, drop the reference held by the owner
+        delete reinterpret_cast<ImageBuffer*>(owner);
+    } else if (bitmap) {
+        AlignedFree(bitmap);
+    }
+}
+
 }  // extern "C"
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "base/always_inline.hpp"
+#include "renderer/mask_scaler.hpp"
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+    #include <emmintrin.h>  // SSE2
+#endif
+
+namespace aribcaption {
+
+// Horizontal weights sum to 128, so that horizontally scaled values (at most 255 * 128) fit into int16_t.
+// Vertical weights sum to 256, the final value is (sum of weighted values) / (128 * 256)
+static constexpr int kHorizontalWeightTotal = 128;
+static constexpr int kVerticalWeightTotal = 256;
+static constexpr int kWeightShift = 15;
+
+void MaskScaler::ScaleNearestNeighbor(const uint8_t* src, int src_width, int src_height,
+                                      uint8_t* dest, int dest_width, int dest_height) {
+    // Source columns are calculated once for all rows
+    std::vector<int> source_x(static_cast<size_t>(dest_width));
+    float x_fraction = static_cast<float>(src_width) / static_cast<float>(dest_width);
+    float y_fraction = static_cast<float>(src_height) / static_cast<float>(dest_height);
+    for (int x = 0; x < dest_width; x++) {
+        source_x[x] = static_cast<int>(x_fraction * static_cast<float>(x));
+    }
+
+    for (int y = 0; y < dest_height; y++) {
+        uint8_t* dest_line = dest + static_cast<size_t>(y) * dest_width;
+        int src_y = static_cast<int>(y_fraction * static_cast<float>(y));
+        const uint8_t* src_line = src + static_cast<size_t>(src_y) * src_width;
+        for (int x = 0; x < dest_width; x++) {
+            dest_line[x] = src_line[source_x[x]];
+        }
+    }
+}
+
+void MaskScaler::ScaleAreaAveraging(const uint8_t* src, int src_width, int src_height,
+                                    uint8_t* dest, int dest_width, int dest_height) {
+    if (src_width == dest_width && src_height == dest_height) {
+        memcpy(dest, src, static_cast<size_t>(dest_width) * static_cast<size_t>(dest_height));
+        return;
+    }
+
+    Taps x_taps = CalculateAreaTaps(src_width, dest_width, kHorizontalWeightTotal);
+    Taps y_taps = CalculateAreaTaps(src_height, dest_height, kVerticalWeightTotal);
+
+    // Scale horizontally at first, source rows are usually much fewer than destination rows.
+    // Source rows are padded, so that every destination pixel could be calculated from max_count taps
+    // with trailing zero weights, which avoids branches in the inner loop.
+    int padded_width = src_width + x_taps.max_count;
+    std::vector<uint8_t> padded_line(static_cast<size_t>(padded_width));
+    std::vector<int16_t> scaled_rows(static_cast<size_t>(src_height) * static_cast<size_t>(dest_width));
+    for (int y = 0; y < src_height; y++) {
+        memcpy(padded_line.data(), src + static_cast<size_t>(y) * src_width, static_cast<size_t>(src_width));
+        int16_t* scaled_line = &scaled_rows[static_cast<size_t>(y) * dest_width];
+        if (x_taps.max_count == 2) {
+            ScaleRowHorizontally<2>(padded_line.data(), x_taps, scaled_line, dest_width);
+        } else if (x_taps.max_count == 3) {
+            ScaleRowHorizontally<3>(padded_line.data(), x_taps, scaled_line, dest_width);
+        } else {
+            ScaleRowHorizontally<0>(padded_line.data(), x_taps, scaled_line, dest_width);
+        }
+    }
+
+    // Then scale vertically, which is vectorized across the whole row
+    std::vector<const int16_t*> rows(static_cast<size_t>(y_taps.max_count));
+    for (int y = 0; y < dest_height; y++) {
+        int count = y_taps.count[y];
+        for (int i = 0; i < count; i++) {
+            rows[i] = &scaled_rows[static_cast<size_t>(y_taps.first[y] + i) * dest_width];
+        }
+        ScaleRowVertically(rows.data(), &y_taps.weights[static_cast<size_t>(y) * y_taps.max_count], count,
+                           dest + static_cast<size_t>(y) * dest_width, dest_width);
+    }
+}
+
+// kTapCount is the fixed x_taps.max_count, or 0 if not known at compile time
+template <int kTapCount>
+void MaskScaler::ScaleRowHorizontally(const uint8_t* padded_src, const Taps& x_taps, int16_t* dest, int width) {
+    int tap_count = kTapCount ? kTapCount : x_taps.max_count;
+    const int16_t* weights = x_taps.weights.data();
+    for (int x = 0; x < width; x++) {
+        const uint8_t* src = padded_src + x_taps.first[x];
+        int sum = 0;
+        for (int i = 0; i < tap_count; i++) {
+            sum += src[i] * weights[i];
+        }
+        dest[x] = static_cast<int16_t>(sum);
+        weights += tap_count;
+    }
+}
+
+// Destination pixel i covers [i * src_size, (i + 1) * src_size), and source pixel j covers
+// [j * dest_size, (j + 1) * dest_size), both in units of 1 / (src_size * dest_size) of the whole length.
+// Each source pixel is weighted by its overlap with the destination pixel.
+auto MaskScaler::CalculateAreaTaps(int src_size, int dest_size, int weight_total) -> Taps {
+    Taps taps;
+    taps.first.resize(static_cast<size_t>(dest_size));
+    taps.count.resize(static_cast<size_t>(dest_size));
+    taps.max_count = (src_size + dest_size - 1) / dest_size + 1;
+    taps.weights.resize(static_cast<size_t>(dest_size) * static_cast<size_t>(taps.max_count));
+
+    for (int i = 0; i < dest_size; i++) {
+        int64_t begin = static_cast<int64_t>(i) * src_size;
+        int64_t end = begin + src_size;
+        auto first = static_cast<int>(begin / dest_size);
+        auto last = static_cast<int>((end - 1) / dest_size);
+
+        int16_t* weights = &taps.weights[static_cast<size_t>(i) * taps.max_count];
+        int sum = 0;
+        int largest = 0;
+        for (int j = first; j <= last; j++) {
+            int64_t overlap = std::min(end, static_cast<int64_t>(j + 1) * dest_size) -
+                              std::max(begin, static_cast<int64_t>(j) * dest_size);
+            auto weight = static_cast<int16_t>(overlap * weight_total / src_size);
+            weights[j - first] = weight;
+            sum += weight;
+            if (weight > weights[largest]) {
+                largest = j - first;
+            }
+        }
+
+        // Compensate the rounding error, so that an opaque area stays opaque
+        weights[largest] = static_cast<int16_t>(weights[largest] + weight_total - sum);
+
+        taps.first[i] = first;
+        taps.count[i] = last - first + 1;
+    }
+
+    return taps;
+}
+
+#if (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)) && \
+    (defined(__SSE2__) || defined(_MSC_VER))
+
+// Rows are multiplied and added in pairs, by interleaving values and weights of both rows.
+// An odd row is paired with itself with a zero weight.
+static ALWAYS_INLINE __m128i WeightPair_SSE2(const int16_t* weights, int i, int count) {
+    uint32_t weight_b = i + 1 < count ? static_cast<uint16_t>(weights[i + 1]) : 0;
+    return _mm_set1_epi32(static_cast<int>(static_cast<uint16_t>(weights[i]) | (weight_b << 16)));
+}
+
+static ALWAYS_INLINE void MultiplyAddRowPair_SSE2(const int16_t* row_a, const int16_t* row_b, __m128i weight,
+                                                  __m128i& sum_lo, __m128i& sum_hi) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_a));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row_b));
+    sum_lo = _mm_add_epi32(sum_lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), weight));
+    sum_hi = _mm_add_epi32(sum_hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), weight));
+}
+
+static ALWAYS_INLINE void StoreScaledPixels_SSE2(uint8_t* dest, __m128i sum_lo, __m128i sum_hi) {
+    sum_lo = _mm_srai_epi32(sum_lo, kWeightShift);
+    sum_hi = _mm_srai_epi32(sum_hi, kWeightShift);
+    __m128i packed = _mm_packs_epi32(sum_lo, sum_hi);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dest), _mm_packus_epi16(packed, packed));
+}
+
+#endif
+
+void MaskScaler::ScaleRowVertically(const int16_t* const* rows, const int16_t* weights, int count,
+                                    uint8_t* dest, int width) {
+    int x = 0;
+
+#if (defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)) && \
+    (defined(__SSE2__) || defined(_MSC_VER))
+    const __m128i round = _mm_set1_epi32(1 << (kWeightShift - 1));
+
+    if (count <= 2) {
+        // Upscaling, at most two source rows contribute to a destination row
+        const int16_t* row_a = rows[0];
+        const int16_t* row_b = count == 2 ? rows[1] : rows[0];
+        const __m128i weight = WeightPair_SSE2(weights, 0, count);
+        for (; x + 8 <= width; x += 8) {
+            __m128i sum_lo = round;
+            __m128i sum_hi = round;
+            MultiplyAddRowPair_SSE2(row_a + x, row_b + x, weight, sum_lo, sum_hi);
+            StoreScaledPixels_SSE2(dest + x, sum_lo, sum_hi);
+        }
+    } else {
+        for (; x + 8 <= width; x += 8) {
+            __m128i sum_lo = round;
+            __m128i sum_hi = round;
+            for (int i = 0; i < count; i += 2) {
+                const int16_t* row_b = i + 1 < count ? rows[i + 1] : rows[i];
+                MultiplyAddRowPair_SSE2(rows[i] + x, row_b + x, WeightPair_SSE2(weights, i, count), sum_lo, sum_hi);
+            }
+            StoreScaledPixels_SSE2(dest + x, sum_lo, sum_hi);
+        }
+    }
+#endif
+
+    for (; x < width; x++) {
+        int sum = 1 << (kWeightShift - 1);
+        for (int i = 0; i < count; i++) {
+            sum += rows[i][x] * weights[i];
+        }
+        dest[x] = static_cast<uint8_t>(std::min(sum >> kWeightShift, 255));
+    }
+}
+
+}  // namespace aribcaption
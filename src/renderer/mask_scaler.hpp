@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_MASK_SCALER_HPP
+#define ARIBCAPTION_MASK_SCALER_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace aribcaption {
+
+// Scaler for 8-bit alpha masks, e.g. unpacked DRCS patterns
+class MaskScaler {
+public:
+    // Scale by picking the nearest source pixel, for compatibility with older releases
+    static void ScaleNearestNeighbor(const uint8_t* src, int src_width, int src_height,
+                                     uint8_t* dest, int dest_width, int dest_height);
+
+    // Scale by averaging the source area covered by each destination pixel (box filter).
+    // Works for both upscaling and downscaling, smoothing the edges of upscaled patterns.
+    static void ScaleAreaAveraging(const uint8_t* src, int src_width, int src_height,
+                                   uint8_t* dest, int dest_width, int dest_height);
+private:
+    // Contributions of source pixels to a destination pixel, weights sum to the requested total
+    struct Taps {
+        std::vector<int> first;        // Index of the first contributing source pixel, for each destination pixel
+        std::vector<int> count;        // Number of contributing source pixels, for each destination pixel
+        std::vector<int16_t> weights;  // max_count weights for each destination pixel, padded with zeros
+        int max_count = 0;
+    };
+
+    static Taps CalculateAreaTaps(int src_size, int dest_size, int weight_total);
+    template <int kTapCount>
+    static void ScaleRowHorizontally(const uint8_t* padded_src, const Taps& x_taps, int16_t* dest, int width);
+    static void ScaleRowVertically(const int16_t* const* rows, const int16_t* weights, int count,
+                                   uint8_t* dest, int width);
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_MASK_SCALER_HPP
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cassert>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "renderer/alphablend_generic.hpp"
+#include "renderer/palette_quantizer.hpp"
+
+namespace aribcaption {
+
+static ColorRGBA Premultiply(ColorRGBA color) {
+    return ColorRGBA(static_cast<uint8_t>(alphablend::Div255(color.r * color.a)),
+                     static_cast<uint8_t>(alphablend::Div255(color.g * color.a)),
+                     static_cast<uint8_t>(alphablend::Div255(color.b * color.a)),
+                     color.a);
+}
+
+static int AlignedStride(int bytes_per_line) {
+    int remainder = bytes_per_line % static_cast<int>(Image::kAlignedTo);
+    return remainder ? bytes_per_line + static_cast<int>(Image::kAlignedTo) - remainder : bytes_per_line;
+}
+
+std::vector<ColorRGBA> PaletteQuantizer::CollectActiveColors(const Caption& caption) {
+    std::vector<ColorRGBA> colors;
+
+    auto add_color = [&colors](ColorRGBA color) {
+        if (color.a == 0 || colors.size() >= kMaxActiveColors) {
+            return;
+        }
+        auto iter = std::find_if(colors.begin(), colors.end(), [&](ColorRGBA c) { return c.u32 == color.u32; });
+        if (iter == colors.end()) {
+            colors.push_back(color);
+        }
+    };
+
+    for (const CaptionRegion& region : caption.regions) {
+        for (const CaptionChar& ch : region.chars) {
+            add_color(ch.text_color);
+            add_color(ch.stroke_color);
+            add_color(ch.back_color);
+        }
+    }
+
+    return colors;
+}
+
+Image PaletteQuantizer::ExpandToRGBA(const Image& image) {
+    assert(image.pixel_format == PixelFormat::kPAL8);
+
+    Image expanded;
+    expanded.width = image.width;
+    expanded.height = image.height;
+    expanded.stride = AlignedStride(image.width * 4);
+    expanded.dst_x = image.dst_x;
+    expanded.dst_y = image.dst_y;
+    expanded.pixel_format = PixelFormat::kRGBA8888;
+
+    ImageBuffer::Storage storage(static_cast<size_t>(expanded.stride) * expanded.height, 0);  // Zero the padding
+    for (int y = 0; y < image.height; y++) {
+        const uint8_t* src = image.bitmap.data() + static_cast<size_t>(y) * image.stride;
+        auto dest = reinterpret_cast<ColorRGBA*>(storage.data() + static_cast<size_t>(y) * expanded.stride);
+        for (int x = 0; x < image.width; x++) {
+            dest[x] = src[x] < image.palette.size() ? image.palette[src[x]] : ColorRGBA();
+        }
+    }
+
+    expanded.bitmap = ImageBuffer(std::move(storage));
+    return expanded;
+}
+
+PaletteQuantizer::PaletteQuantizer(const std::vector<ColorRGBA>& active_colors) {
+    size_t color_count = std::min(active_colors.size(), kMaxActiveColors);
+
+    // Index 0 is always transparent
+    AddPaletteEntry(ColorRGBA());
+
+    for (size_t i = 0; i < color_count; i++) {
+        AddPaletteEntry(active_colors[i]);
+    }
+
+    if (color_count == 0) {
+        return;
+    }
+
+    // Antialiased edges: each color drawn over another color (or transparent) at partial coverage
+    // Coverage levels are reduced with more active colors to fit into 256 entries
+    size_t pair_count = color_count * color_count;
+    size_t levels = std::min<size_t>(15, (kMaxPaletteSize - 1 - color_count) / pair_count);
+
+    for (size_t fg = 0; fg < color_count; fg++) {
+        for (size_t bg = 0; bg <= color_count; bg++) {
+            if (bg == fg) {
+                continue;
+            }
+            // bg == color_count stands for transparent
+            ColorRGBA bg_color = bg < color_count ? active_colors[bg] : ColorRGBA();
+            ColorRGBA fg_color = active_colors[fg];
+
+            for (size_t level = 1; level <= levels; level++) {
+                auto alpha = static_cast<uint8_t>(fg_color.a * level / (levels + 1));
+                AddPaletteEntry(alphablend::BlendColor(bg_color, ColorRGBA(fg_color, alpha)));
+            }
+        }
+    }
+}
+
+void PaletteQuantizer::AddPaletteEntry(ColorRGBA color) {
+    if (palette_.size() >= kMaxPaletteSize) {
+        return;
+    }
+    for (ColorRGBA entry : palette_) {
+        if (entry.u32 == color.u32) {
+            return;
+        }
+    }
+    palette_.push_back(color);
+    premultiplied_palette_.push_back(Premultiply(color));
+}
+
+uint8_t PaletteQuantizer::FindNearestIndex(ColorRGBA color) const {
+    // Compare in premultiplied space, so that the color of (nearly) transparent pixels matters less
+    ColorRGBA target = Premultiply(color);
+
+    uint32_t best_distance = std::numeric_limits<uint32_t>::max();
+    size_t best_index = 0;
+
+    for (size_t i = 0; i < premultiplied_palette_.size(); i++) {
+        ColorRGBA entry = premultiplied_palette_[i];
+        int dr = entry.r - target.r;
+        int dg = entry.g - target.g;
+        int db = entry.b - target.b;
+        int da = entry.a - target.a;
+        auto distance = static_cast<uint32_t>(dr * dr + dg * dg + db * db + da * da);
+        if (distance < best_distance) {
+            best_distance = distance;
+            best_index = i;
+            if (distance == 0) {
+                break;
+            }
+        }
+    }
+
+    return static_cast<uint8_t>(best_index);
+}
+
+Image PaletteQuantizer::Quantize(const Image& image, BitmapPool* bitmap_pool) {
+    assert(image.pixel_format == PixelFormat::kRGBA8888);
+
+    Image quantized;
+    quantized.width = image.width;
+    quantized.height = image.height;
+    quantized.stride = AlignedStride(image.width);
+    quantized.dst_x = image.dst_x;
+    quantized.dst_y = image.dst_y;
+    quantized.pixel_format = PixelFormat::kPAL8;
+    quantized.palette = palette_;
+
+    // Every row is fully overwritten below, including the padding
+    size_t size = static_cast<size_t>(quantized.stride) * quantized.height;
+    ImageBuffer::Storage storage = bitmap_pool ? bitmap_pool->Acquire(size, false) : ImageBuffer::Storage(size);
+    for (int y = 0; y < image.height; y++) {
+        auto src = reinterpret_cast<const ColorRGBA*>(image.bitmap.data() + static_cast<size_t>(y) * image.stride);
+        uint8_t* dest = storage.data() + static_cast<size_t>(y) * quantized.stride;
+        memset(dest + image.width, 0, static_cast<size_t>(quantized.stride - image.width));
+
+        for (int x = 0; x < image.width; x++) {
+            uint32_t color = src[x].u32;
+            LookupCacheEntry& entry = lookup_cache_[(color * 2654435761u) >> 20];
+            if (!entry.valid || entry.color != color) {
+                entry.color = color;
+                entry.index = FindNearestIndex(src[x]);
+                entry.valid = true;
+            }
+            dest[x] = entry.index;
+        }
+    }
+
+    quantized.bitmap = bitmap_pool ? bitmap_pool->Share(std::move(storage)) : ImageBuffer(std::move(storage));
+    return quantized;
+}
+
+}  // namespace aribcaption
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_PALETTE_QUANTIZER_HPP
+#define ARIBCAPTION_PALETTE_QUANTIZER_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "aribcaption/caption.hpp"
+#include "aribcaption/color.hpp"
+#include "aribcaption/image.hpp"
+#include "renderer/bitmap_pool.hpp"
+
+namespace aribcaption {
+
+// Converts RGBA images into 8-bit palette indexed (PAL8) images.
+//
+// ARIB captions only use a handful of colors from the 128-entry CLUT at a time. The palette consists of
+// the active colors of a caption, plus blends of every active color over the other ones (and over transparent)
+// at several coverage levels, so that antialiased edges are kept reasonably smooth.
+class PaletteQuantizer {
+public:
+    static constexpr size_t kMaxPaletteSize = 256;
+    static constexpr size_t kMaxActiveColors = 15;
+public:
+    // Collect colors used by text, stroke and background of the caption
+    static std::vector<ColorRGBA> CollectActiveColors(const Caption& caption);
+
+    // Convert a kPAL8 image back to kRGBA8888
+    static Image ExpandToRGBA(const Image& image);
+public:
+    explicit PaletteQuantizer(const std::vector<ColorRGBA>& active_colors);
+    ~PaletteQuantizer() = default;
+public:
+    [[nodiscard]]
+    const std::vector<ColorRGBA>& palette() const { return palette_; }
+
+    // Convert a kRGBA8888 image into kPAL8, mapping every pixel to the nearest palette entry.
+    // Pixels are allocated from bitmap_pool if provided.
+    Image Quantize(const Image& image, BitmapPool* bitmap_pool = nullptr);
+public:
+    // Disallow copy and assign
+    PaletteQuantizer(const PaletteQuantizer&) = delete;
+    PaletteQuantizer& operator=(const PaletteQuantizer&) = delete;
+private:
+    void AddPaletteEntry(ColorRGBA color);
+    uint8_t FindNearestIndex(ColorRGBA color) const;
+private:
+    std::vector<ColorRGBA> palette_;
+    std::vector<ColorRGBA> premultiplied_palette_;
+
+    // Direct-mapped cache of pixel value => palette index, pixels of captions are highly repetitive
+    static constexpr size_t kLookupCacheSize = 4096;
+    struct LookupCacheEntry {
+        uint32_t color = 0;
+        uint8_t index = 0;
+        bool valid = false;
+    };
+    std::array<LookupCacheEntry, kLookupCacheSize> lookup_cache_{};
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_PALETTE_QUANTIZER_HPP
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "aribcaption/pgs_encoder.hpp"
+#include "renderer/pgs_encoder_impl.hpp"
+
+namespace aribcaption {
+
+PGSEncoder::PGSEncoder(Context& context) : pimpl_(std::make_unique<internal::PGSEncoderImpl>(context)) {}
+
+PGSEncoder::~PGSEncoder() = default;
+
+PGSEncoder::PGSEncoder(PGSEncoder&&) noexcept = default;
+
+PGSEncoder& PGSEncoder::operator=(PGSEncoder&&) noexcept = default;
+
+bool PGSEncoder::SetFrameSize(int frame_width, int frame_height) {
+    return pimpl_->SetFrameSize(frame_width, frame_height);
+}
+
+void PGSEncoder::SetColorSpace(FrameColorSpace color_space) {
+    pimpl_->SetColorSpace(color_space);
+}
+
+bool PGSEncoder::Encode(int64_t pts, RenderStatus status, const RenderResult& result, std::vector<uint8_t>& out_data) {
+    std::vector<internal::PGSEncoderImpl::ImageView> images;
+    images.reserve(result.images.size());
+
+    for (const Image& image : result.images) {
+        internal::PGSEncoderImpl::ImageView view;
+        view.width = image.width;
+        view.height = image.height;
+        view.stride = image.stride;
+        view.dst_x = image.dst_x;
+        view.dst_y = image.dst_y;
+        view.pixel_format = image.pixel_format;
+        view.bitmap = image.bitmap.data();
+        view.palette = image.palette.data();
+        view.palette_size = image.palette.size();
+        images.push_back(view);
+    }
+
+    return pimpl_->Encode(pts, status, result.pts, result.duration, images, out_data);
+}
+
+void PGSEncoder::Flush(std::vector<uint8_t>& out_data) {
+    pimpl_->Flush(out_data);
+}
+
+}  // namespace aribcaption
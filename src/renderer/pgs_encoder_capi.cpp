@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <new>
+#include <vector>
+#include "aribcaption/context.hpp"
+#include "aribcaption/pgs_encoder.h"
+#include "renderer/pgs_encoder_impl.hpp"
+
+using namespace aribcaption;
+using namespace aribcaption::internal;
+
+struct PGSEncoderCAPI {
+    explicit PGSEncoderCAPI(Context& context) : impl(context) {}
+
+    PGSEncoderImpl impl;
+    std::vector<uint8_t> buffer;  // Holds the encoded segments returned from the last call
+};
+
+static void WriteBackBuffer(const std::vector<uint8_t>& buffer, const uint8_t** out_data, size_t* out_size) {
+    if (out_data) {
+        *out_data = buffer.empty() ? nullptr : buffer.data();
+    }
+    if (out_size) {
+        *out_size = buffer.size();
+    }
+}
+
+extern "C" {
+
+aribcc_pgs_encoder_t* aribcc_pgs_encoder_alloc(aribcc_context_t* context) {
+    auto ctx = reinterpret_cast<Context*>(context);
+    auto encoder = new(std::nothrow) PGSEncoderCAPI(*ctx);
+    return reinterpret_cast<aribcc_pgs_encoder_t*>(encoder);
+}
+
+void aribcc_pgs_encoder_free(aribcc_pgs_encoder_t* encoder) {
+    auto capi = reinterpret_cast<PGSEncoderCAPI*>(encoder);
+    delete capi;
+}
+
+bool aribcc_pgs_encoder_set_frame_size(aribcc_pgs_encoder_t* encoder, int frame_width, int frame_height) {
+    auto capi = reinterpret_cast<PGSEncoderCAPI*>(encoder);
+    return capi->impl.SetFrameSize(frame_width, frame_height);
+}
+
+void aribcc_pgs_encoder_set_color_space(aribcc_pgs_encoder_t* encoder, aribcc_frame_colorspace_t color_space) {
+    auto capi = reinterpret_cast<PGSEncoderCAPI*>(encoder);
+    capi->impl.SetColorSpace(static_cast<FrameColorSpace>(color_space));
+}
+
+bool aribcc_pgs_encoder_encode(aribcc_pgs_encoder_t* encoder,
+                               int64_t pts,
+                               aribcc_render_status_t status,
+                               const aribcc_render_result_t* result,
+                               const uint32_t* palette,
+                               size_t palette_size,
+                               const uint8_t** out_data,
+                               size_t* out_size) {
+    auto capi = reinterpret_cast<PGSEncoderCAPI*>(encoder);
+
+    std::vector<PGSEncoderImpl::ImageView> images;
+    int64_t caption_pts = pts;
+    int64_t caption_duration = 0;
+
+    if (result) {
+        caption_pts = result->pts;
+        caption_duration = result->duration;
+
+        images.reserve(result->image_count);
+        for (uint32_t i = 0; i < result->image_count; i++) {
+            const aribcc_image_t& image = result->images[i];
+            PGSEncoderImpl::ImageView view;
+            view.width = image.width;
+            view.height = image.height;
+            view.stride = image.stride;
+            view.dst_x = image.dst_x;
+            view.dst_y = image.dst_y;
+            view.pixel_format = static_cast<PixelFormat>(image.pixel_format);
+            view.bitmap = image.bitmap;
+            view.palette = reinterpret_cast<const ColorRGBA*>(palette);
+            view.palette_size = palette_size;
+            images.push_back(view);
+        }
+    }
+
+    capi->buffer.clear();
+    bool ret = capi->impl.Encode(pts, static_cast<RenderStatus>(status), caption_pts, caption_duration,
+                                 images, capi->buffer);
+    WriteBackBuffer(capi->buffer, out_data, out_size);
+    return ret;
+}
+
+void aribcc_pgs_encoder_flush(aribcc_pgs_encoder_t* encoder, const uint8_t** out_data, size_t* out_size) {
+    auto capi = reinterpret_cast<PGSEncoderCAPI*>(encoder);
+    capi->buffer.clear();
+    capi->impl.Flush(capi->buffer);
+    WriteBackBuffer(capi->buffer, out_data, out_size);
+}
+
+}  // extern "C"
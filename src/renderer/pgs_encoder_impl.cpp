@@ -0,0 +1,362 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "renderer/pgs_encoder_impl.hpp"
+
+namespace aribcaption::internal {
+
+// PGS limitations, see "Presentation Graphic Stream" of the Blu-ray Disc format specification
+static constexpr int kMaxObjectSize = 4096;
+static constexpr size_t kMaxSegmentPayloadSize = 0xFFFF;
+static constexpr size_t kSegmentHeaderSize = 13;
+static constexpr int kMaxRunLength = 0x3FFF;
+
+static void WriteU8(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void WriteU16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+static void WriteU24(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    WriteU16(out, value);
+}
+
+static void WriteU32(std::vector<uint8_t>& out, uint32_t value) {
+    WriteU16(out, value >> 16);
+    WriteU16(out, value);
+}
+
+PGSEncoderImpl::PGSEncoderImpl(Context& context) : context_(context), log_(GetContextLogger(context)) {}
+
+PGSEncoderImpl::~PGSEncoderImpl() = default;
+
+bool PGSEncoderImpl::SetFrameSize(int frame_width, int frame_height) {
+    if (frame_width <= 0 || frame_height <= 0 || frame_width > 0xFFFF || frame_height > 0xFFFF) {
+        log_->e("PGSEncoder: Invalid frame size: %dx%d", frame_width, frame_height);
+        return false;
+    }
+
+    frame_width_ = frame_width;
+    frame_height_ = frame_height;
+    return true;
+}
+
+void PGSEncoderImpl::SetColorSpace(FrameColorSpace color_space) {
+    color_space_ = color_space;
+}
+
+bool PGSEncoderImpl::Encode(int64_t pts, RenderStatus status, int64_t caption_pts, int64_t caption_duration,
+                            const std::vector<ImageView>& images, std::vector<uint8_t>& out_data) {
+    if (frame_width_ <= 0 || frame_height_ <= 0) {
+        log_->e("PGSEncoder: Frame size must be indicated first");
+        return false;
+    }
+
+    if (status == RenderStatus::kGotImageUnchanged) {
+        return true;
+    }
+
+    // Clear the displaying caption, if it has been timed out, or it's removed / replaced at this PTS
+    if (displaying_) {
+        if (end_pts_ != PTS_NOPTS && end_pts_ <= pts) {
+            WriteClearDisplaySet(end_pts_, out_data);
+        } else if (status != RenderStatus::kGotImage || images.empty()) {
+            WriteClearDisplaySet(pts, out_data);
+        }
+    }
+
+    if (status != RenderStatus::kGotImage || images.empty()) {
+        return status != RenderStatus::kError;
+    }
+
+    // The new display set replaces the displaying one, there's no need to clear it explicitly
+    // Display sets must be in presentation order
+    int64_t display_pts = std::max(caption_pts, last_display_set_pts_);
+    if (!WriteDisplaySet(display_pts, images, out_data)) {
+        return false;
+    }
+
+    if (caption_duration == DURATION_INDEFINITE) {
+        end_pts_ = PTS_NOPTS;
+    } else {
+        end_pts_ = display_pts + caption_duration;
+    }
+
+    return true;
+}
+
+void PGSEncoderImpl::Flush(std::vector<uint8_t>& out_data) {
+    if (displaying_ && end_pts_ != PTS_NOPTS) {
+        WriteClearDisplaySet(end_pts_, out_data);
+    }
+}
+
+bool PGSEncoderImpl::WriteDisplaySet(int64_t pts, const std::vector<ImageView>& images,
+                                     std::vector<uint8_t>& out_data) {
+    const ImageView& first = images[0];
+
+    // Images of a caption are composed into a single object, within the bounding rect
+    Rect rect(first.dst_x, first.dst_y, first.dst_x + first.width, first.dst_y + first.height);
+    for (const ImageView& image : images) {
+        if (image.pixel_format != PixelFormat::kPAL8 || !image.bitmap || !image.palette) {
+            log_->e("PGSEncoder: Images must be in PixelFormat::kPAL8");
+            return false;
+        }
+        if (image.palette_size != first.palette_size ||
+                memcmp(image.palette, first.palette, first.palette_size * sizeof(ColorRGBA)) != 0) {
+            log_->e("PGSEncoder: Images of a caption must share the same palette");
+            return false;
+        }
+        rect.Include(image.dst_x, image.dst_y);
+        rect.Include(image.dst_x + image.width - 1, image.dst_y + image.height - 1);
+    }
+
+    rect = Rect::ClipRect(Rect(0, 0, frame_width_, frame_height_), rect);
+    if (rect.width() <= 0 || rect.height() <= 0) {
+        // Nothing visible within the frame
+        if (displaying_) {
+            WriteClearDisplaySet(pts, out_data);
+        }
+        return true;
+    }
+    if (rect.width() > kMaxObjectSize || rect.height() > kMaxObjectSize) {
+        log_->e("PGSEncoder: Object size %dx%d exceeds PGS limitation", rect.width(), rect.height());
+        return false;
+    }
+
+    // Run-length encode the object row by row, directly from the rendered rows if possible
+    rle_data_.clear();
+    bool compose = images.size() > 1 || rect != Rect(first.dst_x, first.dst_y,
+                                                     first.dst_x + first.width, first.dst_y + first.height);
+    for (int y = rect.top; y < rect.bottom; y++) {
+        if (!compose) {
+            EncodeRLELine(first.bitmap + static_cast<size_t>(y - first.dst_y) * first.stride, rect.width(), rle_data_);
+            continue;
+        }
+
+        // Index 0 is transparent in palettes generated by the renderer
+        row_indices_.assign(static_cast<size_t>(rect.width()), 0);
+        for (const ImageView& image : images) {
+            if (y < image.dst_y || y >= image.dst_y + image.height) {
+                continue;
+            }
+            int left = std::max(image.dst_x, rect.left);
+            int right = std::min(image.dst_x + image.width, rect.right);
+            const uint8_t* src = image.bitmap + static_cast<size_t>(y - image.dst_y) * image.stride;
+            for (int x = left; x < right; x++) {
+                if (uint8_t index = src[x - image.dst_x]) {
+                    row_indices_[x - rect.left] = index;
+                }
+            }
+        }
+        EncodeRLELine(row_indices_.data(), rect.width(), rle_data_);
+    }
+
+    uint32_t pts90k = ToPTS90K(pts);
+    window_rect_ = rect;
+    last_display_set_pts_ = pts;
+
+    WriteCompositionSegment(pts90k, true, rect, out_data);
+    WriteWindowSegment(pts90k, rect, out_data);
+    WritePaletteSegment(pts90k, first, out_data);
+    WriteObjectSegments(pts90k, rect.width(), rect.height(), out_data);
+    BeginSegment(pts90k, kSegmentTypeEND, out_data);
+    EndSegment(out_data);
+
+    displaying_ = true;
+    return true;
+}
+
+void PGSEncoderImpl::WriteClearDisplaySet(int64_t pts, std::vector<uint8_t>& out_data) {
+    uint32_t pts90k = ToPTS90K(pts);
+    last_display_set_pts_ = pts;
+
+    WriteCompositionSegment(pts90k, false, std::nullopt, out_data);
+    WriteWindowSegment(pts90k, window_rect_, out_data);
+    BeginSegment(pts90k, kSegmentTypeEND, out_data);
+    EndSegment(out_data);
+
+    displaying_ = false;
+    end_pts_ = PTS_NOPTS;
+}
+
+void PGSEncoderImpl::WriteCompositionSegment(uint32_t pts90k, bool epoch_start, std::optional<Rect> object_rect,
+                                             std::vector<uint8_t>& out_data) {
+    BeginSegment(pts90k, kSegmentTypePCS, out_data);
+    WriteU16(out_data, static_cast<uint32_t>(frame_width_));
+    WriteU16(out_data, static_cast<uint32_t>(frame_height_));
+    WriteU8(out_data, 0x10);                              // frame_rate, ignored by players
+    WriteU16(out_data, composition_number_++);
+    WriteU8(out_data, epoch_start ? 0x80 : 0x00);         // composition_state: Epoch Start / Normal
+    WriteU8(out_data, 0x00);                              // palette_update_flag
+    WriteU8(out_data, 0x00);                              // palette_id
+    WriteU8(out_data, object_rect ? 1 : 0);               // number_of_composition_objects
+    if (object_rect) {
+        WriteU16(out_data, 0);                            // object_id
+        WriteU8(out_data, 0);                             // window_id
+        WriteU8(out_data, 0x00);                          // object_cropped_flag
+        WriteU16(out_data, static_cast<uint32_t>(object_rect->left));
+        WriteU16(out_data, static_cast<uint32_t>(object_rect->top));
+    }
+    EndSegment(out_data);
+}
+
+void PGSEncoderImpl::WriteWindowSegment(uint32_t pts90k, const Rect& window_rect, std::vector<uint8_t>& out_data) {
+    BeginSegment(pts90k, kSegmentTypeWDS, out_data);
+    WriteU8(out_data, 1);                                 // number_of_windows
+    WriteU8(out_data, 0);                                 // window_id
+    WriteU16(out_data, static_cast<uint32_t>(window_rect.left));
+    WriteU16(out_data, static_cast<uint32_t>(window_rect.top));
+    WriteU16(out_data, static_cast<uint32_t>(window_rect.width()));
+    WriteU16(out_data, static_cast<uint32_t>(window_rect.height()));
+    EndSegment(out_data);
+}
+
+void PGSEncoderImpl::WritePaletteSegment(uint32_t pts90k, const ImageView& image, std::vector<uint8_t>& out_data) {
+    FrameColorSpace color_space = color_space_.value_or(frame_height_ >= 720 ? FrameColorSpace::kBT709
+                                                                              : FrameColorSpace::kBT601);
+    double kr = color_space == FrameColorSpace::kBT709 ? 0.2126 : 0.299;
+    double kb = color_space == FrameColorSpace::kBT709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+
+    auto clamp = [](double value) {
+        return static_cast<uint32_t>(std::clamp(std::lround(value), 0L, 255L));
+    };
+
+    BeginSegment(pts90k, kSegmentTypePDS, out_data);
+    WriteU8(out_data, 0x00);                              // palette_id
+    WriteU8(out_data, 0x00);                              // palette_version_number
+    for (size_t i = 0; i < image.palette_size && i < 256; i++) {
+        ColorRGBA color = image.palette[i];
+        double y = kr * color.r + kg * color.g + kb * color.b;
+        double cb = (color.b - y) / (2.0 * (1.0 - kb));
+        double cr = (color.r - y) / (2.0 * (1.0 - kr));
+
+        // Limited range YCbCr
+        WriteU8(out_data, static_cast<uint32_t>(i));
+        WriteU8(out_data, clamp(16.0 + y * 219.0 / 255.0));
+        WriteU8(out_data, clamp(128.0 + cr * 224.0 / 255.0));
+        WriteU8(out_data, clamp(128.0 + cb * 224.0 / 255.0));
+        WriteU8(out_data, color.a);
+    }
+    EndSegment(out_data);
+}
+
+void PGSEncoderImpl::WriteObjectSegments(uint32_t pts90k, int width, int height, std::vector<uint8_t>& out_data) {
+    // object_data_length covers width, height and the RLE data
+    size_t object_data_length = rle_data_.size() + 4;
+
+    // Object data larger than a segment is fragmented into several ODS
+    size_t offset = 0;
+    bool first = true;
+    while (first || offset < rle_data_.size()) {
+        size_t header_size = first ? 4 + 3 + 4 : 4;
+        size_t chunk_size = std::min(rle_data_.size() - offset, kMaxSegmentPayloadSize - header_size);
+        bool last = offset + chunk_size >= rle_data_.size();
+
+        BeginSegment(pts90k, kSegmentTypeODS, out_data);
+        WriteU16(out_data, 0);                            // object_id
+        WriteU8(out_data, 0);                             // object_version_number
+        WriteU8(out_data, (first ? 0x80 : 0x00) | (last ? 0x40 : 0x00));  // last_in_sequence_flag
+        if (first) {
+            WriteU24(out_data, static_cast<uint32_t>(object_data_length));
+            WriteU16(out_data, static_cast<uint32_t>(width));
+            WriteU16(out_data, static_cast<uint32_t>(height));
+        }
+        out_data.insert(out_data.end(), rle_data_.begin() + static_cast<ptrdiff_t>(offset),
+                        rle_data_.begin() + static_cast<ptrdiff_t>(offset + chunk_size));
+        EndSegment(out_data);
+
+        offset += chunk_size;
+        first = false;
+    }
+}
+
+void PGSEncoderImpl::BeginSegment(uint32_t pts90k, SegmentType type, std::vector<uint8_t>& out_data) {
+    segment_begin_ = out_data.size();
+    out_data.push_back('P');
+    out_data.push_back('G');
+    WriteU32(out_data, pts90k);                           // PTS
+    WriteU32(out_data, 0);                                // DTS
+    WriteU8(out_data, type);
+    WriteU16(out_data, 0);                                // segment_length, filled in EndSegment()
+}
+
+void PGSEncoderImpl::EndSegment(std::vector<uint8_t>& out_data) {
+    size_t length = out_data.size() - segment_begin_ - kSegmentHeaderSize;
+    out_data[segment_begin_ + kSegmentHeaderSize - 2] = static_cast<uint8_t>(length >> 8);
+    out_data[segment_begin_ + kSegmentHeaderSize - 1] = static_cast<uint8_t>(length);
+}
+
+// Run-length encoding of a line
+//   CCCCCCCC                                 1 pixel in color C (C != 0)
+//   00000000 00LLLLLL                        L pixels in color 0 (L: 1-63)
+//   00000000 01LLLLLL LLLLLLLL               L pixels in color 0 (L: 64-16383)
+//   00000000 10LLLLLL CCCCCCCC               L pixels in color C (L: 3-63)
+//   00000000 11LLLLLL LLLLLLLL CCCCCCCC      L pixels in color C (L: 64-16383)
+//   00000000 00000000                        End of line
+void PGSEncoderImpl::EncodeRLELine(const uint8_t* indices, int width, std::vector<uint8_t>& out) {
+    int x = 0;
+    while (x < width) {
+        uint8_t color = indices[x];
+        int run = 1;
+        while (x + run < width && run < kMaxRunLength && indices[x + run] == color) {
+            run++;
+        }
+
+        if (color == 0) {
+            out.push_back(0x00);
+            if (run < 64) {
+                out.push_back(static_cast<uint8_t>(run));
+            } else {
+                out.push_back(static_cast<uint8_t>(0x40 | (run >> 8)));
+                out.push_back(static_cast<uint8_t>(run));
+            }
+        } else if (run < 3) {
+            out.insert(out.end(), static_cast<size_t>(run), color);
+        } else if (run < 64) {
+            out.push_back(0x00);
+            out.push_back(static_cast<uint8_t>(0x80 | run));
+            out.push_back(color);
+        } else {
+            out.push_back(0x00);
+            out.push_back(static_cast<uint8_t>(0xC0 | (run >> 8)));
+            out.push_back(static_cast<uint8_t>(run));
+            out.push_back(color);
+        }
+
+        x += run;
+    }
+
+    out.push_back(0x00);
+    out.push_back(0x00);
+}
+
+uint32_t PGSEncoderImpl::ToPTS90K(int64_t pts_ms) {
+    // 32-bit timestamp in 90kHz, wraps around
+    return static_cast<uint32_t>(static_cast<uint64_t>(pts_ms) * 90);
+}
+
+}  // namespace aribcaption::internal
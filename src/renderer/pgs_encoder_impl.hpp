@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_PGS_ENCODER_IMPL_HPP
+#define ARIBCAPTION_PGS_ENCODER_IMPL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+#include "aribcaption/color.hpp"
+#include "aribcaption/context.hpp"
+#include "aribcaption/image.hpp"
+#include "aribcaption/renderer.hpp"
+#include "base/logger.hpp"
+#include "renderer/rect.hpp"
+
+namespace aribcaption::internal {
+
+class PGSEncoderImpl {
+public:
+    // Non-owning view of a rendered image, for sharing the encoder between C++ and C API
+    struct ImageView {
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+        int dst_x = 0;
+        int dst_y = 0;
+        PixelFormat pixel_format = PixelFormat::kDefault;
+        const uint8_t* bitmap = nullptr;
+        const ColorRGBA* palette = nullptr;
+        size_t palette_size = 0;
+    };
+public:
+    explicit PGSEncoderImpl(Context& context);
+    ~PGSEncoderImpl();
+public:
+    bool SetFrameSize(int frame_width, int frame_height);
+    void SetColorSpace(FrameColorSpace color_space);
+
+    bool Encode(int64_t pts, RenderStatus status, int64_t caption_pts, int64_t caption_duration,
+                const std::vector<ImageView>& images, std::vector<uint8_t>& out_data);
+    void Flush(std::vector<uint8_t>& out_data);
+private:
+    enum SegmentType : uint8_t {
+        kSegmentTypePDS = 0x14,
+        kSegmentTypeODS = 0x15,
+        kSegmentTypePCS = 0x16,
+        kSegmentTypeWDS = 0x17,
+        kSegmentTypeEND = 0x80,
+    };
+private:
+    bool WriteDisplaySet(int64_t pts, const std::vector<ImageView>& images, std::vector<uint8_t>& out_data);
+    void WriteClearDisplaySet(int64_t pts, std::vector<uint8_t>& out_data);
+    void WriteCompositionSegment(uint32_t pts90k, bool epoch_start, std::optional<Rect> object_rect,
+                                 std::vector<uint8_t>& out_data);
+    void WriteWindowSegment(uint32_t pts90k, const Rect& window_rect, std::vector<uint8_t>& out_data);
+    void WritePaletteSegment(uint32_t pts90k, const ImageView& image, std::vector<uint8_t>& out_data);
+    void WriteObjectSegments(uint32_t pts90k, int width, int height, std::vector<uint8_t>& out_data);
+    void BeginSegment(uint32_t pts90k, SegmentType type, std::vector<uint8_t>& out_data);
+    void EndSegment(std::vector<uint8_t>& out_data);
+
+    static void EncodeRLELine(const uint8_t* indices, int width, std::vector<uint8_t>& out);
+    static uint32_t ToPTS90K(int64_t pts_ms);
+public:
+    PGSEncoderImpl(const PGSEncoderImpl&) = delete;
+    PGSEncoderImpl& operator=(const PGSEncoderImpl&) = delete;
+private:
+    Context& context_;
+    std::shared_ptr<Logger> log_;
+
+    int frame_width_ = 0;
+    int frame_height_ = 0;
+    std::optional<FrameColorSpace> color_space_;
+
+    uint16_t composition_number_ = 0;
+
+    // Displaying caption, cleared at end_pts_ if known
+    bool displaying_ = false;
+    int64_t end_pts_ = PTS_NOPTS;
+    Rect window_rect_;
+    int64_t last_display_set_pts_ = PTS_NOPTS;
+
+    size_t segment_begin_ = 0;
+    std::vector<uint8_t> row_indices_;  // A composed row of the object, if composed from multiple images
+    std::vector<uint8_t> rle_data_;     // RLE compressed object data of the current display set
+};
+
+}  // namespace aribcaption::internal
+
+#endif  // ARIBCAPTION_PGS_ENCODER_IMPL_HPP
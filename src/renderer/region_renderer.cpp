@@ -17,6 +17,7 @@
  */
 
 #include <cassert>
+#include <utility>
 #include "renderer/bitmap.hpp"
 #include "renderer/canvas.hpp"
 #include "renderer/region_renderer.hpp"
@@ -25,8 +26,10 @@ namespace aribcaption {
 
 RegionRenderer::RegionRenderer(Context& context) : context_(context), log_(GetContextLogger(context)) {}
 
-bool RegionRenderer::Initialize(FontProviderType font_provider_type, TextRendererType text_renderer_type) {
-    font_provider_ = FontProvider::Create(font_provider_type, context_);
+bool RegionRenderer::Initialize(FontProviderType font_provider_type,
+                                TextRendererType text_renderer_type,
+                                std::shared_ptr<const FontIndex> font_index) {
+    font_provider_ = FontProvider::Create(font_provider_type, context_, std::move(font_index));
     if (!font_provider_->Initialize()) {
         return false;
     }
@@ -85,6 +88,10 @@ void RegionRenderer::SetReplaceDRCS(bool replace) {
     replace_drcs_ = replace;
 }
 
+void RegionRenderer::SetDRCSScaleMode(DRCSScaleMode mode) {
+    drcs_renderer_.SetScaleMode(mode);
+}
+
 void RegionRenderer::SetForceStrokeText(bool force_stroke) {
     force_stroke_text_ = force_stroke;
 }
@@ -93,32 +100,104 @@ void RegionRenderer::SetForceNoBackground(bool force_no_background) {
     force_no_background_ = force_no_background;
 }
 
+void RegionRenderer::SetCropToContent(bool crop) {
+    crop_to_content_ = crop;
+}
+
 void RegionRenderer::SetReplaceMSZHalfWidthGlyph(bool replace) {
     assert(text_renderer_);
     text_renderer_->SetReplaceMSZHalfWidthGlyph(replace);
 }
 
+void RegionRenderer::SetBitmapPool(std::shared_ptr<BitmapPool> pool) {
+    bitmap_pool_ = std::move(pool);
+}
+
+void RegionRenderer::AccumulateMemoryUsage(RendererMemoryUsage& usage) const {
+    if (text_renderer_) {
+        text_renderer_->AccumulateMemoryUsage(usage);
+    }
+    usage.glyph_caches += drcs_renderer_.cached_size();
+}
+
+size_t RegionRenderer::TrimCaches(size_t bytes) {
+    size_t freed = text_renderer_ ? text_renderer_->TrimCaches(bytes) : 0;
+    if (freed < bytes) {
+        freed += drcs_renderer_.TrimCache(bytes - freed);
+    }
+    return freed;
+}
+
 auto RegionRenderer::RenderCaptionRegion(const CaptionRegion& region,
                                          const std::unordered_map<uint32_t, DRCS>& drcs_map)
                                          -> Result<Image, RegionRenderError> {
     assert(text_renderer_ && plane_inited_ && caption_area_inited_);
 
+    std::optional<Rect> rect = CalculateRegionRect(region);
+    if (!rect) {
+        return Err(RegionRenderError::kImageTooSmall);
+    }
+
+    Bitmap bitmap(rect->width(), rect->height(), PixelFormat::kRGBA8888, bitmap_pool_);
+    if (std::optional<RegionRenderError> error = DrawCaptionRegion(region, drcs_map, bitmap)) {
+        return Err(error.value());
+    }
+
+    return ToRegionImage(std::move(bitmap), rect->left, rect->top);
+}
+
+auto RegionRenderer::ToRegionImage(Bitmap&& bitmap, int x, int y) const -> Result<Image, RegionRenderError> {
+    Rect crop_rect = bitmap.GetRect();
+    if (crop_to_content_) {
+        if (!bitmap.drawn_rect()) {
+            return Err(RegionRenderError::kImageTooSmall);  // Nothing visible
+        }
+        crop_rect = bitmap.drawn_rect().value();
+    }
+
+    Image image = crop_rect == bitmap.GetRect() ? Bitmap::ToImage(std::move(bitmap))
+                                                : Bitmap::ToImage(Bitmap::Crop(bitmap, crop_rect));
+    image.dst_x = x + crop_rect.left;
+    image.dst_y = y + crop_rect.top;
+
+    return Ok(std::move(image));
+}
+
+auto RegionRenderer::CalculateRegionRect(const CaptionRegion& region) const -> std::optional<Rect> {
+    int width = ScaleWidth(region.width, region.x);
+    int height = ScaleHeight(region.height, region.y);
+    if (width < 3 || height < 3) {
+        return std::nullopt;
+    }
+
+    int x = caption_area_start_x_ + ScaleX(region.x);
+    int y = caption_area_start_y_ + ScaleY(region.y);
+    return Rect(x, y, x + width, y + height);
+}
+
+auto RegionRenderer::DrawCaptionRegion(const CaptionRegion& region,
+                                       const std::unordered_map<uint32_t, DRCS>& drcs_map,
+                                       Bitmap& bitmap,
+                                       bool blend_background) -> std::optional<RegionRenderError> {
+    assert(text_renderer_ && plane_inited_ && caption_area_inited_);
+
     size_t char_count = region.chars.size();
     size_t succeed = 0;
     bool has_font_not_found_error = false;
     bool has_codepoint_not_found_error = false;
     [[maybe_unused]] bool has_other_error = false;
 
-    if (ScaleWidth(region.width, region.x) < 3 || ScaleHeight(region.height, region.y) < 3) {
-        return Err(RegionRenderError::kImageTooSmall);
-    }
-
-    Bitmap bitmap(ScaleWidth(region.width, region.x),
-                  ScaleHeight(region.height, region.y),
-                  PixelFormat::kRGBA8888);
     Canvas canvas(bitmap);
     TextRenderContext text_render_ctx = text_renderer_->BeginDraw(bitmap);
 
+    auto fill_rect = [&](ColorRGBA color, const Rect& rect) {
+        if (blend_background) {
+            canvas.DrawRect(color, rect);
+        } else {
+            canvas.ClearRect(color, rect);
+        }
+    };
+
     for (const CaptionChar& ch : region.chars) {
         int section_x = ScaleX(ch.x) - ScaleX(region.x);
         int section_y = ScaleY(ch.y) - ScaleY(region.y);
@@ -132,7 +211,7 @@ auto RegionRenderer::RenderCaptionRegion(const CaptionRegion& region,
 
         // Draw background if not disabled
         if (!force_no_background_) {
-            canvas.ClearRect(ch.back_color, section_rect);
+            fill_rect(ch.back_color, section_rect);
         }
 
         // Draw enclosure if needed
@@ -140,32 +219,32 @@ auto RegionRenderer::RenderCaptionRegion(const CaptionRegion& region,
             int w = std::max(ScaleX(1), 1);  // use floor
             int h = std::max(ScaleY(1), 1);  // use floor
             if (ch.enclosure_style & EnclosureStyle::kEnclosureStyleTop) {
-                canvas.ClearRect(ch.text_color,
-                                 Rect(section_rect.left,
-                                      section_rect.top,
-                                      section_rect.right,
-                                      section_rect.top + h));
+                fill_rect(ch.text_color,
+                          Rect(section_rect.left,
+                               section_rect.top,
+                               section_rect.right,
+                               section_rect.top + h));
             }
             if (ch.enclosure_style & EnclosureStyle::kEnclosureStyleBottom) {
-                canvas.ClearRect(ch.text_color,
-                                 Rect(section_rect.left,
-                                      section_rect.bottom - h,
-                                      section_rect.right,
-                                      section_rect.bottom));
+                fill_rect(ch.text_color,
+                          Rect(section_rect.left,
+                               section_rect.bottom - h,
+                               section_rect.right,
+                               section_rect.bottom));
             }
             if (ch.enclosure_style & EnclosureStyle::kEnclosureStyleLeft) {
-                canvas.ClearRect(ch.text_color,
-                                 Rect(section_rect.left,
-                                      section_rect.top,
-                                      section_rect.left + w,
-                                      section_rect.bottom));
+                fill_rect(ch.text_color,
+                          Rect(section_rect.left,
+                               section_rect.top,
+                               section_rect.left + w,
+                               section_rect.bottom));
             }
             if (ch.enclosure_style & EnclosureStyle::kEnclosureStyleRight) {
-                canvas.ClearRect(ch.text_color,
-                                 Rect(section_rect.right - w,
-                                      section_rect.top,
-                                      section_rect.right,
-                                      section_rect.bottom));
+                fill_rect(ch.text_color,
+                          Rect(section_rect.right - w,
+                               section_rect.top,
+                               section_rect.right,
+                               section_rect.bottom));
             }
         }
 
@@ -287,19 +366,15 @@ auto RegionRenderer::RenderCaptionRegion(const CaptionRegion& region,
     // If there's no successfully rendered char, return RegionRenderError
     if (char_count > 0 && succeed == 0) {
         if (has_font_not_found_error) {
-            return Err(RegionRenderError::kFontNotFound);
+            return RegionRenderError::kFontNotFound;
         } else if (has_codepoint_not_found_error) {
-            return Err(RegionRenderError::kCodePointNotFound);
+            return RegionRenderError::kCodePointNotFound;
         } else {
-            return Err(RegionRenderError::kOtherError);
+            return RegionRenderError::kOtherError;
         }
     }
 
-    Image image = Bitmap::ToImage(std::move(bitmap));
-    image.dst_x = caption_area_start_x_ + ScaleX(region.x);
-    image.dst_y = caption_area_start_y_ + ScaleY(region.y);
-
-    return Ok(std::move(image));
+    return std::nullopt;
 }
 
 }  // namespace aribcaption
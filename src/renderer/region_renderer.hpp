@@ -23,12 +23,14 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include "aribcaption/caption.hpp"
 #include "aribcaption/context.hpp"
 #include "aribcaption/image.hpp"
 #include "base/logger.hpp"
 #include "base/result.hpp"
+#include "renderer/bitmap_pool.hpp"
 #include "renderer/drcs_renderer.hpp"
 #include "renderer/font_provider.hpp"
 #include "renderer/rect.hpp"
@@ -49,18 +51,44 @@ public:
     ~RegionRenderer() = default;
 public:
     bool Initialize(FontProviderType font_provider_type = FontProviderType::kAuto,
-                    TextRendererType text_renderer_type = TextRendererType::kAuto);
+                    TextRendererType text_renderer_type = TextRendererType::kAuto,
+                    std::shared_ptr<const FontIndex> font_index = nullptr);
     void SetFontLanguage(uint32_t iso6392_language_code);
     bool SetFontFamily(const std::vector<std::string>& font_family);
     void SetOriginalPlaneSize(int plane_width, int plane_height);
     void SetTargetCaptionAreaRect(const Rect& rect);
     void SetStrokeWidth(float dots);
     void SetReplaceDRCS(bool replace);
+    void SetDRCSScaleMode(DRCSScaleMode mode);
     void SetForceStrokeText(bool force_stroke);
     void SetForceNoBackground(bool force_no_background);
+    void SetCropToContent(bool crop);
     void SetReplaceMSZHalfWidthGlyph(bool replace);
+    void SetBitmapPool(std::shared_ptr<BitmapPool> pool);
+
+    // Add memory held by fonts, glyph caches and DRCS mask caches into usage, the shared BitmapPool is not included
+    void AccumulateMemoryUsage(RendererMemoryUsage& usage) const;
+
+    // Evict cached glyphs and DRCS masks to free up to bytes, returns freed bytes
+    size_t TrimCaches(size_t bytes);
     auto RenderCaptionRegion(const CaptionRegion& region,
                              const std::unordered_map<uint32_t, DRCS>& drcs_map) -> Result<Image, RegionRenderError>;
+
+    // Convert the drawn bitmap placed at (x, y) of the target frame into Image, cropped to its drawn pixels
+    // if SetCropToContent(true). Returns kImageTooSmall if cropped to nothing.
+    auto ToRegionImage(Bitmap&& bitmap, int x, int y) const -> Result<Image, RegionRenderError>;
+
+    // Rect of the region in the target frame, or std::nullopt if the region is too small to be rendered
+    auto CalculateRegionRect(const CaptionRegion& region) const -> std::optional<Rect>;
+
+    // Draw the region into target, which must have the size of CalculateRegionRect(), e.g. a SubBitmap of a canvas
+    // shared by multiple regions. Returns an error if no char could be drawn.
+    // Backgrounds replace the pixels of target, unless blend_background is set for drawing onto existing content,
+    // e.g. a video frame.
+    auto DrawCaptionRegion(const CaptionRegion& region,
+                           const std::unordered_map<uint32_t, DRCS>& drcs_map,
+                           Bitmap& target,
+                           bool blend_background = false) -> std::optional<RegionRenderError>;
 private:
     template <typename T>
     [[nodiscard]]
@@ -110,6 +138,9 @@ private:
     bool replace_drcs_ = true;
     bool force_stroke_text_ = false;
     bool force_no_background_ = false;
+    bool crop_to_content_ = false;
+
+    std::shared_ptr<BitmapPool> bitmap_pool_;
 
     float x_magnification_ = 0.0f;
     float y_magnification_ = 0.0f;
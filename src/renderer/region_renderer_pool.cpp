@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include "renderer/region_renderer_pool.hpp"
+
+namespace aribcaption {
+
+RegionRendererPool::RegionRendererPool(Context& context) : context_(context), log_(GetContextLogger(context)) {}
+
+RegionRendererPool::~RegionRendererPool() {
+    Stop();
+}
+
+bool RegionRendererPool::Start(size_t worker_count,
+                               FontProviderType font_provider_type,
+                               TextRendererType text_renderer_type,
+                               std::shared_ptr<const FontIndex> font_index) {
+    Stop();
+
+    std::vector<std::unique_ptr<RegionRenderer>> renderers;
+    for (size_t i = 0; i < worker_count; i++) {
+        auto renderer = std::make_unique<RegionRenderer>(context_);
+        if (!renderer->Initialize(font_provider_type, text_renderer_type, font_index)) {
+            log_->e("RegionRendererPool: Initialize RegionRenderer for worker failed");
+            return false;
+        }
+        renderers.push_back(std::move(renderer));
+    }
+
+    renderers_ = std::move(renderers);
+    stop_ = false;
+
+    for (auto& renderer : renderers_) {
+        threads_.emplace_back(&RegionRendererPool::WorkerThreadProc, this, std::ref(*renderer));
+    }
+
+    return true;
+}
+
+void RegionRendererPool::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    batch_cv_.notify_all();
+
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+
+    threads_.clear();
+    renderers_.clear();
+}
+
+auto RegionRendererPool::RenderRegions(RegionRenderer& caller_renderer,
+                                       const SetupFunc& setup,
+                                       const std::vector<const CaptionRegion*>& regions,
+                                       const std::unordered_map<uint32_t, DRCS>& drcs_map)
+                                       -> std::vector<RegionResult> {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        setup_ = &setup;
+        regions_ = &regions;
+        drcs_map_ = &drcs_map;
+        results_.clear();
+        results_.resize(regions.size());
+        next_index_ = 0;
+        batch_id_++;
+        batch_open_ = true;
+    }
+    batch_cv_.notify_all();
+
+    // The calling thread takes jobs as well, its renderer is already set up
+    RunJobs(caller_renderer, nullptr);
+
+    // Wait for workers which are still rendering, workers woken up later won't join this batch anymore
+    std::unique_lock<std::mutex> lock(mutex_);
+    batch_open_ = false;
+    done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+
+    setup_ = nullptr;
+    regions_ = nullptr;
+    drcs_map_ = nullptr;
+    return std::move(results_);
+}
+
+void RegionRendererPool::AccumulateMemoryUsage(RendererMemoryUsage& usage) const {
+    for (const std::unique_ptr<RegionRenderer>& renderer : renderers_) {
+        renderer->AccumulateMemoryUsage(usage);
+    }
+}
+
+size_t RegionRendererPool::TrimCaches(size_t bytes) {
+    size_t freed = 0;
+    for (std::unique_ptr<RegionRenderer>& renderer : renderers_) {
+        if (freed >= bytes) {
+            break;
+        }
+        freed += renderer->TrimCaches(bytes - freed);
+    }
+    return freed;
+}
+
+void RegionRendererPool::WorkerThreadProc(RegionRenderer& renderer) {
+    uint64_t handled_batch_id = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true) {
+        batch_cv_.wait(lock, [&] { return stop_ || batch_id_ != handled_batch_id; });
+        if (stop_) {
+            break;
+        }
+
+        handled_batch_id = batch_id_;
+        if (!batch_open_) {
+            continue;
+        }
+
+        active_workers_++;
+        const SetupFunc* setup = setup_;
+        lock.unlock();
+
+        RunJobs(renderer, setup);
+
+        lock.lock();
+        if (--active_workers_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void RegionRendererPool::RunJobs(RegionRenderer& renderer, const SetupFunc* setup) {
+    bool setup_done = false;
+
+    while (true) {
+        size_t index = next_index_.fetch_add(1);
+        if (index >= regions_->size()) {
+            break;
+        }
+
+        if (setup && !setup_done) {
+            (*setup)(renderer);
+            setup_done = true;
+        }
+
+        results_[index] = renderer.RenderCaptionRegion(*(*regions_)[index], *drcs_map_);
+    }
+}
+
+}  // namespace aribcaption
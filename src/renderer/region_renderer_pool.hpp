@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef ARIBCAPTION_REGION_RENDERER_POOL_HPP
+#define ARIBCAPTION_REGION_RENDERER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "aribcaption/caption.hpp"
+#include "aribcaption/context.hpp"
+#include "aribcaption/image.hpp"
+#include "aribcaption/renderer.hpp"
+#include "base/logger.hpp"
+#include "base/result.hpp"
+#include "renderer/region_renderer.hpp"
+
+namespace aribcaption {
+
+// Renders independent caption regions concurrently.
+// Every worker thread owns a RegionRenderer replica (with its own FontProvider / TextRenderer state),
+// the calling thread takes part in rendering with the RegionRenderer passed in.
+class RegionRendererPool {
+public:
+    using SetupFunc = std::function<void(RegionRenderer& renderer)>;
+    using RegionResult = std::optional<Result<Image, RegionRenderError>>;
+public:
+    explicit RegionRendererPool(Context& context);
+    ~RegionRendererPool();
+public:
+    // Spawn worker_count worker threads, replacing existing workers
+    bool Start(size_t worker_count,
+               FontProviderType font_provider_type = FontProviderType::kAuto,
+               TextRendererType text_renderer_type = TextRendererType::kAuto,
+               std::shared_ptr<const FontIndex> font_index = nullptr);
+    void Stop();
+
+    [[nodiscard]]
+    size_t worker_count() const { return threads_.size(); }
+
+    // setup is called on each worker's RegionRenderer before it renders the first region of this batch,
+    // caller_renderer must have been set up by the caller. Results are stored in the order of regions.
+    std::vector<RegionResult> RenderRegions(RegionRenderer& caller_renderer,
+                                            const SetupFunc& setup,
+                                            const std::vector<const CaptionRegion*>& regions,
+                                            const std::unordered_map<uint32_t, DRCS>& drcs_map);
+
+    // Memory accounting & eviction of the workers' RegionRenderers, see RegionRenderer.
+    // Workers are idle between RenderRegions() calls, so these are safe to be called from the calling thread.
+    void AccumulateMemoryUsage(RendererMemoryUsage& usage) const;
+    size_t TrimCaches(size_t bytes);
+private:
+    void WorkerThreadProc(RegionRenderer& renderer);
+    void RunJobs(RegionRenderer& renderer, const SetupFunc* setup);
+public:
+    RegionRendererPool(const RegionRendererPool&) = delete;
+    RegionRendererPool& operator=(const RegionRendererPool&) = delete;
+private:
+    Context& context_;
+    std::shared_ptr<Logger> log_;
+
+    std::vector<std::unique_ptr<RegionRenderer>> renderers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable batch_cv_;
+    std::condition_variable done_cv_;
+    bool stop_ = false;
+    uint64_t batch_id_ = 0;
+    bool batch_open_ = false;
+    size_t active_workers_ = 0;
+
+    // Current batch, valid while batch_open_ or active_workers_ > 0
+    const SetupFunc* setup_ = nullptr;
+    const std::vector<const CaptionRegion*>* regions_ = nullptr;
+    const std::unordered_map<uint32_t, DRCS>* drcs_map_ = nullptr;
+    std::vector<RegionResult> results_;
+    std::atomic<size_t> next_index_ = 0;
+};
+
+}  // namespace aribcaption
+
+#endif  // ARIBCAPTION_REGION_RENDERER_POOL_HPP
@@ -29,6 +29,10 @@ Renderer::Renderer(Renderer&&) noexcept = default;
 
 Renderer& Renderer::operator=(Renderer&&) noexcept = default;
 
+bool Renderer::SetFontSearchPaths(const std::vector<std::string>& paths, const std::string& index_cache_path) {
+    return pimpl_->SetFontSearchPaths(paths, index_cache_path);
+}
+
 bool Renderer::Initialize(CaptionType caption_type,
                           FontProviderType font_provider_type,
                           TextRendererType text_renderer_type) {
@@ -43,6 +47,10 @@ void Renderer::SetReplaceDRCS(bool replace) {
     pimpl_->SetReplaceDRCS(replace);
 }
 
+void Renderer::SetDRCSScaleMode(DRCSScaleMode mode) {
+    pimpl_->SetDRCSScaleMode(mode);
+}
+
 void Renderer::SetForceStrokeText(bool force_stroke) {
     pimpl_->SetForceStrokeText(force_stroke);
 }
@@ -55,10 +63,18 @@ void Renderer::SetForceNoBackground(bool force_no_background) {
     pimpl_->SetForceNoBackground(force_no_background);
 }
 
+void Renderer::SetCropImagesToContent(bool crop) {
+    pimpl_->SetCropImagesToContent(crop);
+}
+
 void Renderer::SetMergeRegionImages(bool merge) {
     pimpl_->SetMergeRegionImages(merge);
 }
 
+void Renderer::SetOutputPixelFormat(PixelFormat pixel_format) {
+    pimpl_->SetOutputPixelFormat(pixel_format);
+}
+
 bool Renderer::SetDefaultFontFamily(const std::vector<std::string>& font_family, bool force_default) {
     return pimpl_->SetDefaultFontFamily(font_family, force_default);
 }
@@ -83,6 +99,22 @@ void Renderer::SetStoragePolicy(CaptionStoragePolicy policy, std::optional<size_
     pimpl_->SetStoragePolicy(policy, upper_limit);
 }
 
+bool Renderer::SetRenderAheadCount(size_t count) {
+    return pimpl_->SetRenderAheadCount(count);
+}
+
+bool Renderer::SetRenderThreadCount(size_t count) {
+    return pimpl_->SetRenderThreadCount(count);
+}
+
+RendererMemoryUsage Renderer::GetMemoryUsage() {
+    return pimpl_->GetMemoryUsage();
+}
+
+void Renderer::SetMemoryBudget(size_t bytes) {
+    pimpl_->SetMemoryBudget(bytes);
+}
+
 bool Renderer::AppendCaption(const Caption& caption) {
     return pimpl_->AppendCaption(caption);
 }
@@ -99,6 +131,10 @@ RenderStatus Renderer::Render(int64_t pts, RenderResult& out_result) {
     return pimpl_->Render(pts, out_result);
 }
 
+RenderStatus Renderer::RenderToFrame(int64_t pts, VideoFrame& frame) {
+    return pimpl_->RenderToFrame(pts, frame);
+}
+
 void Renderer::Flush() {
     pimpl_->Flush();
 }
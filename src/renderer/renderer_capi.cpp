@@ -85,6 +85,40 @@ void aribcc_render_result_cleanup(aribcc_render_result_t* render_result) {
     }
 }
 
+void aribcc_render_result_cleanup_shared(aribcc_render_result_t* render_result, void** bitmap_owners) {
+    if (bitmap_owners) {
+        for (uint32_t i = 0; i < render_result->image_count; i++) {
+            aribcc_image_t* image = &render_result->images[i];
+            if (image->bitmap) {
+                aribcc_image_bitmap_release(bitmap_owners[i], image->bitmap);
+                image->bitmap = nullptr;
+                image->bitmap_size = 0;
+            }
+        }
+        free(bitmap_owners);
+    }
+    aribcc_render_result_cleanup(render_result);
+}
+
+uint8_t* aribcc_render_result_take_bitmap(aribcc_render_result_t* render_result,
+                                          void** bitmap_owners,
+                                          uint32_t index,
+                                          void** out_owner) {
+    if (!out_owner || index >= render_result->image_count) {
+        return nullptr;
+    }
+
+    aribcc_image_t* image = &render_result->images[index];
+    uint8_t* bitmap = image->bitmap;
+    *out_owner = bitmap_owners ? bitmap_owners[index] : nullptr;
+
+    image->bitmap = nullptr;
+    if (bitmap_owners) {
+        bitmap_owners[index] = nullptr;
+    }
+    return bitmap;
+}
+
 aribcc_renderer_t* aribcc_renderer_alloc(aribcc_context_t* context) {
     auto ctx = reinterpret_cast<Context*>(context);
     auto impl = new(std::nothrow) RendererImpl(*ctx);
@@ -96,6 +130,20 @@ void aribcc_renderer_free(aribcc_renderer_t* renderer) {
     delete impl;
 }
 
+bool aribcc_renderer_set_font_search_paths(aribcc_renderer_t* renderer,
+                                           const char * const * paths,
+                                           size_t path_count,
+                                           const char* index_cache_path) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    std::vector<std::string> search_paths;
+
+    for (size_t i = 0; i < path_count; i++) {
+        search_paths.emplace_back(paths[i]);
+    }
+
+    return impl->SetFontSearchPaths(search_paths, index_cache_path ? index_cache_path : "");
+}
+
 bool aribcc_renderer_initialize(aribcc_renderer_t* renderer,
                                 aribcc_captiontype_t caption_type,
                                 aribcc_fontprovider_type_t font_provider_type,
@@ -116,6 +164,11 @@ void aribcc_renderer_set_replace_drcs(aribcc_renderer_t* renderer, bool replace)
     impl->SetReplaceDRCS(replace);
 }
 
+void aribcc_renderer_set_drcs_scale_mode(aribcc_renderer_t* renderer, aribcc_drcs_scale_mode_t mode) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    impl->SetDRCSScaleMode(static_cast<DRCSScaleMode>(mode));
+}
+
 void aribcc_renderer_set_force_stroke_text(aribcc_renderer_t* renderer, bool force_stroke) {
     auto impl = reinterpret_cast<RendererImpl*>(renderer);
     impl->SetForceStrokeText(force_stroke);
@@ -131,11 +184,21 @@ void aribcc_renderer_set_force_no_background(aribcc_renderer_t* renderer, bool f
     impl->SetForceNoBackground(force_no_background);
 }
 
+void aribcc_renderer_set_crop_images_to_content(aribcc_renderer_t* renderer, bool crop) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    impl->SetCropImagesToContent(crop);
+}
+
 void aribcc_renderer_set_merge_region_images(aribcc_renderer_t* renderer, bool merge) {
     auto impl = reinterpret_cast<RendererImpl*>(renderer);
     impl->SetMergeRegionImages(merge);
 }
 
+void aribcc_renderer_set_output_pixel_format(aribcc_renderer_t* renderer, aribcc_pixelformat_t pixel_format) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    impl->SetOutputPixelFormat(static_cast<PixelFormat>(pixel_format));
+}
+
 bool aribcc_renderer_set_default_font_family(aribcc_renderer_t* renderer,
                                              const char * const * font_family,
                                              size_t family_count,
@@ -188,13 +251,38 @@ void aribcc_renderer_set_storage_policy(aribcc_renderer_t* renderer,
     impl->SetStoragePolicy(static_cast<CaptionStoragePolicy>(storage_policy), upper_limit);
 }
 
+bool aribcc_renderer_set_render_ahead_count(aribcc_renderer_t* renderer, size_t count) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    return impl->SetRenderAheadCount(count);
+}
+
+bool aribcc_renderer_set_render_thread_count(aribcc_renderer_t* renderer, size_t count) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    return impl->SetRenderThreadCount(count);
+}
+
+void aribcc_renderer_get_memory_usage(aribcc_renderer_t* renderer, aribcc_renderer_memory_usage_t* out_usage) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    RendererMemoryUsage usage = impl->GetMemoryUsage();
+    out_usage->captions = usage.captions;
+    out_usage->font_data = usage.font_data;
+    out_usage->glyph_caches = usage.glyph_caches;
+    out_usage->image_caches = usage.image_caches;
+    out_usage->total = usage.total;
+}
+
+void aribcc_renderer_set_memory_budget(aribcc_renderer_t* renderer, size_t bytes) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    impl->SetMemoryBudget(bytes);
+}
+
 bool aribcc_renderer_append_caption(aribcc_renderer_t* renderer, const aribcc_caption_t* caption) {
     auto impl = reinterpret_cast<RendererImpl*>(renderer);
     Caption cap = ConstructCaptionFromCAPI(caption);
     return impl->AppendCaption(std::move(cap));
 }
 
-static void ConvertImageToCAPI(const Image& image, aribcc_image_t* out_image) {
+static void ConvertImageToCAPI(const Image& image, aribcc_image_t* out_image, void** out_bitmap_owner) {
     out_image->width = image.width;
     out_image->height = image.height;
     out_image->stride = image.stride;
@@ -204,12 +292,21 @@ static void ConvertImageToCAPI(const Image& image, aribcc_image_t* out_image) {
 
     if (!image.bitmap.empty()) {
         out_image->bitmap_size = static_cast<uint32_t>(image.bitmap.size());
-        out_image->bitmap = reinterpret_cast<uint8_t*>(AlignedAlloc(out_image->bitmap_size, Image::kAlignedTo));
-        memcpy(out_image->bitmap, image.bitmap.data(), out_image->bitmap_size);
+        if (out_bitmap_owner) {
+            // Hold a reference of the pixel buffer instead of copying
+            auto owner = new ImageBuffer(image.bitmap);
+            out_image->bitmap = const_cast<uint8_t*>(owner->data());
+            *out_bitmap_owner = owner;
+        } else {
+            out_image->bitmap = reinterpret_cast<uint8_t*>(AlignedAlloc(out_image->bitmap_size, Image::kAlignedTo));
+            memcpy(out_image->bitmap, image.bitmap.data(), out_image->bitmap_size);
+        }
     }
 }
 
-static void ConvertRenderResultToCAPI(const RenderResult& result, aribcc_render_result_t* out_result) {
+static void ConvertRenderResultToCAPI(const RenderResult& result,
+                                      aribcc_render_result_t* out_result,
+                                      void*** out_bitmap_owners) {
     out_result->pts = result.pts;
     out_result->duration = result.duration;
 
@@ -217,10 +314,16 @@ static void ConvertRenderResultToCAPI(const RenderResult& result, aribcc_render_
         out_result->image_count = static_cast<uint32_t>(result.images.size());
         out_result->images = reinterpret_cast<aribcc_image_t*>(calloc(out_result->image_count, sizeof(aribcc_image_t)));
 
+        void** bitmap_owners = nullptr;
+        if (out_bitmap_owners) {
+            bitmap_owners = reinterpret_cast<void**>(calloc(out_result->image_count, sizeof(void*)));
+            *out_bitmap_owners = bitmap_owners;
+        }
+
         for (uint32_t i = 0; i < out_result->image_count; i++) {
             const Image& src = result.images[i];
             aribcc_image_t* dst = &out_result->images[i];
-            ConvertImageToCAPI(src, dst);
+            ConvertImageToCAPI(src, dst, bitmap_owners ? &bitmap_owners[i] : nullptr);
         }
     }
 }
@@ -242,9 +345,70 @@ aribcc_render_status_t aribcc_renderer_render(aribcc_renderer_t* renderer,
     memset(out_result, 0, sizeof(*out_result));
 
     if (status == RenderStatus::kGotImage || status == RenderStatus::kGotImageUnchanged) {
-        ConvertRenderResultToCAPI(result, out_result);
+        ConvertRenderResultToCAPI(result, out_result, nullptr);
+    }
+
+    return static_cast<aribcc_render_status_t>(status);
+}
+
+aribcc_render_status_t aribcc_renderer_render_shared(aribcc_renderer_t* renderer,
+                                                     int64_t pts,
+                                                     aribcc_render_result_t* out_result,
+                                                     void*** out_bitmap_owners) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+
+    RenderResult result;
+    RenderStatus status = impl->Render(pts, result);
+
+    memset(out_result, 0, sizeof(*out_result));
+    *out_bitmap_owners = nullptr;
+
+    if (status == RenderStatus::kGotImage || status == RenderStatus::kGotImageUnchanged) {
+        ConvertRenderResultToCAPI(result, out_result, out_bitmap_owners);
+    }
+
+    return static_cast<aribcc_render_status_t>(status);
+}
+
+void aribcc_renderer_get_damage_rects(aribcc_renderer_t* renderer,
+                                      const aribcc_damage_rect_t** out_rects,
+                                      size_t* out_count) {
+    static_assert(sizeof(DamageRect) == sizeof(aribcc_damage_rect_t), "DamageRect layout mismatch");
+
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    const std::vector<DamageRect>& damage_rects = impl->last_damage_rects();
+
+    *out_rects = damage_rects.empty() ? nullptr : reinterpret_cast<const aribcc_damage_rect_t*>(damage_rects.data());
+    *out_count = damage_rects.size();
+}
+
+void aribcc_renderer_get_palette(aribcc_renderer_t* renderer, const uint32_t** out_palette, size_t* out_count) {
+    static_assert(sizeof(ColorRGBA) == sizeof(uint32_t), "ColorRGBA layout mismatch");
+
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+    const std::vector<ColorRGBA>& palette = impl->last_palette();
+
+    *out_palette = palette.empty() ? nullptr : reinterpret_cast<const uint32_t*>(palette.data());
+    *out_count = palette.size();
+}
+
+aribcc_render_status_t aribcc_renderer_render_to_frame(aribcc_renderer_t* renderer,
+                                                       int64_t pts,
+                                                       const aribcc_video_frame_t* frame) {
+    auto impl = reinterpret_cast<RendererImpl*>(renderer);
+
+    VideoFrame video_frame;
+    video_frame.pixel_format = static_cast<FramePixelFormat>(frame->pixel_format);
+    video_frame.color_space = static_cast<FrameColorSpace>(frame->color_space);
+    video_frame.full_range = frame->full_range;
+    video_frame.width = frame->width;
+    video_frame.height = frame->height;
+    for (size_t i = 0; i < 3; i++) {
+        video_frame.planes[i] = frame->planes[i];
+        video_frame.strides[i] = frame->strides[i];
     }
 
+    RenderStatus status = impl->RenderToFrame(pts, video_frame);
     return static_cast<aribcc_render_status_t>(status);
 }
 
@@ -17,26 +17,66 @@
  */
 
 #include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
+#include <utility>
 #include "aribcaption/context.hpp"
 #include "renderer/bitmap.hpp"
 #include "renderer/canvas.hpp"
+#include "renderer/frame_compositor.hpp"
+#include "renderer/palette_quantizer.hpp"
 #include "renderer/renderer_impl.hpp"
 
+#if defined(ARIBCC_USE_FREETYPE)
+    #include "renderer/font_index.hpp"
+#endif
+
 namespace aribcaption::internal {
 
 RendererImpl::RendererImpl(Context& context)
-    : context_(context), log_(GetContextLogger(context)), region_renderer_(context) {}
+    : context_(context), log_(GetContextLogger(context)), region_renderer_(context) {
+    // Pixel buffers are reused across renders, by all RegionRenderers of this renderer
+    region_render_settings_.bitmap_pool = std::make_shared<BitmapPool>();
+    region_renderer_.SetBitmapPool(region_render_settings_.bitmap_pool);
+}
+
+RendererImpl::~RendererImpl() {
+    StopRenderAhead();
+    region_renderer_pool_.reset();
+}
 
-RendererImpl::~RendererImpl() = default;
+bool RendererImpl::SetFontSearchPaths(const std::vector<std::string>& paths, const std::string& index_cache_path) {
+    if (inited_) {
+        log_->e("RendererImpl: Font search paths must be indicated before Initialize()");
+        return false;
+    }
+
+#if defined(ARIBCC_USE_FREETYPE)
+    auto font_index = std::make_shared<FontIndex>(context_);
+    if (!font_index->Build(paths, index_cache_path)) {
+        return false;
+    }
+    font_index_ = std::move(font_index);
+    return true;
+#else
+    (void)paths;
+    (void)index_cache_path;
+    log_->e("RendererImpl: Font search paths require FreeType support");
+    return false;
+#endif
+}
 
 bool RendererImpl::Initialize(CaptionType caption_type,
                               FontProviderType font_provider_type,
                               TextRendererType text_renderer_type) {
     expected_caption_type_ = caption_type;
+    font_provider_type_ = font_provider_type;
+    text_renderer_type_ = text_renderer_type;
     LoadDefaultFontFamilies();
-    return region_renderer_.Initialize(font_provider_type, text_renderer_type);
+    inited_ = region_renderer_.Initialize(font_provider_type, text_renderer_type, font_index_);
+    return inited_;
 }
 
 void RendererImpl::LoadDefaultFontFamilies() {
@@ -79,16 +119,31 @@ void RendererImpl::LoadDefaultFontFamilies() {
 
 void RendererImpl::SetStrokeWidth(float dots) {
     region_renderer_.SetStrokeWidth(dots);
+    if (dots >= 0.0f) {
+        region_render_settings_.stroke_width = dots;
+    }
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
 }
 
 void RendererImpl::SetReplaceDRCS(bool replace) {
     region_renderer_.SetReplaceDRCS(replace);
+    region_render_settings_.replace_drcs = replace;
+    ClearRegionImageCache();
+    InvalidatePrevRenderedImages();
+}
+
+void RendererImpl::SetDRCSScaleMode(DRCSScaleMode mode) {
+    region_renderer_.SetDRCSScaleMode(mode);
+    region_render_settings_.drcs_scale_mode = mode;
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
 }
 
 void RendererImpl::SetForceStrokeText(bool force_stroke) {
     region_renderer_.SetForceStrokeText(force_stroke);
+    region_render_settings_.force_stroke_text = force_stroke;
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
 }
 
@@ -99,6 +154,20 @@ void RendererImpl::SetForceNoRuby(bool force_no_ruby) {
 
 void RendererImpl::SetForceNoBackground(bool force_no_background) {
     region_renderer_.SetForceNoBackground(force_no_background);
+    region_render_settings_.force_no_background = force_no_background;
+    ClearRegionImageCache();
+    InvalidatePrevRenderedImages();
+}
+
+void RendererImpl::SetCropImagesToContent(bool crop) {
+    region_renderer_.SetCropToContent(crop);
+    region_render_settings_.crop_to_content = crop;
+    ClearRegionImageCache();
+    InvalidatePrevRenderedImages();
+}
+
+void RendererImpl::SetOutputPixelFormat(PixelFormat pixel_format) {
+    output_pixel_format_ = pixel_format;
     InvalidatePrevRenderedImages();
 }
 
@@ -122,12 +191,15 @@ bool RendererImpl::SetLanguageSpecificFontFamily(uint32_t language_code, const s
 
     language_font_family_[language_code] = font_family;
 
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
     return true;
 }
 
 void RendererImpl::SetReplaceMSZHalfWidthGlyph(bool replace) {
     region_renderer_.SetReplaceMSZHalfWidthGlyph(replace);
+    region_render_settings_.replace_msz_halfwidth_glyph = replace;
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
 }
 
@@ -138,6 +210,7 @@ bool RendererImpl::SetFrameSize(int frame_width, int frame_height) {
     }
 
     if (frame_width_ != frame_width || frame_height_ != frame_height) {
+        ClearRegionImageCache();
         InvalidatePrevRenderedImages();
     }
 
@@ -165,6 +238,7 @@ bool RendererImpl::SetMargins(int top, int bottom, int left, int right) {
     }
 
     if (margin_top_ != top || margin_bottom_ != bottom || margin_left_ != left || margin_right_ != right) {
+        ClearRegionImageCache();
         InvalidatePrevRenderedImages();
     }
 
@@ -192,44 +266,91 @@ void RendererImpl::SetStoragePolicy(CaptionStoragePolicy policy, std::optional<s
     } else if (policy == CaptionStoragePolicy::kUpperLimitDuration) {
         assert(upper_limit.has_value());
         upper_limit_duration_ = upper_limit.value();
+    } else if (policy == CaptionStoragePolicy::kUpperLimitBytes) {
+        assert(upper_limit.has_value());
+        upper_limit_bytes_ = upper_limit.value();
     }
 }
 
-bool RendererImpl::AppendCaption(const Caption& caption) {
-    assert(caption.pts != PTS_NOPTS && "Caption without PTS is not supported");
-    assert(caption.plane_width > 0 && caption.plane_height > 0);
-
-    if (caption.pts == PTS_NOPTS || caption.plane_width <= 0 || caption.plane_height <= 0) {
-        return false;
+bool RendererImpl::SetRenderAheadCount(size_t count) {
+    if (count == 0) {
+        StopRenderAhead();
+        render_ahead_count_ = 0;
+        return true;
     }
 
-    int64_t pts = caption.pts;
-
-    if (captions_.empty()) {
-        captions_.emplace(pts, caption);
-    } else {
-        auto prev = captions_.lower_bound(pts - 1);
-        if (prev == captions_.end() || (prev != captions_.begin() && prev->first > pts - 1)) {
-            --prev;
+    if (!render_ahead_thread_.joinable()) {
+        auto renderer = std::make_unique<RegionRenderer>(context_);
+        if (!renderer->Initialize(font_provider_type_, text_renderer_type_, font_index_)) {
+            log_->e("RendererImpl: Initialize RegionRenderer for render-ahead failed");
+            return false;
         }
 
-        // Correct previous caption's duration
-        if (prev->first < pts && prev->second.wait_duration == DURATION_INDEFINITE) {
-            Caption& prev_caption = prev->second;
-            prev_caption.wait_duration = pts - prev_caption.pts;
-        }
+        render_ahead_renderer_ = std::move(renderer);
+        render_ahead_stop_ = false;
+        render_ahead_thread_ = std::thread(&RendererImpl::RenderAheadThreadProc, this);
+    }
+
+    render_ahead_count_ = count;
+    ScheduleRenderAhead(true);
+    return true;
+}
 
-        captions_.insert_or_assign(std::next(prev), pts, caption);
+bool RendererImpl::SetRenderThreadCount(size_t count) {
+    if (count <= 1) {
+        region_renderer_pool_.reset();
+        return true;
     }
 
-    if (pts <= prev_rendered_caption_pts_) {
-        InvalidatePrevRenderedImages();
+    // The calling thread renders as well
+    size_t worker_count = count - 1;
+    if (region_renderer_pool_ && region_renderer_pool_->worker_count() == worker_count) {
+        return true;
     }
 
-    CleanupCaptionsIfNecessary();
+    auto pool = std::make_unique<RegionRendererPool>(context_);
+    if (!pool->Start(worker_count, font_provider_type_, text_renderer_type_, font_index_)) {
+        log_->e("RendererImpl: Start RegionRendererPool failed");
+        return false;
+    }
+
+    region_renderer_pool_ = std::move(pool);
     return true;
 }
 
+RendererMemoryUsage RendererImpl::GetMemoryUsage() {
+    RendererMemoryUsage usage;
+    usage.captions = captions_.memory_size();
+
+    region_renderer_.AccumulateMemoryUsage(usage);
+    if (region_renderer_pool_) {
+        region_renderer_pool_->AccumulateMemoryUsage(usage);
+    }
+    if (render_ahead_thread_.joinable()) {
+        std::lock_guard<std::mutex> lock(render_ahead_mutex_);
+        usage.font_data += render_ahead_memory_usage_.font_data;
+        usage.glyph_caches += render_ahead_memory_usage_.glyph_caches;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+        usage.image_caches += region_image_cache_.total_cost();
+    }
+    usage.image_caches += region_render_settings_.bitmap_pool->cached_size();
+
+    usage.total = usage.captions + usage.font_data + usage.glyph_caches + usage.image_caches;
+    return usage;
+}
+
+void RendererImpl::SetMemoryBudget(size_t bytes) {
+    memory_budget_ = bytes;
+    EnforceMemoryBudget();
+}
+
+bool RendererImpl::AppendCaption(const Caption& caption) {
+    return AppendCaption(Caption(caption));
+}
+
 bool RendererImpl::AppendCaption(Caption&& caption) {
     assert(caption.pts != PTS_NOPTS && "Caption without PTS is not supported");
     assert(caption.plane_width > 0 && caption.plane_height > 0);
@@ -240,28 +361,24 @@ bool RendererImpl::AppendCaption(Caption&& caption) {
 
     int64_t pts = caption.pts;
 
-    if (captions_.empty()) {
-        captions_.emplace(pts, std::move(caption));
-    } else {
-        auto prev = captions_.lower_bound(pts - 1);
-        if (prev == captions_.end() || (prev != captions_.begin() && prev->first > pts - 1)) {
-            --prev;
-        }
-
-        // Correct previous caption's duration
-        if (prev->first < pts && prev->second.wait_duration == DURATION_INDEFINITE) {
-            Caption& prev_caption = prev->second;
+    // Correct previous caption's duration
+    auto prev = captions_.LowerBound(pts);
+    if (prev != captions_.begin()) {
+        Caption& prev_caption = *std::prev(prev);
+        if (prev_caption.wait_duration == DURATION_INDEFINITE) {
             prev_caption.wait_duration = pts - prev_caption.pts;
         }
-
-        captions_.insert_or_assign(std::next(prev), pts, std::move(caption));
     }
 
+    captions_.Insert(std::move(caption));
+
     if (pts <= prev_rendered_caption_pts_) {
         InvalidatePrevRenderedImages();
     }
 
     CleanupCaptionsIfNecessary();
+    EnforceMemoryBudget();
+    ScheduleRenderAhead(true);
     return true;
 }
 
@@ -272,9 +389,9 @@ void RendererImpl::CleanupCaptionsIfNecessary() {
         if (prev_rendered_caption_pts_ == PTS_NOPTS) {
             return;
         }
-        auto prev_rendered_caption_iter = captions_.find(prev_rendered_caption_pts_);
+        auto prev_rendered_caption_iter = captions_.Find(prev_rendered_caption_pts_);
         if (prev_rendered_caption_iter != captions_.end()) {
-            captions_.erase(captions_.begin(), prev_rendered_caption_iter);
+            captions_.EraseFront(prev_rendered_caption_iter);
         }
     } else if (storage_policy_ == CaptionStoragePolicy::kUpperLimitCount) {
         if (captions_.size() <= upper_limit_count_) {
@@ -282,45 +399,126 @@ void RendererImpl::CleanupCaptionsIfNecessary() {
         }
         auto erase_end = std::prev(captions_.end(), static_cast<ptrdiff_t>(upper_limit_count_));
         if (erase_end != captions_.begin()) {
-            captions_.erase(captions_.begin(), erase_end);
+            captions_.EraseFront(erase_end);
         }
     } else if (storage_policy_ == CaptionStoragePolicy::kUpperLimitDuration) {
         if (captions_.empty()) {
             return;
         }
-        int64_t last_caption_pts = captions_.rbegin()->first;
+        int64_t last_caption_pts = captions_.back().pts;
         int64_t erase_end_pts = last_caption_pts - static_cast<int64_t>(upper_limit_duration_);
-        auto erase_end = captions_.lower_bound(erase_end_pts);
+        auto erase_end = captions_.LowerBound(erase_end_pts);
         if (erase_end != captions_.end() && erase_end != captions_.begin()) {
-            captions_.erase(captions_.begin(), erase_end);
+            captions_.EraseFront(erase_end);
+        }
+    } else if (storage_policy_ == CaptionStoragePolicy::kUpperLimitBytes) {
+        // Evict oldest captions until fit, but always keep the latest one
+        auto erase_end = captions_.begin();
+        size_t memory_size = captions_.memory_size();
+        while (memory_size > upper_limit_bytes_ && std::next(erase_end) < captions_.end()) {
+            memory_size -= CaptionStore::CalculateMemorySize(*erase_end);
+            ++erase_end;
+        }
+        if (erase_end != captions_.begin()) {
+            captions_.EraseFront(erase_end);
         }
     }
 }
 
-RenderStatus RendererImpl::TryRender(int64_t pts) {
-    if (!frame_size_inited_ || !margins_inited_) {
-        return RenderStatus::kError;
+// Evict from the cheapest to rebuild: pooled buffers, region images, glyph caches, then presented captions
+void RendererImpl::EnforceMemoryBudget() {
+    if (memory_budget_ == 0) {
+        return;
+    }
+
+    RendererMemoryUsage usage = GetMemoryUsage();
+    if (usage.total <= memory_budget_) {
+        return;
+    }
+    size_t excess = usage.total - memory_budget_;
+
+    BitmapPool& bitmap_pool = *region_render_settings_.bitmap_pool;
+    excess -= std::min(excess, bitmap_pool.cached_size());
+
+    if (excess > 0) {
+        std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+        size_t cached_size = region_image_cache_.total_cost();
+        region_image_cache_.Shrink(cached_size > excess ? cached_size - excess : 0);
+        excess -= std::min(excess, cached_size - region_image_cache_.total_cost());
     }
 
+    // Buffers of evicted images are returned into the pool, clear it afterwards
+    bitmap_pool.Clear();
+
+    if (excess > 0 && region_renderer_pool_) {
+        excess -= std::min(excess, region_renderer_pool_->TrimCaches(excess));
+    }
+    if (excess > 0) {
+        excess -= std::min(excess, region_renderer_.TrimCaches(excess));
+    }
+    if (excess > 0 && render_ahead_thread_.joinable()) {
+        // Glyph caches of the render-ahead renderer are only accessible from its thread, evicted asynchronously
+        {
+            std::lock_guard<std::mutex> lock(render_ahead_mutex_);
+            size_t trim_bytes = std::min(excess, render_ahead_memory_usage_.glyph_caches);
+            render_ahead_trim_bytes_ = std::max(render_ahead_trim_bytes_, trim_bytes);
+            excess -= trim_bytes;
+        }
+        render_ahead_cv_.notify_one();
+    }
+
+    if (excess > 0 && last_render_pts_ != PTS_NOPTS) {
+        // Keep the caption displayed at the latest Render() PTS and all upcoming captions
+        auto keep_begin = captions_.UpperBound(last_render_pts_);
+        if (keep_begin != captions_.begin()) {
+            --keep_begin;
+        }
+        auto erase_end = captions_.begin();
+        size_t freed = 0;
+        while (freed < excess && erase_end != keep_begin) {
+            freed += CaptionStore::CalculateMemorySize(*erase_end);
+            ++erase_end;
+        }
+        if (erase_end != captions_.begin()) {
+            captions_.EraseFront(erase_end);
+        }
+    }
+}
+
+// Caption being displayed at pts, or nullptr if there is none, it has timed out, or it has no region
+const Caption* RendererImpl::FindCaption(int64_t pts) {
     if (captions_.empty()) {
-        return RenderStatus::kNoImage;
+        return nullptr;
     }
 
-    auto iter = captions_.lower_bound(pts);
-    if (iter == captions_.end() || (iter != captions_.begin() && iter->first > pts)) {
+    auto iter = captions_.LowerBound(pts);
+    if (iter == captions_.end() || (iter != captions_.begin() && iter->pts > pts)) {
         --iter;
     }
 
-    Caption& caption = iter->second;
+    const Caption& caption = *iter;
     if (pts < caption.pts || (caption.wait_duration != DURATION_INDEFINITE && pts >= caption.pts + caption.wait_duration)) {
         // Timeout
-        return RenderStatus::kNoImage;
+        return nullptr;
     }
     if (caption.regions.empty()) {
+        return nullptr;
+    }
+
+    return &caption;
+}
+
+RenderStatus RendererImpl::TryRender(int64_t pts) {
+    if (!frame_size_inited_ || !margins_inited_) {
+        return RenderStatus::kError;
+    }
+
+    const Caption* caption = FindCaption(pts);
+    if (!caption) {
         return RenderStatus::kNoImage;
     }
 
-    if (has_prev_rendered_caption_ && prev_rendered_caption_pts_ == caption.pts) {
+    if (has_prev_rendered_caption_ && prev_rendered_caption_pts_ == caption->pts) {
         if (!prev_rendered_images_.empty()) {
             return RenderStatus::kGotImageUnchanged;
         } else {
@@ -332,6 +530,26 @@ RenderStatus RendererImpl::TryRender(int64_t pts) {
 }
 
 RenderStatus RendererImpl::Render(int64_t pts, RenderResult& out_result) {
+    out_result.damage_rects.clear();
+
+    RenderStatus status = RenderImages(pts, out_result);
+    if (status == RenderStatus::kNoImage || status == RenderStatus::kError) {
+        // Caption layer is cleared, regions of the next rendered caption are all damaged
+        displayed_regions_.clear();
+    }
+    last_damage_rects_ = out_result.damage_rects;
+
+    // Images of a caption are quantized with a single palette
+    last_palette_.clear();
+    if (!out_result.images.empty()) {
+        last_palette_ = out_result.images.front().palette;
+    }
+
+    EnforceMemoryBudget();
+    return status;
+}
+
+RenderStatus RendererImpl::RenderImages(int64_t pts, RenderResult& out_result) {
     if (!frame_size_inited_ || !margins_inited_) {
         assert(frame_size_inited_ && margins_inited_ && "Frame size / margins must be indicated first");
         return RenderStatus::kError;
@@ -341,33 +559,22 @@ RenderStatus RendererImpl::Render(int64_t pts, RenderResult& out_result) {
     out_result.duration = 0;
     out_result.images.clear();
 
-    if (captions_.empty()) {
-        InvalidatePrevRenderedImages();
-        return RenderStatus::kNoImage;
-    }
-
-    auto iter = captions_.lower_bound(pts);
-    if (iter == captions_.end() || (iter != captions_.begin() && iter->first > pts)) {
-        --iter;
-    }
+    last_render_pts_ = pts;
+    ScheduleRenderAhead(false);
 
-    Caption& caption = iter->second;
-    if (pts < caption.pts || (caption.wait_duration != DURATION_INDEFINITE && pts >= caption.pts + caption.wait_duration)) {
-        // Timeout
-        InvalidatePrevRenderedImages();
-        return RenderStatus::kNoImage;
-    }
-    if (caption.regions.empty()) {
+    const Caption* found = FindCaption(pts);
+    if (!found) {
         InvalidatePrevRenderedImages();
         return RenderStatus::kNoImage;
     }
+    const Caption& caption = *found;
 
     if (has_prev_rendered_caption_ && prev_rendered_caption_pts_ == caption.pts) {
         // Reuse previous rendered caption
         if (!prev_rendered_images_.empty()) {
             out_result.pts = prev_rendered_caption_pts_;
             out_result.duration = prev_rendered_caption_duration_;
-            out_result.images = prev_rendered_images_;
+            out_result.images = prev_rendered_images_;  // Pixels are shared, not copied
             return RenderStatus::kGotImageUnchanged;
         } else {
             InvalidatePrevRenderedImages();
@@ -381,38 +588,126 @@ RenderStatus RendererImpl::Render(int64_t pts, RenderResult& out_result) {
     region_renderer_.SetFontLanguage(caption.iso6392_language_code);
 
     // Set up Font Family
-    uint32_t language_code = caption.iso6392_language_code;
-    if (force_default_font_family_ || language_font_family_.find(language_code) == language_font_family_.end()) {
-        language_code = 0;
-    }
-    region_renderer_.SetFontFamily(language_font_family_[language_code]);
+    region_renderer_.SetFontFamily(ResolveFontFamily(caption.iso6392_language_code));
 
     // Set up origin plane size / target caption area
     AdjustCaptionArea(caption.plane_width, caption.plane_height);
 
-    std::vector<Image> images;
-    for (CaptionRegion& region : caption.regions) {
+    std::vector<const CaptionRegion*> regions;
+    std::vector<uint64_t> region_hashes;
+    std::vector<DisplayedRegion> displayed_regions;
+    for (const CaptionRegion& region : caption.regions) {
         if (region.is_ruby && force_no_ruby_) {
             continue;
         }
+        regions.push_back(&region);
+        region_hashes.push_back(HashRegion(region, caption));
+        if (std::optional<Rect> rect = region_renderer_.CalculateRegionRect(region)) {
+            displayed_regions.push_back(DisplayedRegion{region_hashes.back(), rect.value()});
+        }
+    }
 
-        Result<Image, RegionRenderError> result = region_renderer_.RenderCaptionRegion(region, caption.drcs_map);
-        if (result.is_ok()) {
-            images.push_back(std::move(result.value()));
-        } else if (result.error() == RegionRenderError::kImageTooSmall) {
-            // Skip image which is too small
-            continue;
+    // Merged image is cached as a whole, keyed by hashes of all regions
+    bool merge = merge_region_images_ && regions.size() > 1;
+    uint64_t merged_hash = merge ? HashMergedRegions(region_hashes) : 0;
+
+    // Look up rendered regions from cache, collect the rest to be rendered
+    std::optional<Image> cached_merged_image;
+    std::vector<std::optional<Image>> region_images(regions.size());
+    std::vector<const CaptionRegion*> pending_regions;
+    std::vector<size_t> pending_indexes;
+    {
+        std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+        if (merge) {
+            if (const Image* cached = region_image_cache_.Get(merged_hash)) {
+                cached_merged_image = *cached;
+            }
+        }
+        for (size_t i = 0; i < regions.size() && !cached_merged_image; i++) {
+            if (const Image* cached = region_image_cache_.Get(region_hashes[i])) {
+                region_images[i] = *cached;
+            } else {
+                pending_regions.push_back(regions[i]);
+                pending_indexes.push_back(i);
+            }
+        }
+    }
+
+    std::vector<Image> images;
+    bool render_in_parallel = region_renderer_pool_ && pending_regions.size() > 1;
+
+    if (cached_merged_image) {
+        images.push_back(std::move(cached_merged_image.value()));
+    } else {
+        // Unless rendered in parallel, pending regions are drawn into the merged image directly
+        std::vector<RegionRendererPool::RegionResult> results;
+        if (render_in_parallel) {
+            const std::vector<std::string>& font_family = ResolveFontFamily(caption.iso6392_language_code);
+            Rect caption_area = CalculateCaptionArea(caption.plane_width, caption.plane_height);
+            auto setup = [&](RegionRenderer& renderer) {
+                SetupRegionRenderer(renderer, region_render_settings_, caption, font_family, caption_area);
+            };
+            results = region_renderer_pool_->RenderRegions(region_renderer_, setup, pending_regions, caption.drcs_map);
+        } else if (!merge) {
+            for (const CaptionRegion* region : pending_regions) {
+                results.emplace_back(region_renderer_.RenderCaptionRegion(*region, caption.drcs_map));
+            }
+        }
+
+        // Process results in the original order of regions
+        for (size_t i = 0; i < results.size(); i++) {
+            Result<Image, RegionRenderError>& result = results[i].value();
+            size_t index = pending_indexes[i];
+            if (result.is_ok()) {
+                Image& image = result.value();
+                size_t cost = sizeof(Image) + image.bitmap.size();
+                {
+                    std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+                    region_image_cache_.Put(region_hashes[index], image, cost);
+                }
+                region_images[index] = std::move(image);
+            } else if (result.error() == RegionRenderError::kImageTooSmall) {
+                // Skip image which is too small
+                continue;
+            } else {
+                log_->e("RendererImpl: RenderCaptionRegion() failed with error: %d",
+                        static_cast<int>(result.error()));
+                InvalidatePrevRenderedImages();
+                return RenderStatus::kError;
+            }
+        }
+
+        if (merge) {
+            auto result = DrawMergedRegions(caption, regions, region_images);
+            if (result.is_ok()) {
+                Image& merged = result.value();
+                size_t cost = sizeof(Image) + merged.bitmap.size();
+                {
+                    std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+                    region_image_cache_.Put(merged_hash, merged, cost);
+                }
+                images.push_back(std::move(merged));
+            } else if (result.error() != RegionRenderError::kImageTooSmall) {
+                log_->e("RendererImpl: DrawMergedRegions() failed with error: %d", static_cast<int>(result.error()));
+                InvalidatePrevRenderedImages();
+                return RenderStatus::kError;
+            }
         } else {
-            log_->e("RendererImpl: RenderCaptionRegion() failed with error: %d", static_cast<int>(result.error()));
-            InvalidatePrevRenderedImages();
-            return RenderStatus::kError;
+            for (std::optional<Image>& image : region_images) {
+                if (image.has_value()) {
+                    images.push_back(std::move(image.value()));
+                }
+            }
         }
     }
 
-    if (merge_region_images_ && images.size() > 1) {
-        Image merged = MergeImages(images);
-        images.clear();
-        images.push_back(std::move(merged));
+    std::vector<ColorRGBA> palette;
+    if (output_pixel_format_ == PixelFormat::kPAL8) {
+        PaletteQuantizer quantizer(PaletteQuantizer::CollectActiveColors(caption));
+        for (Image& image : images) {
+            image = quantizer.Quantize(image, region_render_settings_.bitmap_pool.get());
+        }
+        palette = quantizer.palette();
     }
 
     has_prev_rendered_caption_ = true;
@@ -422,37 +717,297 @@ RenderStatus RendererImpl::Render(int64_t pts, RenderResult& out_result) {
 
     out_result.pts = caption.pts;
     out_result.duration = caption.wait_duration;
-    out_result.images = prev_rendered_images_;
+    out_result.images = prev_rendered_images_;  // Pixels are shared, not copied
+    out_result.damage_rects = UpdateDisplayedRegions(std::move(displayed_regions), std::move(palette));
+    return RenderStatus::kGotImage;
+}
+
+// Replace the displayed regions, returning areas of regions added, removed or changed.
+// A region is unchanged if both of its hash and rect are identical. Everything is damaged if the rendered pixels
+// could have been changed by settings, i.e. the region image cache has been cleared, or output format changed.
+// With kPAL8, the palette is built per caption: indices of an unchanged region refer to different colors
+// once the palette differs from the previous one, so everything is damaged as well.
+std::vector<DamageRect> RendererImpl::UpdateDisplayedRegions(std::vector<DisplayedRegion>&& regions,
+                                                             std::vector<ColorRGBA>&& palette) {
+    bool palette_changed = !std::equal(palette.begin(), palette.end(),
+                                       displayed_regions_palette_.begin(), displayed_regions_palette_.end(),
+                                       [](ColorRGBA a, ColorRGBA b) { return a.u32 == b.u32; });
+    bool settings_changed = displayed_regions_generation_ != region_image_cache_generation_ ||
+                            displayed_regions_pixel_format_ != output_pixel_format_ ||
+                            palette_changed;
+
+    auto contains = [](const std::vector<DisplayedRegion>& list, const DisplayedRegion& target) {
+        return std::any_of(list.begin(), list.end(), [&](const DisplayedRegion& region) {
+            return region.hash == target.hash && region.rect == target.rect;
+        });
+    };
+
+    std::vector<Rect> damaged;
+    auto add_damaged = [&](const Rect& rect) {
+        if (std::find(damaged.begin(), damaged.end(), rect) == damaged.end()) {
+            damaged.push_back(rect);
+        }
+    };
+
+    for (const DisplayedRegion& region : displayed_regions_) {
+        if (settings_changed || !contains(regions, region)) {
+            add_damaged(region.rect);  // Removed or changed
+        }
+    }
+    for (const DisplayedRegion& region : regions) {
+        if (settings_changed || !contains(displayed_regions_, region)) {
+            add_damaged(region.rect);  // Added or changed
+        }
+    }
+
+    displayed_regions_ = std::move(regions);
+    displayed_regions_generation_ = region_image_cache_generation_;
+    displayed_regions_pixel_format_ = output_pixel_format_;
+    displayed_regions_palette_ = std::move(palette);
+
+    std::vector<DamageRect> damage_rects;
+    damage_rects.reserve(damaged.size());
+    for (const Rect& rect : damaged) {
+        damage_rects.push_back(DamageRect{rect.left, rect.top, rect.width(), rect.height()});
+    }
+    return damage_rects;
+}
+
+RenderStatus RendererImpl::RenderToFrame(int64_t pts, VideoFrame& frame) {
+    if (!FrameCompositor::IsValidFrame(frame)) {
+        log_->e("RendererImpl: Invalid VideoFrame passed to RenderToFrame()");
+        return RenderStatus::kError;
+    }
+
+    // A new caption is drawn straight into packed RGB frames, see DrawRegionsToFrame()
+    bool packed_rgb = frame.pixel_format == FramePixelFormat::kRGBA8888 ||
+                      frame.pixel_format == FramePixelFormat::kBGRA8888;
+    if (packed_rgb && TryRender(pts) == RenderStatus::kGotImage) {
+        return DrawRegionsToFrame(pts, frame);
+    }
+
+    RenderResult result;
+    RenderStatus status = Render(pts, result);
+    if (status != RenderStatus::kGotImage && status != RenderStatus::kGotImageUnchanged) {
+        return status;
+    }
+
+    FrameCompositor compositor(frame);
+    for (const Image& image : result.images) {
+        compositor.DrawImage(image);
+    }
+
+    return status;
+}
+
+// Draw the caption at pts into a packed RGB frame without rendering intermediate images.
+// Regions are drawn by the region renderer straight into the frame plane, with backgrounds blended onto it.
+// Only regions found in the region image cache, or not fitting into the frame, are blended from images.
+// Nothing is kept for reuse, so the caption is drawn again on the next call, which goes to a new frame anyway.
+RenderStatus RendererImpl::DrawRegionsToFrame(int64_t pts, VideoFrame& frame) {
+    last_render_pts_ = pts;
+    ScheduleRenderAhead(false);
+
+    const Caption& caption = *FindCaption(pts);
+
+    region_renderer_.SetFontLanguage(caption.iso6392_language_code);
+    region_renderer_.SetFontFamily(ResolveFontFamily(caption.iso6392_language_code));
+    AdjustCaptionArea(caption.plane_width, caption.plane_height);
+
+    std::vector<const CaptionRegion*> regions;
+    std::vector<uint64_t> region_hashes;
+    std::vector<DisplayedRegion> displayed_regions;
+    for (const CaptionRegion& region : caption.regions) {
+        if (region.is_ruby && force_no_ruby_) {
+            continue;
+        }
+        regions.push_back(&region);
+        region_hashes.push_back(HashRegion(region, caption));
+        if (std::optional<Rect> rect = region_renderer_.CalculateRegionRect(region)) {
+            displayed_regions.push_back(DisplayedRegion{region_hashes.back(), rect.value()});
+        }
+    }
+
+    bool merge = merge_region_images_ && regions.size() > 1;
+    std::optional<Image> cached_merged_image;
+    std::vector<std::optional<Image>> cached_images(regions.size());
+    {
+        std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+        if (merge) {
+            if (const Image* cached = region_image_cache_.Get(HashMergedRegions(region_hashes))) {
+                cached_merged_image = *cached;
+            }
+        }
+        for (size_t i = 0; i < regions.size() && !cached_merged_image; i++) {
+            if (const Image* cached = region_image_cache_.Get(region_hashes[i])) {
+                cached_images[i] = *cached;
+            }
+        }
+    }
+
+    FrameCompositor compositor(frame);
+    Bitmap frame_bitmap = Bitmap::FromPixels(frame.planes[0], frame.width, frame.height, frame.strides[0]);
+    bool swap_r_b = frame.pixel_format == FramePixelFormat::kBGRA8888;
+
+    if (cached_merged_image) {
+        compositor.DrawImage(cached_merged_image.value());
+        regions.clear();
+    }
+
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (cached_images[i]) {
+            compositor.DrawImage(cached_images[i].value());
+            continue;
+        }
+
+        std::optional<Rect> rect = region_renderer_.CalculateRegionRect(*regions[i]);
+        if (!rect) {
+            continue;  // Skip region which is too small
+        }
+
+        if (Rect::ClipRect(frame_bitmap.GetRect(), rect.value()) != rect.value()) {
+            // Partially out of the frame, let the compositor clip the region image
+            auto result = region_renderer_.RenderCaptionRegion(*regions[i], caption.drcs_map);
+            if (result.is_ok()) {
+                compositor.DrawImage(result.value());
+                continue;
+            } else if (result.error() == RegionRenderError::kImageTooSmall) {
+                continue;
+            }
+            log_->e("RendererImpl: RenderCaptionRegion() failed with error: %d", static_cast<int>(result.error()));
+            InvalidatePrevRenderedImages();
+            return RenderStatus::kError;
+        }
+
+        // Region renderer draws in kRGBA8888, swap R and B of the area for drawing into kBGRA8888 frames
+        if (swap_r_b) {
+            compositor.SwapRedBlue(rect.value());
+        }
+        Bitmap region_bitmap = Bitmap::SubBitmap(frame_bitmap, rect.value());
+        std::optional<RegionRenderError> error =
+            region_renderer_.DrawCaptionRegion(*regions[i], caption.drcs_map, region_bitmap, true);
+        if (swap_r_b) {
+            compositor.SwapRedBlue(rect.value());
+        }
+
+        if (error) {
+            log_->e("RendererImpl: DrawCaptionRegion() failed with error: %d", static_cast<int>(error.value()));
+            InvalidatePrevRenderedImages();
+            return RenderStatus::kError;
+        }
+    }
+
+    // No image is kept, a later Render() at this PTS renders the caption again
+    InvalidatePrevRenderedImages();
+    last_damage_rects_ = UpdateDisplayedRegions(std::move(displayed_regions), {});
+    last_palette_.clear();
+
+    EnforceMemoryBudget();
     return RenderStatus::kGotImage;
 }
 
-Image RendererImpl::MergeImages(std::vector<Image>& images) {
-    if (images.empty()) return Image{};
+// Draw all regions into a single canvas covering the union of region rects.
+// Pending regions are drawn in place, and already rendered images are copied, as long as they don't overlap
+// with regions drawn before. Overlapped ones are alpha blended onto the canvas instead.
+auto RendererImpl::DrawMergedRegions(const Caption& caption,
+                                     const std::vector<const CaptionRegion*>& regions,
+                                     const std::vector<std::optional<Image>>& region_images)
+                                     -> Result<Image, RegionRenderError> {
+    std::vector<std::optional<Rect>> rects(regions.size());
+    std::optional<Rect> bounding_rect;
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (region_images[i].has_value()) {
+            const Image& image = region_images[i].value();
+            rects[i] = Rect(image.dst_x, image.dst_y, image.dst_x + image.width, image.dst_y + image.height);
+        } else {
+            rects[i] = region_renderer_.CalculateRegionRect(*regions[i]);
+        }
 
-    Rect rect(images[0].dst_x, images[0].dst_y, images[0].dst_x, images[0].dst_y);
+        if (!rects[i]) {
+            continue;  // Skip region which is too small
+        } else if (!bounding_rect) {
+            bounding_rect = rects[i];
+        } else {
+            bounding_rect->Include(rects[i]->left, rects[i]->top);  // top left corner
+            bounding_rect->Include(rects[i]->right - 1, rects[i]->bottom - 1);  // bottom right corner
+        }
+    }
 
-    for (auto& image : images) {
-        rect.Include(image.dst_x, image.dst_y);  // top left corner
-        rect.Include(image.dst_x + image.width - 1, image.dst_y + image.height - 1);  // bottom right corner
+    if (!bounding_rect) {
+        return aribcaption::Err(RegionRenderError::kImageTooSmall);
     }
 
-    Bitmap bitmap(rect.width(), rect.height(), PixelFormat::kRGBA8888);
+    Bitmap bitmap(bounding_rect->width(), bounding_rect->height(), PixelFormat::kRGBA8888,
+                  region_render_settings_.bitmap_pool);
     Canvas canvas(bitmap);
 
-    for (auto& image : images) {
-        int x = image.dst_x - rect.left;
-        int y = image.dst_y - rect.top;
-        Bitmap bmp = Bitmap::FromImage(std::move(image));
-        canvas.DrawBitmap(bmp, x, y);
+    for (size_t i = 0; i < regions.size(); i++) {
+        if (!rects[i]) {
+            continue;
+        }
+
+        bool overlapped = false;
+        for (size_t j = 0; j < i && !overlapped; j++) {
+            if (rects[j]) {
+                Rect intersection = Rect::ClipRect(rects[i].value(), rects[j].value());
+                overlapped = intersection.width() > 0 && intersection.height() > 0;
+            }
+        }
+
+        int x = rects[i]->left - bounding_rect->left;
+        int y = rects[i]->top - bounding_rect->top;
+
+        if (!region_images[i] && !overlapped) {
+            Bitmap region_bitmap = Bitmap::SubBitmap(bitmap, Rect(x, y, x + rects[i]->width(), y + rects[i]->height()));
+            if (auto error = region_renderer_.DrawCaptionRegion(*regions[i], caption.drcs_map, region_bitmap)) {
+                return aribcaption::Err(error.value());
+            }
+            if (const std::optional<Rect>& drawn = region_bitmap.drawn_rect()) {
+                bitmap.MarkDrawn(Rect(x + drawn->left, y + drawn->top, x + drawn->right, y + drawn->bottom));
+            }
+            continue;
+        }
+
+        std::optional<Image> rendered;
+        if (!region_images[i]) {
+            auto result = region_renderer_.RenderCaptionRegion(*regions[i], caption.drcs_map);
+            if (result.is_err() && result.error() == RegionRenderError::kImageTooSmall) {
+                continue;  // Cropped to nothing
+            } else if (result.is_err()) {
+                return aribcaption::Err(result.error());
+            }
+            rendered = std::move(result.value());
+        }
+
+        // Position of the image, which may have been cropped within the region
+        const Image& image = region_images[i] ? region_images[i].value() : rendered.value();
+        x = image.dst_x - bounding_rect->left;
+        y = image.dst_y - bounding_rect->top;
+
+        if (overlapped) {
+            canvas.DrawImage(image, x, y);
+        } else {
+            auto line_size = static_cast<size_t>(image.width) * sizeof(ColorRGBA);
+            for (int line = 0; line < image.height; line++) {
+                const uint8_t* src = image.bitmap.data() + static_cast<size_t>(line) * image.stride;
+                memcpy(bitmap.GetPixelAt(x, y + line), src, line_size);
+            }
+            bitmap.MarkDrawn(Rect(x, y, x + image.width, y + image.height));
+        }
     }
 
-    Image merged = Bitmap::ToImage(std::move(bitmap));
-    merged.dst_x = rect.left;
-    merged.dst_y = rect.top;
-    return merged;
+    return region_renderer_.ToRegionImage(std::move(bitmap), bounding_rect->left, bounding_rect->top);
 }
 
-void RendererImpl::AdjustCaptionArea(int origin_plane_width, int origin_plane_height) {
+const std::vector<std::string>& RendererImpl::ResolveFontFamily(uint32_t iso6392_language_code) {
+    uint32_t language_code = iso6392_language_code;
+    if (force_default_font_family_ || language_font_family_.find(language_code) == language_font_family_.end()) {
+        language_code = 0;
+    }
+    return language_font_family_[language_code];
+}
+
+Rect RendererImpl::CalculateCaptionArea(int origin_plane_width, int origin_plane_height) const {
     float x_magnification = static_cast<float>(video_area_width_) / static_cast<float>(origin_plane_width);
     float y_magnification = static_cast<float>(video_area_height_) / static_cast<float>(origin_plane_height);
     float magnification = std::min(x_magnification, y_magnification);
@@ -462,18 +1017,24 @@ void RendererImpl::AdjustCaptionArea(int origin_plane_width, int origin_plane_he
     int caption_area_start_x = (video_area_width_ - caption_area_width) / 2;
     int caption_area_start_y = (video_area_height_ - caption_area_height) / 2;
 
-    Rect caption_area(caption_area_start_x,
-                      caption_area_start_y,
-                      caption_area_start_x + caption_area_width,
-                      caption_area_start_y + caption_area_height);
+    return Rect(caption_area_start_x,
+                caption_area_start_y,
+                caption_area_start_x + caption_area_width,
+                caption_area_start_y + caption_area_height);
+}
 
+void RendererImpl::AdjustCaptionArea(int origin_plane_width, int origin_plane_height) {
     region_renderer_.SetOriginalPlaneSize(origin_plane_width, origin_plane_height);
-    region_renderer_.SetTargetCaptionAreaRect(caption_area);
+    region_renderer_.SetTargetCaptionAreaRect(CalculateCaptionArea(origin_plane_width, origin_plane_height));
 }
 
 void RendererImpl::Flush() {
-    captions_.clear();
+    captions_.Clear();
+    ClearRegionImageCache();
     InvalidatePrevRenderedImages();
+
+    last_render_pts_ = PTS_NOPTS;
+    ScheduleRenderAhead(true);
 }
 
 void RendererImpl::InvalidatePrevRenderedImages() {
@@ -483,4 +1044,264 @@ void RendererImpl::InvalidatePrevRenderedImages() {
     prev_rendered_images_.clear();
 }
 
+void RendererImpl::ClearRegionImageCache() {
+    std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+    region_image_cache_.Clear();
+    region_image_cache_generation_++;
+}
+
+void RendererImpl::ApplyRegionRenderSettings(RegionRenderer& renderer, const RegionRenderSettings& settings) {
+    renderer.SetStrokeWidth(settings.stroke_width);
+    renderer.SetReplaceDRCS(settings.replace_drcs);
+    renderer.SetDRCSScaleMode(settings.drcs_scale_mode);
+    renderer.SetForceStrokeText(settings.force_stroke_text);
+    renderer.SetForceNoBackground(settings.force_no_background);
+    renderer.SetCropToContent(settings.crop_to_content);
+    renderer.SetReplaceMSZHalfWidthGlyph(settings.replace_msz_halfwidth_glyph);
+    renderer.SetBitmapPool(settings.bitmap_pool);
+}
+
+void RendererImpl::SetupRegionRenderer(RegionRenderer& renderer,
+                                       const RegionRenderSettings& settings,
+                                       const Caption& caption,
+                                       const std::vector<std::string>& font_family,
+                                       const Rect& caption_area) {
+    ApplyRegionRenderSettings(renderer, settings);
+    renderer.SetFontLanguage(caption.iso6392_language_code);
+    renderer.SetFontFamily(font_family);
+    renderer.SetOriginalPlaneSize(caption.plane_width, caption.plane_height);
+    renderer.SetTargetCaptionAreaRect(caption_area);
+}
+
+// Schedule the next render_ahead_count_ captions after the latest Render() PTS.
+// Rescheduling is skipped if neither the window nor the cache generation has changed, unless forced.
+void RendererImpl::ScheduleRenderAhead(bool force) {
+    if (!render_ahead_thread_.joinable() || !frame_size_inited_ || !margins_inited_) {
+        return;
+    }
+
+    auto iter = last_render_pts_ == PTS_NOPTS ? captions_.begin() : captions_.UpperBound(last_render_pts_);
+    int64_t first_pts = iter == captions_.end() ? PTS_NOPTS : iter->pts;
+
+    // region_image_cache_generation_ is only written from this thread, no need to lock for reading
+    if (!force &&
+            first_pts == render_ahead_scheduled_pts_ &&
+            region_image_cache_generation_ == render_ahead_scheduled_generation_) {
+        return;
+    }
+    render_ahead_scheduled_pts_ = first_pts;
+    render_ahead_scheduled_generation_ = region_image_cache_generation_;
+
+    std::deque<RenderAheadTask> tasks;
+    for (size_t i = 0; i < render_ahead_count_ && iter != captions_.end(); i++, ++iter) {
+        const Caption& caption = *iter;
+        if (caption.regions.empty()) {
+            continue;
+        }
+
+        RenderAheadTask task;
+        task.caption = caption;
+        task.font_family = ResolveFontFamily(caption.iso6392_language_code);
+        task.caption_area = CalculateCaptionArea(caption.plane_width, caption.plane_height);
+        task.settings = region_render_settings_;
+        task.force_no_ruby = force_no_ruby_;
+        task.cache_generation = region_image_cache_generation_;
+        tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(render_ahead_mutex_);
+        render_ahead_tasks_ = std::move(tasks);
+    }
+    render_ahead_cv_.notify_one();
+}
+
+void RendererImpl::StopRenderAhead() {
+    if (!render_ahead_thread_.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(render_ahead_mutex_);
+        render_ahead_stop_ = true;
+        render_ahead_tasks_.clear();
+    }
+    render_ahead_cv_.notify_one();
+    render_ahead_thread_.join();
+
+    render_ahead_renderer_.reset();
+    render_ahead_scheduled_pts_ = PTS_NOPTS;
+    render_ahead_memory_usage_ = RendererMemoryUsage{};
+    render_ahead_trim_bytes_ = 0;
+}
+
+void RendererImpl::RenderAheadThreadProc() {
+    std::unique_lock<std::mutex> lock(render_ahead_mutex_);
+
+    while (true) {
+        render_ahead_cv_.wait(lock, [this] {
+            return render_ahead_stop_ || !render_ahead_tasks_.empty() || render_ahead_trim_bytes_ > 0;
+        });
+        if (render_ahead_stop_) {
+            break;
+        }
+
+        std::optional<RenderAheadTask> task;
+        if (!render_ahead_tasks_.empty()) {
+            task = std::move(render_ahead_tasks_.front());
+            render_ahead_tasks_.pop_front();
+        }
+        size_t trim_bytes = std::exchange(render_ahead_trim_bytes_, 0);
+
+        lock.unlock();
+        if (task) {
+            RenderAhead(*task);
+        }
+        if (trim_bytes > 0) {
+            render_ahead_renderer_->TrimCaches(trim_bytes);
+        }
+        RendererMemoryUsage usage;
+        render_ahead_renderer_->AccumulateMemoryUsage(usage);
+        lock.lock();
+
+        render_ahead_memory_usage_ = usage;
+    }
+}
+
+// Runs on the render-ahead thread
+void RendererImpl::RenderAhead(const RenderAheadTask& task) {
+    RegionRenderer& renderer = *render_ahead_renderer_;
+    const Caption& caption = task.caption;
+
+    SetupRegionRenderer(renderer, task.settings, caption, task.font_family, task.caption_area);
+
+    for (const CaptionRegion& region : caption.regions) {
+        if (render_ahead_stop_) {
+            return;
+        }
+        if (region.is_ruby && task.force_no_ruby) {
+            continue;
+        }
+
+        uint64_t region_hash = HashRegion(region, caption);
+        {
+            std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+            if (region_image_cache_generation_ != task.cache_generation) {
+                // Settings have been changed since scheduled, discard
+                return;
+            }
+            if (region_image_cache_.Contains(region_hash)) {
+                continue;
+            }
+        }
+
+        // Errors are left to be reported by Render()
+        Result<Image, RegionRenderError> result = renderer.RenderCaptionRegion(region, caption.drcs_map);
+        if (!result.is_ok()) {
+            continue;
+        }
+
+        Image& image = result.value();
+        size_t cost = sizeof(Image) + image.bitmap.size();
+
+        std::lock_guard<std::mutex> lock(region_image_cache_mutex_);
+        if (region_image_cache_generation_ == task.cache_generation) {
+            region_image_cache_.Put(region_hash, std::move(image), cost);
+        }
+    }
+}
+
+namespace {
+
+// FNV-1a 64bit
+class Hasher {
+public:
+    template <typename T>
+    void Update(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        Update(&value, sizeof(T));
+    }
+
+    void Update(const void* data, size_t size) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash_ = (hash_ ^ bytes[i]) * 0x100000001B3ULL;
+        }
+    }
+
+    [[nodiscard]]
+    uint64_t hash() const { return hash_; }
+private:
+    uint64_t hash_ = 0xCBF29CE484222325ULL;
+};
+
+}  // namespace
+
+uint64_t RendererImpl::HashMergedRegions(const std::vector<uint64_t>& region_hashes) {
+    Hasher hasher;
+
+    // Distinguish from the hashes of single regions
+    hasher.Update(static_cast<uint32_t>(region_hashes.size()));
+    for (uint64_t region_hash : region_hashes) {
+        hasher.Update(region_hash);
+    }
+
+    return hasher.hash();
+}
+
+// Hash everything that affects the rendered image of a region.
+// Render settings are not included, the cache is cleared once they are changed.
+uint64_t RendererImpl::HashRegion(const CaptionRegion& region, const Caption& caption) {
+    Hasher hasher;
+
+    // Caption context: origin plane size decides the caption area & scaling, language decides font family
+    hasher.Update(caption.plane_width);
+    hasher.Update(caption.plane_height);
+    hasher.Update(caption.iso6392_language_code);
+
+    hasher.Update(region.x);
+    hasher.Update(region.y);
+    hasher.Update(region.width);
+    hasher.Update(region.height);
+
+    for (const CaptionChar& ch : region.chars) {
+        hasher.Update(ch.type);
+        hasher.Update(ch.codepoint);
+        hasher.Update(ch.pua_codepoint);
+        hasher.Update(ch.drcs_code);
+        hasher.Update(ch.x);
+        hasher.Update(ch.y);
+        hasher.Update(ch.char_width);
+        hasher.Update(ch.char_height);
+        hasher.Update(ch.char_horizontal_spacing);
+        hasher.Update(ch.char_vertical_spacing);
+        hasher.Update(ch.char_horizontal_scale);
+        hasher.Update(ch.char_vertical_scale);
+        hasher.Update(ch.text_color.u32);
+        hasher.Update(ch.back_color.u32);
+        hasher.Update(ch.stroke_color.u32);
+        hasher.Update(ch.style);
+        hasher.Update(ch.enclosure_style);
+        hasher.Update(ch.u8str, sizeof(ch.u8str));
+
+        if (ch.type == CaptionCharType::kDRCS || ch.type == CaptionCharType::kDRCSReplaced) {
+            auto iter = caption.drcs_map.find(ch.drcs_code);
+            if (iter == caption.drcs_map.end()) {
+                hasher.Update(false);
+                continue;
+            }
+            const DRCS& drcs = iter->second;
+            hasher.Update(true);
+            hasher.Update(drcs.width);
+            hasher.Update(drcs.height);
+            hasher.Update(drcs.depth);
+            hasher.Update(drcs.depth_bits);
+            hasher.Update(drcs.alternative_ucs4);
+            hasher.Update(drcs.pixels.data(), drcs.pixels.size());
+        }
+    }
+
+    return hasher.hash();
+}
+
 }  // namespace aribcaption::internal
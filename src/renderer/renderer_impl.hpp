@@ -19,14 +19,23 @@
 #ifndef ARIBCAPTION_RENDERER_IMPL_HPP
 #define ARIBCAPTION_RENDERER_IMPL_HPP
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
-#include <map>
 #include "aribcaption/caption.hpp"
 #include "aribcaption/renderer.hpp"
 #include "base/logger.hpp"
+#include "base/lru_cache.hpp"
+#include "renderer/bitmap_pool.hpp"
+#include "renderer/caption_store.hpp"
 #include "renderer/region_renderer.hpp"
+#include "renderer/region_renderer_pool.hpp"
 
 namespace aribcaption::internal {
 
@@ -35,16 +44,20 @@ public:
     explicit RendererImpl(Context& context);
     ~RendererImpl();
 public:
+    bool SetFontSearchPaths(const std::vector<std::string>& paths, const std::string& index_cache_path);
     bool Initialize(CaptionType caption_type = CaptionType::kCaption,
                     FontProviderType font_provider_type = FontProviderType::kAuto,
                     TextRendererType text_renderer_type = TextRendererType::kAuto);
 
     void SetStrokeWidth(float dots);
     void SetReplaceDRCS(bool replace);
+    void SetDRCSScaleMode(DRCSScaleMode mode);
     void SetForceStrokeText(bool force_stroke);
     void SetForceNoRuby(bool force_no_ruby);
     void SetForceNoBackground(bool force_no_background);
+    void SetCropImagesToContent(bool crop);
     void SetMergeRegionImages(bool merge);
+    void SetOutputPixelFormat(PixelFormat pixel_format);
 
     bool SetDefaultFontFamily(const std::vector<std::string>& font_family, bool force_default);
     bool SetLanguageSpecificFontFamily(uint32_t language_code, const std::vector<std::string>& font_family);
@@ -53,20 +66,85 @@ public:
     bool SetMargins(int top, int bottom, int left, int right);
 
     void SetStoragePolicy(CaptionStoragePolicy policy, std::optional<size_t> upper_limit = std::nullopt);
+    bool SetRenderAheadCount(size_t count);
+    bool SetRenderThreadCount(size_t count);
+
+    RendererMemoryUsage GetMemoryUsage();
+    void SetMemoryBudget(size_t bytes);
 
     bool AppendCaption(const Caption& caption);
     bool AppendCaption(Caption&& caption);
 
     RenderStatus TryRender(int64_t pts);
     RenderStatus Render(int64_t pts, RenderResult& out_result);
+
+    // Damage rects of the latest Render() call, kept for the C API
+    [[nodiscard]]
+    const std::vector<DamageRect>& last_damage_rects() const { return last_damage_rects_; }
+
+    // Palette shared by images of the latest Render() call for kPAL8, kept for the C API
+    [[nodiscard]]
+    const std::vector<ColorRGBA>& last_palette() const { return last_palette_; }
+    RenderStatus RenderToFrame(int64_t pts, VideoFrame& frame);
     void Flush();
+private:
+    // Settings applied to RegionRenderer, kept for configuring the render-ahead RegionRenderer
+    struct RegionRenderSettings {
+        float stroke_width = 1.5f;
+        bool replace_drcs = true;
+        DRCSScaleMode drcs_scale_mode = DRCSScaleMode::kAreaAveraging;
+        bool force_stroke_text = false;
+        bool force_no_background = false;
+        bool crop_to_content = false;
+        bool replace_msz_halfwidth_glyph = true;
+        std::shared_ptr<BitmapPool> bitmap_pool;
+    };
+
+    // A caption to be rendered ahead, with a snapshot of the settings at the time of scheduling
+    struct RenderAheadTask {
+        Caption caption;
+        std::vector<std::string> font_family;
+        Rect caption_area;
+        RegionRenderSettings settings;
+        bool force_no_ruby = false;
+        uint64_t cache_generation = 0;
+    };
+
+    // A region being displayed by the consumer, for reporting damaged areas between renders
+    struct DisplayedRegion {
+        uint64_t hash = 0;
+        Rect rect;
+    };
 private:
     void LoadDefaultFontFamilies();
     void CleanupCaptionsIfNecessary();
+    void EnforceMemoryBudget();
+    const std::vector<std::string>& ResolveFontFamily(uint32_t iso6392_language_code);
+    Rect CalculateCaptionArea(int origin_plane_width, int origin_plane_height) const;
     void AdjustCaptionArea(int origin_plane_width, int origin_plane_height);
+    const Caption* FindCaption(int64_t pts);
+    RenderStatus RenderImages(int64_t pts, RenderResult& out_result);
+    RenderStatus DrawRegionsToFrame(int64_t pts, VideoFrame& frame);
+    std::vector<DamageRect> UpdateDisplayedRegions(std::vector<DisplayedRegion>&& regions,
+                                                   std::vector<ColorRGBA>&& palette);
     void InvalidatePrevRenderedImages();
+    void ClearRegionImageCache();
+    void ScheduleRenderAhead(bool force);
+    void StopRenderAhead();
+    void RenderAheadThreadProc();
+    void RenderAhead(const RenderAheadTask& task);
+    auto DrawMergedRegions(const Caption& caption,
+                           const std::vector<const CaptionRegion*>& regions,
+                           const std::vector<std::optional<Image>>& region_images) -> Result<Image, RegionRenderError>;
 private:
-    static Image MergeImages(std::vector<Image>& images);
+    static void ApplyRegionRenderSettings(RegionRenderer& renderer, const RegionRenderSettings& settings);
+    static void SetupRegionRenderer(RegionRenderer& renderer,
+                                    const RegionRenderSettings& settings,
+                                    const Caption& caption,
+                                    const std::vector<std::string>& font_family,
+                                    const Rect& caption_area);
+    static uint64_t HashRegion(const CaptionRegion& region, const Caption& caption);
+    static uint64_t HashMergedRegions(const std::vector<uint64_t>& region_hashes);
 public:
     RendererImpl(const RendererImpl&) = delete;
     RendererImpl& operator=(const RendererImpl&) = delete;
@@ -75,6 +153,12 @@ private:
     std::shared_ptr<Logger> log_;
 
     CaptionType expected_caption_type_ = CaptionType::kDefault;
+    FontProviderType font_provider_type_ = FontProviderType::kAuto;
+    TextRendererType text_renderer_type_ = TextRendererType::kAuto;
+    bool inited_ = false;
+
+    // Index of font search paths for FontProviderType::kDirectory, shared by all RegionRenderers
+    std::shared_ptr<const FontIndex> font_index_;
 
     // iso639_language_code => FontFamily
     // language code 0 as default FontFamily
@@ -102,19 +186,57 @@ private:
     CaptionStoragePolicy storage_policy_ = CaptionStoragePolicy::kMinimum;
     size_t upper_limit_count_ = 0;
     size_t upper_limit_duration_ = 0;
+    size_t upper_limit_bytes_ = 0;
+
+    size_t memory_budget_ = 0;  // in bytes, 0 for unlimited
 
     bool merge_region_images_ = false;
+    PixelFormat output_pixel_format_ = PixelFormat::kRGBA8888;
 
-    // PTS => Caption
     // Sorted by PTS incrementally
-    std::map<int64_t, Caption> captions_;
+    CaptionStore captions_;
 
     RegionRenderer region_renderer_;
+    RegionRenderSettings region_render_settings_;
+
+    // Renders uncached regions of a caption concurrently, nullptr if single-threaded
+    std::unique_ptr<RegionRendererPool> region_renderer_pool_;
+
+    // Hash of region content & caption context => rendered region Image
+    // Regions are frequently resent unchanged within a new caption, e.g. roll-up / paint-on captions
+    // Shared with the render-ahead thread, guarded by region_image_cache_mutex_
+    static constexpr size_t kRegionImageCacheCapacity = 16 * 1024 * 1024;  // in bytes
+    std::mutex region_image_cache_mutex_;
+    LRUCache<uint64_t, Image> region_image_cache_{kRegionImageCacheCapacity};
+    uint64_t region_image_cache_generation_ = 0;  // Increased on every clear, written under the mutex
+
+    // Render-ahead, renders upcoming captions into region_image_cache_ on a worker thread
+    size_t render_ahead_count_ = 0;
+    int64_t last_render_pts_ = PTS_NOPTS;
+    int64_t render_ahead_scheduled_pts_ = PTS_NOPTS;
+    uint64_t render_ahead_scheduled_generation_ = 0;
+    std::unique_ptr<RegionRenderer> render_ahead_renderer_;  // Accessed by the worker thread only
+    std::thread render_ahead_thread_;
+    std::mutex render_ahead_mutex_;
+    std::condition_variable render_ahead_cv_;
+    std::deque<RenderAheadTask> render_ahead_tasks_;  // guarded by render_ahead_mutex_
+    std::atomic<bool> render_ahead_stop_ = false;
+    RendererMemoryUsage render_ahead_memory_usage_;  // of render_ahead_renderer_, guarded by render_ahead_mutex_
+    // Requested eviction of render_ahead_renderer_, guarded by render_ahead_mutex_
+    size_t render_ahead_trim_bytes_ = 0;
 
     bool has_prev_rendered_caption_ = false;
     int64_t prev_rendered_caption_pts_ = PTS_NOPTS;
     int64_t prev_rendered_caption_duration_ = 0;
     std::vector<Image> prev_rendered_images_;
+
+    // Regions of the last returned kGotImage, cleared once no image has been returned
+    std::vector<DisplayedRegion> displayed_regions_;
+    uint64_t displayed_regions_generation_ = 0;
+    PixelFormat displayed_regions_pixel_format_ = PixelFormat::kRGBA8888;
+    std::vector<ColorRGBA> displayed_regions_palette_;  // Palette of displayed regions for kPAL8, empty otherwise
+    std::vector<DamageRect> last_damage_rects_;
+    std::vector<ColorRGBA> last_palette_;
 };
 
 }  // namespace aribcaption::internal
@@ -82,4 +82,15 @@ void TextRenderer::SetReplaceMSZHalfWidthGlyph(bool replace) {
     (void)replace;
 }
 
+void TextRenderer::AccumulateMemoryUsage(RendererMemoryUsage& usage) const {
+    // No-OP
+    (void)usage;
+}
+
+size_t TextRenderer::TrimCaches(size_t bytes) {
+    // No-OP
+    (void)bytes;
+    return 0;
+}
+
 }  // namespace aribcaption
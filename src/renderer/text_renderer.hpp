@@ -93,6 +93,12 @@ public:
     virtual void SetLanguage(uint32_t iso6392_language_code) = 0;
     virtual bool SetFontFamily(const std::vector<std::string>& font_family) = 0;
     virtual void SetReplaceMSZHalfWidthGlyph(bool replace);
+
+    // Add memory held by loaded fonts and glyph caches into usage, nothing is added by default
+    virtual void AccumulateMemoryUsage(RendererMemoryUsage& usage) const;
+
+    // Evict cached glyphs to free up to bytes, returns freed bytes
+    virtual size_t TrimCaches(size_t bytes);
     virtual auto BeginDraw(Bitmap& target_bmp) -> TextRenderContext = 0;
     virtual void EndDraw(TextRenderContext& context) = 0;
     virtual auto DrawChar(TextRenderContext& render_ctx, int x, int y,
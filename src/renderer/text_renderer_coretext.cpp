@@ -262,6 +262,13 @@ auto TextRendererCoreText::DrawChar(TextRenderContext& render_ctx, int target_x,
 
     CGContextRestoreGState(ctx.get());
 
+    // CoreText draws into the bitmap directly, mark the char box as drawn, with margins for overflowing strokes
+    int margin = static_cast<int>(std::ceil(stroke_width)) + 1;
+    render_ctx.GetBitmap().MarkDrawn(Rect(target_x - margin,
+                                          target_y - margin,
+                                          target_x + char_width + margin,
+                                          target_y + char_height + margin));
+
     return TextRenderStatus::kOK;
 }
 
@@ -679,6 +679,7 @@ bool TextRendererDirectWrite::BlendWICBitmapToBitmap(IWICBitmap* wic_bitmap,
         auto src_begin = reinterpret_cast<const ColorRGBA*>(buffer + src_begin_offset);
         alphablend::BlendLine_PremultipliedSrc(dest_begin, src_begin, line_width);
     }
+    target_bmp.MarkDrawn(clipped);
 
     return true;
 }
@@ -16,6 +16,7 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <cstdint>
@@ -24,11 +25,9 @@
 #include "base/scoped_holder.hpp"
 #include "base/unicode_helper.hpp"
 #include "base/utf_helper.hpp"
-#include "renderer/alphablend.hpp"
 #include "renderer/canvas.hpp"
 #include "renderer/open_type_gsub.hpp"
 #include "renderer/text_renderer_freetype.hpp"
-#include FT_STROKER_H
 #include FT_SFNT_NAMES_H
 #include FT_TRUETYPE_IDS_H
 #include FT_TRUETYPE_TABLES_H
@@ -50,6 +49,15 @@ bool TextRendererFreetype::Initialize() {
     }
 
     library_ = ScopedHolder<FT_Library>(library, FT_Done_FreeType);
+
+    FT_Stroker stroker;
+    error = FT_Stroker_New(library_, &stroker);
+    if (error) {
+        log_->e("Freetype: FT_Stroker_New() failed");
+        return false;
+    }
+
+    stroker_ = ScopedHolder<FT_Stroker>(stroker, FT_Stroker_Done);
     return true;
 }
 
@@ -63,16 +71,23 @@ bool TextRendererFreetype::SetFontFamily(const std::vector<std::string>& font_fa
         return false;
     }
 
-    if (!font_family_.empty() && font_family_ != font_family) {
-        // Reset Freetype faces
-        main_face_.Reset();
-        fallback_face_.Reset();
-        main_face_data_.clear();
-        fallback_face_data_.clear();
-        main_face_index_ = 0;
+    auto iter = std::find_if(face_sets_.begin(), face_sets_.end(), [&font_family](const FaceSet& face_set) {
+        return face_set.font_family == font_family;
+    });
+    if (iter != face_sets_.end()) {
+        // Switch to the loaded faces, e.g. on bilingual services alternating between languages
+        face_sets_.splice(face_sets_.begin(), face_sets_, iter);
+        return true;
+    }
+
+    if (face_sets_.size() >= kMaxFaceSets) {
+        // Evict the least recently used face set
+        PurgeGlyphCache(face_sets_.back());
+        face_sets_.pop_back();
     }
 
-    font_family_ = font_family;
+    face_sets_.emplace_front();
+    face_sets_.front().font_family = font_family;
     return true;
 }
 
@@ -116,55 +131,31 @@ auto TextRendererFreetype::DrawChar(TextRenderContext& render_ctx, int target_x,
         return TextRenderStatus::kOK;
     }
 
-    if (!main_face_) {
-        // If main FT_Face is not yet loaded, try load FT_Face from font_family_
+    if (face_sets_.empty()) {
+        log_->e("Freetype: Font family is not set");
+        return TextRenderStatus::kFontNotFound;
+    }
+    FaceSet& face_set = face_sets_.front();
+
+    if (!face_set.main_face) {
+        // If main FT_Face is not yet loaded, try load FT_Face from face_set.font_family
         // We don't care about the codepoint (ucs4) now
-        auto result = LoadFontFace(false);
+        auto result = LoadFontFace(face_set.main_face_data);
         if (result.is_err()) {
             log_->e("Freetype: Cannot find valid font");
             return FontProviderErrorToStatus(result.error());
         }
         std::pair<FT_Face, size_t>& pair = result.value();
-        main_face_ = ScopedHolder<FT_Face>(pair.first, FT_Done_Face);
-        main_face_index_ = pair.second;
+        face_set.main_face = ScopedHolder<FT_Face>(pair.first, FT_Done_Face);
+        face_set.main_face_index = pair.second;
     }
 
-    FT_Face face = main_face_;
-    FT_UInt glyph_index = FT_Get_Char_Index(face, ucs4);
-
-    if (glyph_index == 0) {
-        log_->w("Freetype: Main font %s doesn't contain U+%04X", face->family_name, ucs4);
-
-        if (fallback_policy == TextRenderFallbackPolicy::kFailOnCodePointNotFound) {
-            return TextRenderStatus::kCodePointNotFound;
-        }
-
-        // Missing glyph, check fallback face
-        if (fallback_face_ && (glyph_index = FT_Get_Char_Index(fallback_face_, ucs4))) {
-            face = fallback_face_;
-        } else if (main_face_index_ + 1 >= font_family_.size()) {
-            // Fallback fonts not available
-            return TextRenderStatus::kCodePointNotFound;
-        } else {
-            // Fallback fontface not loaded, or fallback fontface doesn't contain required codepoint
-            // Load next fallback font face by specific codepoint
-            auto result = LoadFontFace(true, ucs4, main_face_index_ + 1);
-            if (result.is_err()) {
-                log_->e("Freetype: Cannot find available fallback font for U+%04X", ucs4);
-                return FontProviderErrorToStatus(result.error());
-            }
-            std::pair<FT_Face, size_t>& pair = result.value();
-            fallback_face_ = ScopedHolder<FT_Face>(pair.first, FT_Done_Face);
-
-            // Use this fallback fontface for rendering this time
-            face = fallback_face_;
-            glyph_index = FT_Get_Char_Index(face, ucs4);
-            if (glyph_index == 0) {
-                log_->e("Freetype: Got glyph_index == 0 for U+%04X in fallback font", ucs4);
-                return TextRenderStatus::kCodePointNotFound;
-            }
-        }
+    ResolvedCodePoint resolved = ResolveCodePoint(face_set, ucs4, fallback_policy);
+    if (resolved.status != TextRenderStatus::kOK) {
+        return resolved.status;
     }
+    FT_Face face = resolved.face;
+    FT_UInt glyph_index = resolved.glyph_index;
 
     // If aspect_ratio is 0.5 (1:2), this should be MSZ (Middle size)
     bool is_requesting_halfwidth = floating::AlmostEquals(aspect_ratio, 0.5f, 0.05f);
@@ -173,88 +164,54 @@ auto TextRendererFreetype::DrawChar(TextRenderContext& render_ctx, int target_x,
         char_width = char_height;
     }
 
+    bool halfwidth_substituted = false;
     if (replace_msz_halfwidth_glyph_ && is_requesting_halfwidth) {
-        if (face == main_face_) {
-            if (!main_halfwidth_subst_map_) {
-                main_halfwidth_subst_map_ =
-                    LoadSingleGSUBTable(LoadSFNTTable(face, FT_MAKE_TAG('G', 'S', 'U', 'B')), kOpenTypeFeatureHalfWidth,
-                                        kOpenTypeScriptHiraganaKatakana, kOpenTypeLangSysJapanese);
-            }
-        } else if (fallback_face_ && face == fallback_face_) {
-            if (!fallback_halfwidth_subst_map_) {
-                fallback_halfwidth_subst_map_ =
-                    LoadSingleGSUBTable(LoadSFNTTable(face, FT_MAKE_TAG('G', 'S', 'U', 'B')), kOpenTypeFeatureHalfWidth,
-                                        kOpenTypeScriptHiraganaKatakana, kOpenTypeLangSysJapanese);
-            }
+        auto& subst_map = *resolved.halfwidth_subst_map;
+        if (!subst_map) {
+            subst_map = LoadSingleGSUBTable(LoadSFNTTable(face, FT_MAKE_TAG('G', 'S', 'U', 'B')),
+                                            kOpenTypeFeatureHalfWidth,
+                                            kOpenTypeScriptHiraganaKatakana,
+                                            kOpenTypeLangSysJapanese);
         }
-        auto& subst_map = face == main_face_ ? main_halfwidth_subst_map_ : fallback_halfwidth_subst_map_;
         if (subst_map) {
             auto subst = subst_map->find(glyph_index);
             if (subst != subst_map->end()) {
                 glyph_index = subst->second;
                 char_width = char_height;
+                halfwidth_substituted = true;
             }
         }
     }
 
-    if (FT_Set_Pixel_Sizes(face, static_cast<FT_UInt>(char_width), static_cast<FT_UInt>(char_height))) {
-        log_->e("Freetype: FT_Set_Pixel_Sizes failed");
+    GlyphCacheKey cache_key{face, glyph_index, char_width, char_height, halfwidth_substituted, 0};
+    const CachedGlyph* cached = LookupOrRasterizeGlyph(cache_key);
+    if (!cached) {
         return TextRenderStatus::kOtherError;
     }
 
-    int baseline = static_cast<int>(face->size->metrics.ascender >> 6);
-    int ascender = static_cast<int>(face->size->metrics.ascender >> 6);
-    int descender = static_cast<int>(face->size->metrics.descender >> 6);
-    int underline = static_cast<int>(FT_MulFix(face->underline_position, face->size->metrics.x_scale) >> 6);
-    int underline_thickness = static_cast<int>(FT_MulFix(face->underline_thickness, face->size->metrics.x_scale) >> 6);
-
-    int em_height = ascender + std::abs(descender);
+    int baseline = cached->ascender;
+    int em_height = cached->ascender + std::abs(cached->descender);
     int em_adjust_y = (char_height - em_height) / 2;
-
-    if (FT_Load_Glyph(face, glyph_index, FT_LOAD_NO_BITMAP)) {
-        log_->e("Freetype: FT_Load_Glyph failed");
-        return TextRenderStatus::kOtherError;
-    }
-
-    // Generate glyph bitmap for filling
-    ScopedHolder<FT_Glyph> glyph_image(nullptr, FT_Done_Glyph);
-    if (FT_Get_Glyph(face->glyph, &glyph_image)) {
-        log_->e("Freetype: FT_Get_Glyph failed");
-        return TextRenderStatus::kOtherError;
-    }
-
-    if (FT_Glyph_To_Bitmap(&glyph_image, FT_RENDER_MODE_NORMAL, nullptr, true)) {
-        log_->e("Freetype: FT_Glyph_To_Bitmap failed");
-        return TextRenderStatus::kOtherError;
-    }
-
-    ScopedHolder<FT_Glyph> border_glyph_image(nullptr, FT_Done_Glyph);
+    int underline = cached->underline;
+    int underline_thickness = cached->underline_thickness;
 
     // If we need stroke text (border)
+    const CachedGlyph* border = nullptr;
     if (style & CharStyle::kCharStyleStroke && stroke_width > 0.0f) {
-        // Generate glyph bitmap for stroke border
-        ScopedHolder<FT_Glyph> stroke_glyph(nullptr, FT_Done_Glyph);
-        if (FT_Get_Glyph(face->glyph, &stroke_glyph)) {
-            log_->e("Freetype: FT_Get_Glyph failed");
+        GlyphCacheKey border_key = cache_key;
+        border_key.stroke_width = static_cast<FT_Fixed>(stroke_width * 64);
+        border = LookupOrRasterizeGlyph(border_key);
+        if (!border) {
             return TextRenderStatus::kOtherError;
         }
-
-        ScopedHolder<FT_Stroker> stroker(nullptr, FT_Stroker_Done);
-        FT_Stroker_New(library_, &stroker);
-        FT_Stroker_Set(stroker,
-                       static_cast<FT_Fixed>(stroke_width * 64),
-                       FT_STROKER_LINECAP_ROUND,
-                       FT_STROKER_LINEJOIN_ROUND,
-                       0);
-
-        FT_Glyph_StrokeBorder(&stroke_glyph, stroker, false, true);
-
-        if (FT_Glyph_To_Bitmap(&stroke_glyph, FT_RENDER_MODE_NORMAL, nullptr, true)) {
-            log_->e("Freetype: FT_Glyph_To_Bitmap failed");
-            return TextRenderStatus::kOtherError;
+        // Looking up the border may evict the filling glyph, fetch it again without counting another hit
+        cached = glyph_cache_.Peek(cache_key);
+        if (!cached) {
+            cached = LookupOrRasterizeGlyph(cache_key);
+            if (!cached) {
+                return TextRenderStatus::kOtherError;
+            }
         }
-
-        border_glyph_image = std::move(stroke_glyph);
     }
 
     Canvas canvas(render_ctx.GetBitmap());
@@ -281,40 +238,260 @@ auto TextRendererFreetype::DrawChar(TextRenderContext& render_ctx, int target_x,
     }
 
     // Draw stroke border bitmap, if required
-    if (border_glyph_image) {
-        auto border_bitmap_glyph = reinterpret_cast<FT_BitmapGlyph>(border_glyph_image.Get());
-        int start_x = target_x + border_bitmap_glyph->left;
-        int start_y = target_y + baseline + em_adjust_y - border_bitmap_glyph->top;
+    if (border && border->mask.width > 0 && border->mask.rows > 0) {
+        int start_x = target_x + border->mask.left;
+        int start_y = target_y + baseline + em_adjust_y - border->mask.top;
 
-        Bitmap bmp = FTBitmapToColoredBitmap(border_bitmap_glyph->bitmap, stroke_color);
-        canvas.DrawBitmap(bmp, start_x, start_y);
+        canvas.DrawAlphaMask(border->mask.buffer.data(), border->mask.width, border->mask.rows, border->mask.width,
+                             stroke_color, start_x, start_y);
     }
 
     // Draw filling bitmap
-    if (glyph_image) {
-        auto bitmap_glyph = reinterpret_cast<FT_BitmapGlyph>(glyph_image.Get());
-        int start_x = target_x + bitmap_glyph->left;
-        int start_y = target_y + baseline + em_adjust_y - bitmap_glyph->top;
+    if (cached->mask.width > 0 && cached->mask.rows > 0) {
+        int start_x = target_x + cached->mask.left;
+        int start_y = target_y + baseline + em_adjust_y - cached->mask.top;
 
-        Bitmap bmp = FTBitmapToColoredBitmap(bitmap_glyph->bitmap, color);
-        canvas.DrawBitmap(bmp, start_x, start_y);
+        canvas.DrawAlphaMask(cached->mask.buffer.data(), cached->mask.width, cached->mask.rows, cached->mask.width,
+                             color, start_x, start_y);
     }
 
     return TextRenderStatus::kOK;
 }
 
-Bitmap TextRendererFreetype::FTBitmapToColoredBitmap(const FT_Bitmap& ft_bmp, ColorRGBA color) {
-    Bitmap bitmap(static_cast<int>(ft_bmp.width), static_cast<int>(ft_bmp.rows), PixelFormat::kRGBA8888);
+auto TextRendererFreetype::ResolveCodePoint(FaceSet& face_set, uint32_t ucs4, TextRenderFallbackPolicy fallback_policy)
+        -> ResolvedCodePoint {
+    uint64_t key = (static_cast<uint64_t>(ucs4) << 1) |
+                   (fallback_policy == TextRenderFallbackPolicy::kFailOnCodePointNotFound ? 1 : 0);
+    auto iter = face_set.resolved_codepoints.find(key);
+    if (iter != face_set.resolved_codepoints.end()) {
+        return iter->second;
+    }
+
+    ResolvedCodePoint resolved = ResolveCodePointUncached(face_set, ucs4, fallback_policy);
+    if (resolved.status == TextRenderStatus::kOK ||
+            resolved.status == TextRenderStatus::kCodePointNotFound ||
+            resolved.status == TextRenderStatus::kFontNotFound) {
+        // Codepoints not found in any font are cached as well, which would be searched again otherwise
+        face_set.resolved_codepoints.emplace(key, resolved);
+    }
+    return resolved;
+}
+
+auto TextRendererFreetype::ResolveCodePointUncached(FaceSet& face_set, uint32_t ucs4,
+                                                    TextRenderFallbackPolicy fallback_policy) -> ResolvedCodePoint {
+    ResolvedCodePoint resolved;
+    resolved.face = face_set.main_face;
+    resolved.glyph_index = FT_Get_Char_Index(resolved.face, ucs4);
+    resolved.halfwidth_subst_map = &face_set.main_halfwidth_subst_map;
+    if (resolved.glyph_index) {
+        return resolved;
+    }
+
+    log_->w("Freetype: Main font %s doesn't contain U+%04X", resolved.face->family_name, ucs4);
+
+    if (fallback_policy == TextRenderFallbackPolicy::kFailOnCodePointNotFound) {
+        return ResolvedCodePoint{nullptr, 0, nullptr, TextRenderStatus::kCodePointNotFound};
+    }
+
+    // Missing glyph, look up loaded fallback faces by their coverage
+    std::list<FallbackFace>& fallback_faces = face_set.fallback_faces;
+    auto iter = std::find_if(fallback_faces.begin(), fallback_faces.end(), [ucs4](const FallbackFace& fallback) {
+        return fallback.Covers(ucs4);
+    });
+
+    FallbackFace* fallback_face = nullptr;
+    if (iter != fallback_faces.end()) {
+        fallback_faces.splice(fallback_faces.begin(), fallback_faces, iter);
+        fallback_face = &fallback_faces.front();
+    } else if (face_set.main_face_index + 1 >= face_set.font_family.size()) {
+        // Fallback fonts not available
+        return ResolvedCodePoint{nullptr, 0, nullptr, TextRenderStatus::kCodePointNotFound};
+    } else {
+        // No loaded fallback face contains required codepoint
+        // Load next fallback font face by specific codepoint
+        auto result = LoadFallbackFace(face_set, ucs4);
+        if (result.is_err()) {
+            return ResolvedCodePoint{nullptr, 0, nullptr, FontProviderErrorToStatus(result.error())};
+        }
+        fallback_face = result.value();
+    }
+
+    resolved.face = fallback_face->face;
+    resolved.glyph_index = FT_Get_Char_Index(resolved.face, ucs4);
+    resolved.halfwidth_subst_map = &fallback_face->halfwidth_subst_map;
+    return resolved;
+}
+
+static size_t CalculateSubstMapMemorySize(const std::optional<std::unordered_map<uint32_t, uint32_t>>& subst_map) {
+    if (!subst_map) {
+        return 0;
+    }
+    // Estimated as a node (next pointer & key-value pair) per entry plus the bucket array
+    constexpr size_t node_size = sizeof(void*) + sizeof(std::pair<const uint32_t, uint32_t>);
+    return subst_map->size() * node_size + subst_map->bucket_count() * sizeof(void*);
+}
+
+void TextRendererFreetype::AccumulateMemoryUsage(RendererMemoryUsage& usage) const {
+    for (const FaceSet& face_set : face_sets_) {
+        usage.font_data += face_set.main_face_data.capacity();
+        usage.font_data += CalculateSubstMapMemorySize(face_set.main_halfwidth_subst_map);
+        usage.font_data += face_set.resolved_codepoints.size() * (sizeof(void*) + sizeof(uint64_t) +
+                                                                  sizeof(ResolvedCodePoint)) +
+                           face_set.resolved_codepoints.bucket_count() * sizeof(void*);
+        for (const FallbackFace& fallback_face : face_set.fallback_faces) {
+            usage.font_data += fallback_face.face_data.capacity();
+            usage.font_data += CalculateSubstMapMemorySize(fallback_face.halfwidth_subst_map);
+            usage.font_data += fallback_face.coverage.capacity() * sizeof(uint64_t);
+        }
+    }
+    usage.glyph_caches += glyph_cache_.total_cost();
+}
+
+size_t TextRendererFreetype::TrimCaches(size_t bytes) {
+    size_t cached_size = glyph_cache_.total_cost();
+    glyph_cache_.Shrink(cached_size > bytes ? cached_size - bytes : 0);
+    return cached_size - glyph_cache_.total_cost();
+}
+
+auto TextRendererFreetype::LookupOrRasterizeGlyph(const GlyphCacheKey& key) -> const CachedGlyph* {
+    if (const CachedGlyph* cached = glyph_cache_.Get(key)) {
+        return cached;
+    }
+
+    std::optional<CachedGlyph> rasterized = RasterizeGlyph(key);
+    if (!rasterized) {
+        return nullptr;
+    }
+
+    size_t cost = sizeof(CachedGlyph) + rasterized->mask.buffer.size();
+    return &glyph_cache_.Put(key, std::move(rasterized.value()), cost);
+}
+
+auto TextRendererFreetype::RasterizeGlyph(const GlyphCacheKey& key) -> std::optional<CachedGlyph> {
+    FT_Face face = key.face;
+
+    if (FT_Set_Pixel_Sizes(face, static_cast<FT_UInt>(key.char_width), static_cast<FT_UInt>(key.char_height))) {
+        log_->e("Freetype: FT_Set_Pixel_Sizes failed");
+        return std::nullopt;
+    }
+
+    CachedGlyph glyph;
+    glyph.ascender = static_cast<int>(face->size->metrics.ascender >> 6);
+    glyph.descender = static_cast<int>(face->size->metrics.descender >> 6);
+    glyph.underline = static_cast<int>(FT_MulFix(face->underline_position, face->size->metrics.x_scale) >> 6);
+    glyph.underline_thickness =
+        static_cast<int>(FT_MulFix(face->underline_thickness, face->size->metrics.x_scale) >> 6);
+
+    if (FT_Load_Glyph(face, key.glyph_index, FT_LOAD_NO_BITMAP)) {
+        log_->e("Freetype: FT_Load_Glyph failed");
+        return std::nullopt;
+    }
+
+    ScopedHolder<FT_Glyph> glyph_image(nullptr, FT_Done_Glyph);
+    if (FT_Get_Glyph(face->glyph, &glyph_image)) {
+        log_->e("Freetype: FT_Get_Glyph failed");
+        return std::nullopt;
+    }
+
+    if (key.stroke_width > 0) {
+        // Generate stroke border outline, stroker_ is reused across glyphs
+        FT_Stroker_Set(stroker_,
+                       key.stroke_width,
+                       FT_STROKER_LINECAP_ROUND,
+                       FT_STROKER_LINEJOIN_ROUND,
+                       0);
+
+        FT_Glyph_StrokeBorder(&glyph_image, stroker_, false, true);
+    }
+
+    if (FT_Glyph_To_Bitmap(&glyph_image, FT_RENDER_MODE_NORMAL, nullptr, true)) {
+        log_->e("Freetype: FT_Glyph_To_Bitmap failed");
+        return std::nullopt;
+    }
+
+    auto bitmap_glyph = reinterpret_cast<FT_BitmapGlyph>(glyph_image.Get());
+    const FT_Bitmap& ft_bmp = bitmap_glyph->bitmap;
+
+    glyph.mask.left = bitmap_glyph->left;
+    glyph.mask.top = bitmap_glyph->top;
+    glyph.mask.width = static_cast<int>(ft_bmp.width);
+    glyph.mask.rows = static_cast<int>(ft_bmp.rows);
+    glyph.mask.buffer.resize(static_cast<size_t>(ft_bmp.width) * ft_bmp.rows);
 
     for (uint32_t y = 0; y < ft_bmp.rows; y++) {
-        uint32_t src_index = y * ft_bmp.pitch;
-        const uint8_t* src = &ft_bmp.buffer[src_index];
-        ColorRGBA* dest = bitmap.GetPixelAt(0, static_cast<int>(y));
+        const uint8_t* src = &ft_bmp.buffer[y * ft_bmp.pitch];
+        memcpy(&glyph.mask.buffer[y * ft_bmp.width], src, ft_bmp.width);
+    }
 
-        alphablend::FillLineWithAlphas(dest, src, color, ft_bmp.width);
+    return glyph;
+}
+
+void TextRendererFreetype::PurgeGlyphCache(FT_Face face) {
+    glyph_cache_.EraseIf([face](const GlyphCacheKey& key, const CachedGlyph&) {
+        return key.face == face;
+    });
+}
+
+void TextRendererFreetype::PurgeGlyphCache(const FaceSet& face_set) {
+    PurgeGlyphCache(face_set.main_face);
+    for (const FallbackFace& fallback_face : face_set.fallback_faces) {
+        PurgeGlyphCache(fallback_face.face);
     }
+}
 
-    return bitmap;
+// Bitset of codepoints mapped by the selected (Unicode) charmap of the face
+static std::vector<uint64_t> CalculateCoverage(FT_Face face) {
+    std::vector<uint64_t> coverage;
+
+    FT_UInt glyph_index = 0;
+    FT_ULong codepoint = FT_Get_First_Char(face, &glyph_index);
+    while (glyph_index != 0) {
+        if (codepoint <= 0x10FFFF) {
+            size_t word = codepoint / 64;
+            if (word >= coverage.size()) {
+                coverage.resize(word + 1);
+            }
+            coverage[word] |= uint64_t(1) << (codepoint % 64);
+        }
+        codepoint = FT_Get_Next_Char(face, codepoint, &glyph_index);
+    }
+
+    coverage.shrink_to_fit();
+    return coverage;
+}
+
+auto TextRendererFreetype::LoadFallbackFace(FaceSet& face_set, uint32_t ucs4)
+        -> Result<FallbackFace*, FontProviderError> {
+    FallbackFace fallback_face;
+    auto result = LoadFontFace(fallback_face.face_data, ucs4, face_set.main_face_index + 1);
+    if (result.is_err()) {
+        log_->e("Freetype: Cannot find available fallback font for U+%04X", ucs4);
+        return Err(result.error());
+    }
+    fallback_face.face = ScopedHolder<FT_Face>(result.value().first, FT_Done_Face);
+    fallback_face.coverage = CalculateCoverage(fallback_face.face);
+
+    if (!fallback_face.Covers(ucs4)) {
+        // Don't let a face which is useless for this codepoint evict other fallback faces
+        log_->e("Freetype: Got glyph_index == 0 for U+%04X in fallback font", ucs4);
+        return Err(FontProviderError::kCodePointNotFound);
+    }
+
+    std::list<FallbackFace>& fallback_faces = face_set.fallback_faces;
+    if (fallback_faces.size() >= kMaxFallbackFaces) {
+        FT_Face evicted = fallback_faces.back().face;
+        PurgeGlyphCache(evicted);
+        for (auto iter = face_set.resolved_codepoints.begin(); iter != face_set.resolved_codepoints.end();) {
+            if (iter->second.face == evicted) {
+                iter = face_set.resolved_codepoints.erase(iter);
+            } else {
+                ++iter;
+            }
+        }
+        fallback_faces.pop_back();
+    }
+    fallback_faces.push_front(std::move(fallback_face));
+    return Ok(&fallback_faces.front());
 }
 
 static bool MatchFontFamilyName(FT_Face face, const std::string& family_name) {
@@ -344,24 +521,26 @@ static bool MatchFontFamilyName(FT_Face face, const std::string& family_name) {
     return false;
 }
 
-auto TextRendererFreetype::LoadFontFace(bool is_fallback,
+auto TextRendererFreetype::LoadFontFace(std::vector<uint8_t>& face_data,
                                         std::optional<uint32_t> codepoint,
                                         std::optional<size_t> begin_index)
         -> Result<std::pair<FT_Face, size_t>, FontProviderError> {
-    if (begin_index && begin_index.value() >= font_family_.size()) {
+    FaceSet& face_set = face_sets_.front();
+
+    if (begin_index && begin_index.value() >= face_set.font_family.size()) {
         return Err(FontProviderError::kFontNotFound);
     }
 
     // begin_index is optional
     size_t font_index = begin_index.value_or(0);
 
-    const std::string& font_name = font_family_[font_index];
+    const std::string& font_name = face_set.font_family[font_index];
     auto result = font_provider_.GetFontFace(font_name, codepoint);
 
-    while (result.is_err() && font_index + 1 < font_family_.size()) {
+    while (result.is_err() && font_index + 1 < face_set.font_family.size()) {
         // Find next suitable font
         font_index++;
-        result = font_provider_.GetFontFace(font_family_[font_index], codepoint);
+        result = font_provider_.GetFontFace(face_set.font_family[font_index], codepoint);
     }
     if (result.is_err()) {
         // Not found, return Err Result
@@ -374,15 +553,8 @@ auto TextRendererFreetype::LoadFontFace(bool is_fallback,
     std::vector<uint8_t>* memory_data = nullptr;
     if (!info.font_data.empty()) {
         use_memory_data = true;
-        if (!is_fallback) {
-            main_face_.Reset();
-            main_face_data_ = std::move(info.font_data);
-            memory_data = &main_face_data_;
-        } else {  // is_fallback
-            fallback_face_.Reset();
-            fallback_face_data_ = std::move(info.font_data);
-            memory_data = &fallback_face_data_;
-        }
+        face_data = std::move(info.font_data);
+        memory_data = &face_data;
     }
 
     FT_Face face = nullptr;
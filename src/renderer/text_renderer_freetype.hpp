@@ -21,6 +21,10 @@
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
+#include FT_STROKER_H
+#include <cstddef>
+#include <cstdint>
+#include <list>
 #include <vector>
 #include <string>
 #include <optional>
@@ -29,6 +33,7 @@
 #include "aribcaption/color.hpp"
 #include "aribcaption/context.hpp"
 #include "base/logger.hpp"
+#include "base/lru_cache.hpp"
 #include "base/result.hpp"
 #include "base/scoped_holder.hpp"
 #include "renderer/bitmap.hpp"
@@ -46,6 +51,8 @@ public:
     void SetLanguage(uint32_t iso6392_language_code) override;
     bool SetFontFamily(const std::vector<std::string>& font_family) override;
     void SetReplaceMSZHalfWidthGlyph(bool replace) override;
+    void AccumulateMemoryUsage(RendererMemoryUsage& usage) const override;
+    size_t TrimCaches(size_t bytes) override;
     auto BeginDraw(Bitmap& target_bmp) -> TextRenderContext override;
     void EndDraw(TextRenderContext& context) override;
     auto DrawChar(TextRenderContext& render_ctx, int x, int y,
@@ -53,9 +60,108 @@ public:
                   float stroke_width, int char_width, int char_height, float aspect_ratio,
                   std::optional<UnderlineInfo> underline_info,
                   TextRenderFallbackPolicy fallback_policy) -> TextRenderStatus override;
+
+    [[nodiscard]]
+    uint64_t GetGlyphCacheHitCount() const { return glyph_cache_.hit_count(); }
+
+    [[nodiscard]]
+    uint64_t GetGlyphCacheMissCount() const { return glyph_cache_.miss_count(); }
 private:
-    static Bitmap FTBitmapToColoredBitmap(const FT_Bitmap& ft_bmp, ColorRGBA color);
-    auto LoadFontFace(bool is_fallback,
+    // 8-bit coverage mask of a rasterized glyph
+    struct GlyphMask {
+        int left = 0;    // horizontal distance from the pen position to the left of the mask
+        int top = 0;     // vertical distance from the baseline to the top of the mask
+        int width = 0;
+        int rows = 0;
+        std::vector<uint8_t> buffer;  // tightly packed, pitch == width
+    };
+
+    struct CachedGlyph {
+        // Face metrics at the requested pixel size, in pixels
+        int ascender = 0;
+        int descender = 0;
+        int underline = 0;
+        int underline_thickness = 0;
+        GlyphMask mask;  // filling mask, or stroke border mask if stroke_width > 0
+    };
+
+    struct GlyphCacheKey {
+        FT_Face face = nullptr;
+        FT_UInt glyph_index = 0;
+        int char_width = 0;
+        int char_height = 0;
+        bool halfwidth_substituted = false;
+        FT_Fixed stroke_width = 0;  // 26.6 fixed point, 0 for filling glyphs
+    public:
+        friend bool operator==(const GlyphCacheKey& a, const GlyphCacheKey& b) {
+            return a.face == b.face && a.glyph_index == b.glyph_index &&
+                   a.char_width == b.char_width && a.char_height == b.char_height &&
+                   a.halfwidth_substituted == b.halfwidth_substituted && a.stroke_width == b.stroke_width;
+        }
+    };
+
+    struct GlyphCacheKeyHash {
+        size_t operator()(const GlyphCacheKey& key) const {
+            size_t hash = std::hash<const void*>()(key.face);
+            hash = hash * 31 + key.glyph_index;
+            hash = hash * 31 + static_cast<size_t>(key.char_width);
+            hash = hash * 31 + static_cast<size_t>(key.char_height);
+            hash = hash * 31 + static_cast<size_t>(key.halfwidth_substituted);
+            hash = hash * 31 + static_cast<size_t>(key.stroke_width);
+            return hash;
+        }
+    };
+
+    // A loaded fallback face, chosen by looking up codepoints in its coverage instead of querying FontProvider
+    struct FallbackFace {
+        std::vector<uint8_t> face_data;  // Data of memory face, declared before the face referring to it
+        ScopedHolder<FT_Face> face;
+        std::optional<std::unordered_map<uint32_t, uint32_t>> halfwidth_subst_map;
+        std::vector<uint64_t> coverage;  // Bitset of codepoints mapped by the face's charmap
+    public:
+        [[nodiscard]]
+        bool Covers(uint32_t ucs4) const {
+            size_t word = ucs4 / 64;
+            return word < coverage.size() && (coverage[word] >> (ucs4 % 64)) & 1;
+        }
+    };
+
+    // Face and glyph index a codepoint is resolved into, or the error status if it couldn't be resolved
+    struct ResolvedCodePoint {
+        FT_Face face = nullptr;
+        FT_UInt glyph_index = 0;
+        std::optional<std::unordered_map<uint32_t, uint32_t>>* halfwidth_subst_map = nullptr;  // of the face
+        TextRenderStatus status = TextRenderStatus::kOK;
+    };
+
+    // Faces loaded for a font family list, kept across SetFontFamily() calls for switching without reloading
+    struct FaceSet {
+        std::vector<std::string> font_family;
+        std::vector<uint8_t> main_face_data;  // Data of memory face, declared before the face referring to it
+        ScopedHolder<FT_Face> main_face;
+        std::optional<std::unordered_map<uint32_t, uint32_t>> main_halfwidth_subst_map;
+        size_t main_face_index = 0;
+        std::list<FallbackFace> fallback_faces;  // Most recently used first
+
+        // (codepoint << 1 | fail_on_codepoint_not_found) => ResolvedCodePoint, including failed ones
+        std::unordered_map<uint64_t, ResolvedCodePoint> resolved_codepoints;
+    };
+
+    static constexpr size_t kGlyphCacheCapacity = 8 * 1024 * 1024;  // in bytes
+    static constexpr size_t kMaxFaceSets = 4;
+    static constexpr size_t kMaxFallbackFaces = 4;  // per FaceSet
+private:
+    auto LookupOrRasterizeGlyph(const GlyphCacheKey& key) -> const CachedGlyph*;
+    auto RasterizeGlyph(const GlyphCacheKey& key) -> std::optional<CachedGlyph>;
+    auto ResolveCodePoint(FaceSet& face_set, uint32_t ucs4, TextRenderFallbackPolicy fallback_policy)
+        -> ResolvedCodePoint;
+    auto ResolveCodePointUncached(FaceSet& face_set, uint32_t ucs4, TextRenderFallbackPolicy fallback_policy)
+        -> ResolvedCodePoint;
+    void PurgeGlyphCache(FT_Face face);
+    void PurgeGlyphCache(const FaceSet& face_set);
+    auto LoadFallbackFace(FaceSet& face_set, uint32_t ucs4) -> Result<FallbackFace*, FontProviderError>;
+    // Memory data of the face is moved into face_data if provided by FontProvider
+    auto LoadFontFace(std::vector<uint8_t>& face_data,
                       std::optional<uint32_t> codepoint = std::nullopt,
                       std::optional<size_t> begin_index = std::nullopt)
         -> Result<std::pair<FT_Face, size_t>, FontProviderError>;  // Result<Pair<face, font_index>, error>
@@ -63,18 +169,16 @@ private:
     std::shared_ptr<Logger> log_;
 
     FontProvider& font_provider_;
-    std::vector<std::string> font_family_;
 
     ScopedHolder<FT_Library> library_;
-    ScopedHolder<FT_Face> main_face_;
-    ScopedHolder<FT_Face> fallback_face_;
-    std::vector<uint8_t> main_face_data_;
-    std::vector<uint8_t> fallback_face_data_;
-    std::optional<std::unordered_map<uint32_t, uint32_t>> main_halfwidth_subst_map_;
-    std::optional<std::unordered_map<uint32_t, uint32_t>> fallback_halfwidth_subst_map_;
-    size_t main_face_index_ = 0;
+    ScopedHolder<FT_Stroker> stroker_;
+
+    // Most recently used first, the front one is for the current font family
+    std::list<FaceSet> face_sets_;
 
     bool replace_msz_halfwidth_glyph_ = true;
+
+    LRUCache<GlyphCacheKey, CachedGlyph, GlyphCacheKeyHash> glyph_cache_{kGlyphCacheCapacity};
 };
 
 }  // namespace aribcaption
@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "aribcaption/aribcaption.h"
 #include "png_writer.h"
 #include "sample_data.h"
@@ -109,10 +110,54 @@ int main(int argc, char* argv[]) {
         png_writer_write_image_c(filename, image);
     }
 
+    // Keep a copy of the first image for checking the shared bitmap below
+    uint8_t* expected_bitmap = NULL;
+    uint32_t expected_bitmap_size = 0;
+    if (render_result.image_count > 0) {
+        expected_bitmap_size = render_result.images[0].bitmap_size;
+        expected_bitmap = malloc(expected_bitmap_size);
+        memcpy(expected_bitmap, render_result.images[0].bitmap, expected_bitmap_size);
+    }
+
     aribcc_render_result_cleanup(&render_result);
 
+    int ret = 0;
+
+    // Shared bitmaps: take one out of the result, it must outlive the renderer and the render result
+    void** bitmap_owners = NULL;
+    aribcc_render_result_t shared_result = {0};
+    render_status = aribcc_renderer_render_shared(renderer, 0, &shared_result, &bitmap_owners);
+    printf("RenderStatus (shared): %d\n", render_status);
+
     aribcc_renderer_free(renderer);
     aribcc_decoder_free(decoder);
+
+    if (shared_result.image_count > 0 && expected_bitmap) {
+        void* owner = NULL;
+        uint8_t* bitmap = aribcc_render_result_take_bitmap(&shared_result, bitmap_owners, 0, &owner);
+        if (!bitmap || shared_result.images[0].bitmap || bitmap_owners[0]) {
+            fprintf(stderr, "aribcc_render_result_take_bitmap() failed\n");
+            ret = -1;
+        }
+
+        aribcc_render_result_cleanup_shared(&shared_result, bitmap_owners);
+
+        if (bitmap) {
+            if (memcmp(bitmap, expected_bitmap, expected_bitmap_size) != 0) {
+                fprintf(stderr, "Taken bitmap differs from the bitmap of aribcc_renderer_render()\n");
+                ret = -1;
+            }
+            aribcc_image_bitmap_release(owner, bitmap);
+        }
+    } else {
+        aribcc_render_result_cleanup_shared(&shared_result, bitmap_owners);
+        if (expected_bitmap) {
+            fprintf(stderr, "aribcc_renderer_render_shared() returned no image\n");
+            ret = -1;
+        }
+    }
+    free(expected_bitmap);
+
     aribcc_context_free(ctx);
 
 
@@ -120,5 +165,5 @@ int main(int argc, char* argv[]) {
     SetConsoleOutputCP(old_codepage);
 #endif
 
-    return 0;
+    return ret;
 }
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "aribcaption/aribcaption.hpp"
+#include "sample_data.h"
+
+namespace fs = std::filesystem;
+using namespace aribcaption;
+
+// Counters reported by the verbose log of FontIndex::Build()
+struct IndexStats {
+    bool built = false;
+    size_t face_count = 0;
+    size_t file_count = 0;
+    size_t parsed_count = 0;
+};
+
+static IndexStats stats;
+
+static void Logcat(LogLevel level, const char* message) {
+    if (level == LogLevel::kError || level == LogLevel::kWarning) {
+        fprintf(stderr, "%s\n", message);
+    }
+    if (sscanf(message, "FontIndex: Indexed %zu faces in %zu files, %zu files parsed",
+               &stats.face_count, &stats.file_count, &stats.parsed_count) == 3) {
+        stats.built = true;
+    }
+}
+
+// Build the index through a fresh renderer and check how many font files had to be parsed
+static bool BuildIndex(Context& context, const fs::path& fonts_dir, const fs::path& cache_path,
+                       size_t expected_files, size_t expected_parsed, const char* step) {
+    stats = IndexStats();
+
+    Renderer renderer(context);
+    if (!renderer.SetFontSearchPaths({fonts_dir.u8string()}, cache_path.u8string())) {
+        fprintf(stderr, "%s: Renderer::SetFontSearchPaths() failed\n", step);
+        return false;
+    }
+    if (!renderer.Initialize(CaptionType::kCaption, FontProviderType::kDirectory)) {
+        fprintf(stderr, "%s: Renderer::Initialize() with kDirectory failed\n", step);
+        return false;
+    }
+    if (!stats.built) {
+        fprintf(stderr, "%s: FontIndex statistics not logged\n", step);
+        return false;
+    }
+    if (stats.file_count != expected_files || stats.parsed_count != expected_parsed) {
+        fprintf(stderr, "%s: %zu files, %zu parsed, expected %zu files, %zu parsed\n",
+                step, stats.file_count, stats.parsed_count, expected_files, expected_parsed);
+        return false;
+    }
+    if (!fs::exists(cache_path)) {
+        fprintf(stderr, "%s: Cache file %s not written\n", step, cache_path.u8string().c_str());
+        return false;
+    }
+
+    printf("%s: %zu faces in %zu files, %zu files parsed\n", step, stats.face_count, stats.file_count,
+           stats.parsed_count);
+    return true;
+}
+
+// Rendering through the directory font provider must not fail, even if the fonts lack Japanese glyphs
+static bool RenderSample(Context& context, const fs::path& fonts_dir, const fs::path& cache_path) {
+    Decoder decoder(context);
+    decoder.Initialize();
+
+    Renderer renderer(context);
+    renderer.SetFontSearchPaths({fonts_dir.u8string()}, cache_path.u8string());
+    if (!renderer.Initialize(CaptionType::kCaption, FontProviderType::kDirectory, TextRendererType::kFreetype)) {
+        fprintf(stderr, "Render: Renderer::Initialize() with kDirectory failed\n");
+        return false;
+    }
+    renderer.SetFrameSize(1920, 1080);
+
+    DecodeResult decode_result;
+    if (decoder.Decode(sample_data_1, sizeof(sample_data_1), 0, decode_result) != DecodeStatus::kGotCaption) {
+        fprintf(stderr, "Render: Decoder::Decode() failed\n");
+        return false;
+    }
+    renderer.AppendCaption(std::move(*decode_result.caption));
+
+    RenderResult result;
+    RenderStatus status = renderer.Render(0, result);
+    if (status != RenderStatus::kGotImage || result.images.empty()) {
+        fprintf(stderr, "Render: Renderer::Render() returned %d\n", static_cast<int>(status));
+        return false;
+    }
+    return true;
+}
+
+static void TruncateFile(const fs::path& path, uintmax_t size) {
+    std::error_code ec;
+    fs::resize_file(path, size, ec);
+}
+
+static void AppendToFile(const fs::path& path, const std::string& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::app);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+static void OverwriteFileHead(const fs::path& path, const std::string& data) {
+    std::fstream stream(path, std::ios::binary | std::ios::in | std::ios::out);
+    stream.seekp(0);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <font file> <font file> [font file...]\n", argv[0]);
+        return -1;
+    }
+
+    fs::path work_dir = fs::temp_directory_path() / "aribcc_test_font_index";
+    fs::path fonts_dir = work_dir / "fonts";
+    fs::path cache_path = work_dir / "font_index.cache";
+
+    std::error_code ec;
+    fs::remove_all(work_dir, ec);
+    fs::create_directories(fonts_dir);
+
+    std::vector<fs::path> fonts;
+    for (int i = 1; i < argc; i++) {
+        fs::path dest = fonts_dir / fs::u8path(argv[i]).filename();
+        if (!fs::copy_file(fs::u8path(argv[i]), dest, fs::copy_options::overwrite_existing, ec)) {
+            fprintf(stderr, "Cannot copy font file %s: %s\n", argv[i], ec.message().c_str());
+            return -1;
+        }
+        fonts.push_back(dest);
+    }
+    const size_t file_count = fonts.size();
+
+    Context context;
+    context.SetLogcatCallback(Logcat);
+
+    bool ok = [&]() -> bool {
+        // Cold build parses every file and writes the cache
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, file_count, "Cold build")) {
+            return false;
+        }
+        // Warm load takes every face from the cache
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, 0, "Warm load")) {
+            return false;
+        }
+
+        // Truncated, trailing garbage or foreign magic: the cache is a miss and gets rewritten
+        TruncateFile(cache_path, fs::file_size(cache_path) / 2);
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, file_count, "Truncated cache") ||
+                !BuildIndex(context, fonts_dir, cache_path, file_count, 0, "Rewritten cache")) {
+            return false;
+        }
+        AppendToFile(cache_path, "garbage");
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, file_count, "Trailing garbage") ||
+                !BuildIndex(context, fonts_dir, cache_path, file_count, 0, "Rewritten cache")) {
+            return false;
+        }
+        OverwriteFileHead(cache_path, "NOTACACHE");
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, file_count, "Corrupted magic") ||
+                !BuildIndex(context, fonts_dir, cache_path, file_count, 0, "Rewritten cache")) {
+            return false;
+        }
+
+        // Only the file stamped with a different mtime or size is parsed again
+        fs::file_time_type mtime = fs::last_write_time(fonts[0]);
+        fs::last_write_time(fonts[0], mtime - std::chrono::hours(24));
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, 1, "Changed mtime")) {
+            return false;
+        }
+        // Keep the mtime, so the size alone tells the change
+        mtime = fs::last_write_time(fonts[1]);
+        AppendToFile(fonts[1], std::string(16, '\0'));
+        fs::last_write_time(fonts[1], mtime);
+        if (!BuildIndex(context, fonts_dir, cache_path, file_count, 1, "Changed size") ||
+                !BuildIndex(context, fonts_dir, cache_path, file_count, 0, "Warm load")) {
+            return false;
+        }
+
+        return RenderSample(context, fonts_dir, cache_path);
+    }();
+
+    fs::remove_all(work_dir, ec);
+
+    if (!ok) {
+        return -1;
+    }
+    printf("All passed\n");
+    return 0;
+}
@@ -0,0 +1,498 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "aribcaption/aribcaption.h"
+#include "aribcaption/aribcaption.hpp"
+#include "sample_data.h"
+
+using namespace aribcaption;
+
+constexpr int frame_width = 1920;
+constexpr int frame_height = 1080;
+
+// Captions of the samples are shown in turn, the second one is cleared by Flush()
+constexpr int64_t caption_pts[] = {1000, 5000};
+constexpr int64_t caption_duration[] = {2000, 4000};
+
+// A display set parsed back from PGS segments, from PCS to END
+struct DisplaySet {
+    uint32_t pts90k = 0;
+    bool has_object = false;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    size_t palette_size = 0;
+    uint8_t alphas[256] = {};
+    size_t ods_count = 0;
+    std::vector<uint8_t> object_data;
+    std::vector<uint8_t> indices;
+};
+
+static uint32_t ReadU16(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 8) | p[1];
+}
+
+static uint32_t ReadU24(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 16) | ReadU16(p + 1);
+}
+
+static uint32_t ReadU32(const uint8_t* p) {
+    return (ReadU16(p) << 16) | ReadU16(p + 2);
+}
+
+// Decode run-length encoded lines, see PGSEncoderImpl::EncodeRLELine()
+static bool DecodeRLE(const uint8_t* data, size_t size, int width, int height, std::vector<uint8_t>& out) {
+    out.clear();
+    out.reserve(static_cast<size_t>(width) * height);
+
+    size_t pos = 0;
+    for (int y = 0; y < height; y++) {
+        size_t line_begin = out.size();
+        while (true) {
+            if (pos >= size) {
+                fprintf(stderr, "RLE data ends in line %d\n", y);
+                return false;
+            }
+            uint8_t byte = data[pos++];
+            if (byte) {
+                out.push_back(byte);
+                continue;
+            }
+            if (pos >= size) {
+                fprintf(stderr, "RLE data ends in line %d\n", y);
+                return false;
+            }
+            uint8_t flags = data[pos++];
+            if (flags == 0) {
+                break;  // End of line
+            }
+            size_t run = flags & 0x3F;
+            if (flags & 0x40) {
+                run = (run << 8) | data[pos++];
+            }
+            uint8_t color = (flags & 0x80) ? data[pos++] : 0;
+            out.insert(out.end(), run, color);
+        }
+        if (out.size() - line_begin != static_cast<size_t>(width)) {
+            fprintf(stderr, "RLE line %d has %zu pixels, expected %d\n", y, out.size() - line_begin, width);
+            return false;
+        }
+    }
+
+    if (pos != size) {
+        fprintf(stderr, "RLE data has %zu trailing bytes\n", size - pos);
+        return false;
+    }
+    return true;
+}
+
+static bool ParseSegments(const std::vector<uint8_t>& data, std::vector<DisplaySet>& out_sets) {
+    DisplaySet set;
+    size_t object_data_length = 0;
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        if (data.size() - pos < 13 || data[pos] != 'P' || data[pos + 1] != 'G') {
+            fprintf(stderr, "Invalid segment header at %zu\n", pos);
+            return false;
+        }
+        uint32_t pts90k = ReadU32(&data[pos + 2]);
+        uint8_t type = data[pos + 10];
+        size_t length = ReadU16(&data[pos + 11]);
+        const uint8_t* payload = &data[pos + 13];
+        pos += 13 + length;
+        if (pos > data.size()) {
+            fprintf(stderr, "Segment exceeds the data\n");
+            return false;
+        }
+
+        switch (type) {
+            case 0x16: {  // PCS
+                set = DisplaySet();
+                set.pts90k = pts90k;
+                if (ReadU16(payload) != frame_width || ReadU16(payload + 2) != frame_height) {
+                    fprintf(stderr, "PCS has wrong video size\n");
+                    return false;
+                }
+                set.has_object = payload[10] != 0;
+                if (set.has_object) {
+                    set.x = static_cast<int>(ReadU16(payload + 15));
+                    set.y = static_cast<int>(ReadU16(payload + 17));
+                }
+                break;
+            }
+            case 0x17:  // WDS
+                break;
+            case 0x14: {  // PDS
+                set.palette_size = (length - 2) / 5;
+                for (size_t i = 0; i < set.palette_size; i++) {
+                    const uint8_t* entry = payload + 2 + i * 5;
+                    set.alphas[entry[0]] = entry[4];
+                }
+                break;
+            }
+            case 0x15: {  // ODS
+                bool first = payload[3] & 0x80;
+                const uint8_t* rle = payload + 4;
+                size_t rle_size = length - 4;
+                if (first) {
+                    object_data_length = ReadU24(payload + 4);
+                    set.width = static_cast<int>(ReadU16(payload + 7));
+                    set.height = static_cast<int>(ReadU16(payload + 9));
+                    rle = payload + 11;
+                    rle_size = length - 11;
+                }
+                set.object_data.insert(set.object_data.end(), rle, rle + rle_size);
+                set.ods_count++;
+                if (payload[3] & 0x40) {
+                    if (set.object_data.size() + 4 != object_data_length) {
+                        fprintf(stderr, "object_data_length mismatch\n");
+                        return false;
+                    }
+                    if (!DecodeRLE(set.object_data.data(), set.object_data.size(),
+                                   set.width, set.height, set.indices)) {
+                        return false;
+                    }
+                }
+                break;
+            }
+            case 0x80:  // END
+                if (set.has_object && set.indices.size() != static_cast<size_t>(set.width) * set.height) {
+                    fprintf(stderr, "Display set has no complete object\n");
+                    return false;
+                }
+                out_sets.push_back(std::move(set));
+                set = DisplaySet();
+                break;
+            default:
+                fprintf(stderr, "Unknown segment type 0x%02X\n", type);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Compare the object of a display set against the images, composed the same way as the encoder:
+// within the bounding rect of images, non-transparent indices of later images overwrite earlier ones
+static bool CheckObject(const DisplaySet& set, const std::vector<Image>& images) {
+    int left = frame_width;
+    int top = frame_height;
+    int right = 0;
+    int bottom = 0;
+    for (const Image& image : images) {
+        left = std::min(left, image.dst_x);
+        top = std::min(top, image.dst_y);
+        right = std::max(right, image.dst_x + image.width);
+        bottom = std::max(bottom, image.dst_y + image.height);
+    }
+    left = std::max(left, 0);
+    top = std::max(top, 0);
+    right = std::min(right, frame_width);
+    bottom = std::min(bottom, frame_height);
+
+    if (!set.has_object || set.x != left || set.y != top ||
+            set.width != right - left || set.height != bottom - top) {
+        fprintf(stderr, "Object rect mismatch\n");
+        return false;
+    }
+
+    std::vector<uint8_t> expected(static_cast<size_t>(set.width) * set.height, 0);
+    for (const Image& image : images) {
+        for (int y = std::max(image.dst_y, top); y < std::min(image.dst_y + image.height, bottom); y++) {
+            const uint8_t* line = image.bitmap.data() + static_cast<size_t>(y - image.dst_y) * image.stride;
+            for (int x = std::max(image.dst_x, left); x < std::min(image.dst_x + image.width, right); x++) {
+                if (uint8_t index = line[x - image.dst_x]) {
+                    expected[static_cast<size_t>(y - top) * set.width + (x - left)] = index;
+                }
+            }
+        }
+    }
+    if (expected != set.indices) {
+        fprintf(stderr, "Object pixels mismatch\n");
+        return false;
+    }
+
+    const std::vector<ColorRGBA>& palette = images.front().palette;
+    if (set.palette_size != palette.size()) {
+        fprintf(stderr, "Palette size mismatch\n");
+        return false;
+    }
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (set.alphas[i] != palette[i].a) {
+            fprintf(stderr, "Palette alpha mismatch at %zu\n", i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Image with all forms of runs, large enough to be fragmented into several ODS
+static std::vector<Image> MakeSyntheticImages() {
+    std::vector<Image> images;
+    std::vector<ColorRGBA> palette(16);
+    for (size_t i = 1; i < palette.size(); i++) {
+        palette[i] = ColorRGBA(static_cast<uint8_t>(i * 16), 255, 0, static_cast<uint8_t>(i * 17));
+    }
+
+    uint32_t seed = 1;
+    auto random = [&]() {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 16) & 0x7FFF;
+    };
+
+    for (int n = 0; n < 2; n++) {
+        Image image;
+        image.width = n ? 300 : 1600;
+        image.height = n ? 100 : 400;
+        image.stride = image.width + 16;
+        image.dst_x = n ? 1700 : 100;  // The second one is overlapped, and clipped by the frame
+        image.dst_y = n ? 450 : 100;
+        image.pixel_format = PixelFormat::kPAL8;
+        image.palette = palette;
+
+        ImageBuffer::Storage pixels(static_cast<size_t>(image.stride) * image.height, 0);
+        for (int y = 0; y < image.height; y++) {
+            uint8_t* line = pixels.data() + static_cast<size_t>(y) * image.stride;
+            int x = 0;
+            while (x < image.width) {
+                // Lines of single pixels take a byte per pixel, for exceeding the segment size
+                static constexpr int kRunLengths[] = {1, 2, 3, 63, 64, 200};
+                int run = std::min(y % 2 ? 1 : kRunLengths[random() % 6], image.width - x);
+                auto color = static_cast<uint8_t>(random() % 16);
+                memset(line + x, color, static_cast<size_t>(run));
+                x += run;
+            }
+        }
+        image.bitmap = ImageBuffer(std::move(pixels));
+        images.push_back(std::move(image));
+    }
+
+    return images;
+}
+
+static bool TestSyntheticImages(Context& context) {
+    PGSEncoder encoder(context);
+    encoder.SetFrameSize(frame_width, frame_height);
+
+    RenderResult result;
+    result.pts = 0;
+    result.duration = 1000;
+    result.images = MakeSyntheticImages();
+
+    std::vector<uint8_t> data;
+    if (!encoder.Encode(0, RenderStatus::kGotImage, result, data)) {
+        fprintf(stderr, "PGSEncoder::Encode() failed\n");
+        return false;
+    }
+    encoder.Flush(data);
+
+    std::vector<DisplaySet> sets;
+    if (!ParseSegments(data, sets) || sets.size() != 2) {
+        fprintf(stderr, "Synthetic images: unexpected display sets\n");
+        return false;
+    }
+    if (sets[0].ods_count < 2) {
+        fprintf(stderr, "Synthetic images: object is not fragmented\n");
+        return false;
+    }
+    if (!CheckObject(sets[0], result.images)) {
+        return false;
+    }
+    if (sets[1].has_object || sets[1].pts90k != 1000 * 90) {
+        fprintf(stderr, "Synthetic images: caption is not cleared at the end of its duration\n");
+        return false;
+    }
+
+    printf("Synthetic images: %zu ODS, %zu bytes\n", sets[0].ods_count, data.size());
+    return true;
+}
+
+// Render and encode sample captions, returns the encoded stream
+static bool TestSampleCaptions(Context& context, std::vector<uint8_t>& out_data) {
+    Decoder decoder(context);
+    decoder.Initialize();
+
+    Renderer renderer(context);
+    renderer.Initialize();
+    renderer.SetFrameSize(frame_width, frame_height);
+    renderer.SetStoragePolicy(CaptionStoragePolicy::kUnlimited);
+    renderer.SetOutputPixelFormat(PixelFormat::kPAL8);
+
+    PGSEncoder encoder(context);
+    encoder.SetFrameSize(frame_width, frame_height);
+
+    const uint8_t* samples[] = {sample_data_1, sample_data_drcs_1};
+    const size_t sample_sizes[] = {sizeof(sample_data_1), sizeof(sample_data_drcs_1)};
+    std::vector<std::vector<Image>> rendered;
+
+    for (size_t i = 0; i < 2; i++) {
+        DecodeResult decode_result;
+        if (decoder.Decode(samples[i], sample_sizes[i], caption_pts[i], decode_result) != DecodeStatus::kGotCaption) {
+            fprintf(stderr, "Decoder::Decode() failed on sample %zu\n", i);
+            return false;
+        }
+        decode_result.caption->wait_duration = caption_duration[i];
+        renderer.AppendCaption(std::move(*decode_result.caption));
+
+        RenderResult result;
+        RenderStatus status = renderer.Render(caption_pts[i], result);
+        if (status != RenderStatus::kGotImage) {
+            fprintf(stderr, "Renderer::Render() returned %d on sample %zu\n", static_cast<int>(status), i);
+            return false;
+        }
+        if (!encoder.Encode(caption_pts[i], status, result, out_data)) {
+            fprintf(stderr, "PGSEncoder::Encode() failed on sample %zu\n", i);
+            return false;
+        }
+        rendered.push_back(result.images);
+    }
+    encoder.Flush(out_data);
+
+    // Display, clear at the end of duration, display, clear by Flush()
+    std::vector<DisplaySet> sets;
+    if (!ParseSegments(out_data, sets) || sets.size() != 4) {
+        fprintf(stderr, "Sample captions: unexpected display sets\n");
+        return false;
+    }
+    for (size_t i = 0; i < 2; i++) {
+        const DisplaySet& shown = sets[i * 2];
+        const DisplaySet& cleared = sets[i * 2 + 1];
+        if (shown.pts90k != caption_pts[i] * 90 || !CheckObject(shown, rendered[i])) {
+            fprintf(stderr, "Sample caption %zu: object mismatch\n", i);
+            return false;
+        }
+        if (cleared.has_object || cleared.pts90k != (caption_pts[i] + caption_duration[i]) * 90) {
+            fprintf(stderr, "Sample caption %zu: not cleared at the end of its duration\n", i);
+            return false;
+        }
+        printf("Sample caption %zu: %dx%d object, %zu palette entries\n",
+               i, shown.width, shown.height, shown.palette_size);
+    }
+
+    return true;
+}
+
+// Same as TestSampleCaptions() through the C API, which must produce an identical stream
+static bool TestSampleCaptionsCAPI(const std::vector<uint8_t>& expected) {
+    aribcc_context_t* ctx = aribcc_context_alloc();
+    aribcc_decoder_t* decoder = aribcc_decoder_alloc(ctx);
+    aribcc_decoder_initialize(decoder,
+                              ARIBCC_ENCODING_SCHEME_AUTO,
+                              ARIBCC_CAPTIONTYPE_CAPTION,
+                              ARIBCC_PROFILE_A,
+                              ARIBCC_LANGUAGEID_FIRST);
+
+    aribcc_renderer_t* renderer = aribcc_renderer_alloc(ctx);
+    aribcc_renderer_initialize(renderer,
+                               ARIBCC_CAPTIONTYPE_CAPTION,
+                               ARIBCC_FONTPROVIDER_TYPE_AUTO,
+                               ARIBCC_TEXTRENDERER_TYPE_AUTO);
+    aribcc_renderer_set_frame_size(renderer, frame_width, frame_height);
+    aribcc_renderer_set_storage_policy(renderer, ARIBCC_CAPTION_STORAGE_POLICY_UNLIMITED, 0);
+    aribcc_renderer_set_output_pixel_format(renderer, ARIBCC_PIXELFORMAT_PAL8);
+
+    aribcc_pgs_encoder_t* encoder = aribcc_pgs_encoder_alloc(ctx);
+    aribcc_pgs_encoder_set_frame_size(encoder, frame_width, frame_height);
+
+    const uint8_t* samples[] = {sample_data_1, sample_data_drcs_1};
+    const size_t sample_sizes[] = {sizeof(sample_data_1), sizeof(sample_data_drcs_1)};
+    std::vector<uint8_t> data;
+    bool ok = true;
+
+    for (size_t i = 0; i < 2 && ok; i++) {
+        aribcc_caption_t caption = {};
+        if (aribcc_decoder_decode(decoder, samples[i], sample_sizes[i], caption_pts[i], &caption) !=
+                ARIBCC_DECODE_STATUS_GOT_CAPTION) {
+            fprintf(stderr, "aribcc_decoder_decode() failed on sample %zu\n", i);
+            ok = false;
+            break;
+        }
+        caption.wait_duration = caption_duration[i];
+        aribcc_renderer_append_caption(renderer, &caption);
+        aribcc_caption_cleanup(&caption);
+
+        aribcc_render_result_t result = {};
+        aribcc_render_status_t status = aribcc_renderer_render(renderer, caption_pts[i], &result);
+
+        const uint32_t* palette = nullptr;
+        size_t palette_size = 0;
+        aribcc_renderer_get_palette(renderer, &palette, &palette_size);
+
+        const uint8_t* encoded = nullptr;
+        size_t encoded_size = 0;
+        if (!aribcc_pgs_encoder_encode(encoder, caption_pts[i], status, &result, palette, palette_size,
+                                       &encoded, &encoded_size)) {
+            fprintf(stderr, "aribcc_pgs_encoder_encode() failed on sample %zu\n", i);
+            ok = false;
+        } else if (encoded) {
+            data.insert(data.end(), encoded, encoded + encoded_size);
+        }
+        aribcc_render_result_cleanup(&result);
+    }
+
+    const uint8_t* encoded = nullptr;
+    size_t encoded_size = 0;
+    aribcc_pgs_encoder_flush(encoder, &encoded, &encoded_size);
+    if (encoded) {
+        data.insert(data.end(), encoded, encoded + encoded_size);
+    }
+
+    aribcc_pgs_encoder_free(encoder);
+    aribcc_renderer_free(renderer);
+    aribcc_decoder_free(decoder);
+    aribcc_context_free(ctx);
+
+    if (ok && data != expected) {
+        fprintf(stderr, "C API: encoded stream differs from the C++ API\n");
+        ok = false;
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    Context context;
+    context.SetLogcatCallback([](LogLevel level, const char* message) {
+        if (level == LogLevel::kError || level == LogLevel::kWarning) {
+            fprintf(stderr, "%s\n", message);
+        }
+    });
+
+    if (!TestSyntheticImages(context)) {
+        return -1;
+    }
+
+    std::vector<uint8_t> data;
+    if (!TestSampleCaptions(context, data)) {
+        return -1;
+    }
+
+    if (!TestSampleCaptionsCAPI(data)) {
+        return -1;
+    }
+
+    printf("All passed\n");
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2026 magicxqq <xqq@xqq.im>. All rights reserved.
+ *
+ * This file is part of libaribcaption.
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "aribcaption/aribcaption.hpp"
+#include "sample_data.h"
+
+using namespace aribcaption;
+
+constexpr int frame_width = 1920;
+constexpr int frame_height = 1080;
+
+constexpr int64_t caption_pts[] = {1000, 5000};
+constexpr int64_t caption_duration[] = {2000, 4000};
+
+// Images rendered at each PTS of caption_pts
+using RenderedCaptions = std::vector<std::vector<Image>>;
+
+// Compare the visible pixels only, padding bytes at the end of each line are left uninitialized
+static bool IsSameImage(const Image& a, const Image& b) {
+    if (a.width != b.width || a.height != b.height || a.dst_x != b.dst_x || a.dst_y != b.dst_y ||
+            a.pixel_format != b.pixel_format || a.palette.size() != b.palette.size()) {
+        return false;
+    }
+    size_t line_size = static_cast<size_t>(a.width) * (a.pixel_format == PixelFormat::kPAL8 ? 1 : 4);
+    for (int y = 0; y < a.height; y++) {
+        if (memcmp(a.bitmap.data() + static_cast<size_t>(y) * a.stride,
+                   b.bitmap.data() + static_cast<size_t>(y) * b.stride, line_size) != 0) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.palette.size(); i++) {
+        if (a.palette[i].u32 != b.palette[i].u32) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool IsSameImages(const std::vector<Image>& a, const std::vector<Image>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (!IsSameImage(a[i], b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CompareRendered(const RenderedCaptions& expected, const RenderedCaptions& actual, const char* name) {
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (!IsSameImages(expected[i], actual[i])) {
+            fprintf(stderr, "%s: Images of caption %zu differ from the reference\n", name, i);
+            return false;
+        }
+    }
+    printf("%s: Identical to the reference\n", name);
+    return true;
+}
+
+static bool AppendSampleCaptions(Context& context, Renderer& renderer) {
+    Decoder decoder(context);
+    decoder.Initialize();
+
+    const uint8_t* samples[] = {sample_data_1, sample_data_drcs_1};
+    const size_t sample_sizes[] = {sizeof(sample_data_1), sizeof(sample_data_drcs_1)};
+
+    for (size_t i = 0; i < 2; i++) {
+        DecodeResult decode_result;
+        if (decoder.Decode(samples[i], sample_sizes[i], caption_pts[i], decode_result) != DecodeStatus::kGotCaption) {
+            fprintf(stderr, "Decoder::Decode() failed on sample %zu\n", i);
+            return false;
+        }
+        decode_result.caption->wait_duration = caption_duration[i];
+        renderer.AppendCaption(std::move(*decode_result.caption));
+    }
+    return true;
+}
+
+static bool RenderCaption(Renderer& renderer, size_t index, std::vector<Image>& out_images) {
+    RenderResult result;
+    RenderStatus status = renderer.Render(caption_pts[index], result);
+    if (status != RenderStatus::kGotImage && status != RenderStatus::kGotImageUnchanged) {
+        fprintf(stderr, "Renderer::Render() returned %d on caption %zu\n", static_cast<int>(status), index);
+        return false;
+    }
+    out_images = std::move(result.images);
+    return true;
+}
+
+// Render the sample captions with a renderer set up by configure
+static bool RenderSamples(Context& context,
+                          const std::function<bool(Renderer&)>& configure,
+                          RenderedCaptions& out_rendered) {
+    Renderer renderer(context);
+    renderer.Initialize();
+    renderer.SetFrameSize(frame_width, frame_height);
+    renderer.SetStoragePolicy(CaptionStoragePolicy::kUnlimited);
+    if (!configure(renderer) || !AppendSampleCaptions(context, renderer)) {
+        return false;
+    }
+
+    out_rendered.resize(2);
+    for (size_t i = 0; i < 2; i++) {
+        if (!RenderCaption(renderer, i, out_rendered[i])) {
+            return false;
+        }
+        // Give the render-ahead worker, if any, time to prepare the upcoming caption
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return true;
+}
+
+// A changed setting must not be served from the cache, restoring it must give back the original images
+static bool TestSettingsRoundTrip(Context& context, const RenderedCaptions& reference) {
+    Renderer renderer(context);
+    renderer.Initialize();
+    renderer.SetFrameSize(frame_width, frame_height);
+    renderer.SetStoragePolicy(CaptionStoragePolicy::kUnlimited);
+    if (!AppendSampleCaptions(context, renderer)) {
+        return false;
+    }
+
+    std::vector<Image> images;
+    if (!RenderCaption(renderer, 0, images) || !IsSameImages(reference[0], images)) {
+        fprintf(stderr, "Settings round-trip: Images differ from the reference before changing settings\n");
+        return false;
+    }
+
+    renderer.SetForceStrokeText(true);
+    renderer.SetStrokeWidth(3.0f);
+    if (!RenderCaption(renderer, 0, images) || IsSameImages(reference[0], images)) {
+        fprintf(stderr, "Settings round-trip: Changed settings served images from the cache\n");
+        return false;
+    }
+
+    renderer.SetForceStrokeText(false);
+    renderer.SetStrokeWidth(1.5f);
+    if (!RenderCaption(renderer, 0, images) || !IsSameImages(reference[0], images)) {
+        fprintf(stderr, "Settings round-trip: Images differ from the reference after restoring settings\n");
+        return false;
+    }
+
+    printf("Settings round-trip: Identical to the reference\n");
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Context context;
+    context.SetLogcatCallback([](LogLevel level, const char* message) {
+        if (level == LogLevel::kError) {
+            fprintf(stderr, "%s\n", message);
+        }
+    });
+
+    RenderedCaptions reference;
+    if (!RenderSamples(context, [](Renderer&) { return true; }, reference)) {
+        return -1;
+    }
+
+    RenderedCaptions threaded;
+    if (!RenderSamples(context, [](Renderer& renderer) { return renderer.SetRenderThreadCount(4); }, threaded) ||
+            !CompareRendered(reference, threaded, "4 render threads")) {
+        return -1;
+    }
+
+    RenderedCaptions render_ahead;
+    if (!RenderSamples(context, [](Renderer& renderer) { return renderer.SetRenderAheadCount(2); }, render_ahead) ||
+            !CompareRendered(reference, render_ahead, "Render-ahead")) {
+        return -1;
+    }
+
+    if (!TestSettingsRoundTrip(context, reference)) {
+        return -1;
+    }
+
+    printf("All passed\n");
+    return 0;
+}